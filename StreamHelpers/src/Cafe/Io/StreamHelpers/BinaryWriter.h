@@ -13,7 +13,7 @@ namespace Cafe::Io
 	static_assert(std::endian::native == std::endian::little ||
 	              std::endian::native == std::endian::big);
 
-	template <OutputStreamConcept OutputStreamType = OutputStream>
+	template <StaticOutputStreamConcept OutputStreamType = OutputStream>
 	class BinaryWriter
 	{
 	public:
@@ -0,0 +1,351 @@
+#include <Cafe/Io/Streams/AsyncStream.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && !defined(_WIN32)
+#include <cerrno>
+#endif
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+#include <Cafe/Io/Streams/IoUring.h>
+#endif
+
+using namespace Cafe;
+using namespace Io;
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && !defined(_WIN32)
+namespace
+{
+	bool IsWouldBlock(int error) noexcept
+	{
+		return error == EAGAIN || error == EWOULDBLOCK;
+	}
+} // namespace
+#endif
+
+AsyncStream::~AsyncStream()
+{
+}
+
+void AsyncStream::Close()
+{
+}
+
+Task<std::size_t> AsyncInputStream::ReadBytesAsync(std::span<std::byte> buffer)
+{
+	std::size_t totalReadSize = 0;
+	while (totalReadSize < buffer.size())
+	{
+		const auto readSize = co_await ReadSomeBytesAsync(buffer.subspan(totalReadSize));
+		if (!readSize)
+		{
+			break;
+		}
+		totalReadSize += readSize;
+	}
+
+	co_return totalReadSize;
+}
+
+Task<> AsyncOutputStream::FlushAsync()
+{
+	co_return;
+}
+
+AsyncInputStreamAdapter::AsyncInputStreamAdapter(IoContext& context, InputStream* stream)
+    : m_Context{ &context }, m_UnderlyingStream{ stream }
+{
+	assert(stream);
+}
+
+InputStream* AsyncInputStreamAdapter::GetUnderlyingStream() const noexcept
+{
+	return m_UnderlyingStream;
+}
+
+Task<std::size_t> AsyncInputStreamAdapter::ReadSomeBytesAsync(std::span<std::byte> buffer)
+{
+	co_return co_await m_Context->RunBlocking([stream = m_UnderlyingStream, buffer] {
+		// 优先读取当前可用的部分，无可用数据时阻塞读取 1 字节
+		const auto readSize = stream->ReadAvailableBytes(buffer);
+		return readSize ? readSize : stream->ReadBytes(buffer.first(buffer.empty() ? 0 : 1));
+	});
+}
+
+Task<std::size_t> AsyncInputStreamAdapter::ReadBytesAsync(std::span<std::byte> buffer)
+{
+	co_return co_await m_Context->RunBlocking(
+	    [stream = m_UnderlyingStream, buffer] { return stream->ReadBytes(buffer); });
+}
+
+void AsyncInputStreamAdapter::Close()
+{
+	m_UnderlyingStream = nullptr;
+}
+
+AsyncOutputStreamAdapter::AsyncOutputStreamAdapter(IoContext& context, OutputStream* stream)
+    : m_Context{ &context }, m_UnderlyingStream{ stream }
+{
+	assert(stream);
+}
+
+OutputStream* AsyncOutputStreamAdapter::GetUnderlyingStream() const noexcept
+{
+	return m_UnderlyingStream;
+}
+
+Task<std::size_t> AsyncOutputStreamAdapter::WriteBytesAsync(std::span<const std::byte> buffer)
+{
+	co_return co_await m_Context->RunBlocking(
+	    [stream = m_UnderlyingStream, buffer] { return stream->WriteBytes(buffer); });
+}
+
+Task<> AsyncOutputStreamAdapter::FlushAsync()
+{
+	co_await m_Context->RunBlocking([stream = m_UnderlyingStream] { stream->Flush(); });
+}
+
+void AsyncOutputStreamAdapter::Close()
+{
+	m_UnderlyingStream = nullptr;
+}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+AsyncFileInputStream::AsyncFileInputStream(IoContext& context, FileInputStream stream)
+    : m_Context{ &context }, m_Stream{ std::move(stream) }, m_UseReadinessWait{ false }
+{
+#if !defined(_WIN32)
+	m_UseReadinessWait = !HasCapability(m_Stream.GetCapabilities(), StreamCapability::Seekable) &&
+	                     m_Stream.SetNonBlocking(true);
+#endif
+}
+
+FileInputStream& AsyncFileInputStream::GetUnderlyingStream() noexcept
+{
+	return m_Stream;
+}
+
+Task<std::size_t> AsyncFileInputStream::ReadSomeBytesAsync(std::span<std::byte> buffer)
+{
+	if (buffer.empty())
+	{
+		co_return 0;
+	}
+
+#if !defined(_WIN32)
+	if (m_UseReadinessWait)
+	{
+		const auto fileHandle = m_Stream.GetNativeHandle();
+		while (true)
+		{
+			const auto readSize = read(fileHandle, buffer.data(), buffer.size());
+			if (readSize >= 0)
+			{
+				co_return static_cast<std::size_t>(readSize);
+			}
+
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (!IsWouldBlock(errno))
+			{
+				CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot read file."));
+			}
+
+			co_await m_Context->WaitReadable(fileHandle);
+		}
+	}
+#endif
+
+#if CAFE_IO_STREAMS_ENABLE_IO_URING
+	if (UsesIoUring())
+	{
+		// 内核将移动文件句柄的位置，流在用户空间中跟踪的位置需随之更新
+		const auto readSize = co_await m_Context->ReadFileAsync(
+		    m_Stream.GetNativeHandle(), IoUringEngine::CurrentPosition, buffer);
+		m_Stream.OnBytesRead(readSize);
+		co_return readSize;
+	}
+#endif
+
+	co_return co_await m_Context->RunBlocking([this, buffer] {
+		if (HasCapability(m_Stream.GetCapabilities(), StreamCapability::Seekable))
+		{
+			return m_Stream.ReadBytes(buffer);
+		}
+
+		const auto readSize = m_Stream.ReadAvailableBytes(buffer);
+		return readSize ? readSize : m_Stream.ReadBytes(buffer.first(1));
+	});
+}
+
+Task<std::size_t> AsyncFileInputStream::ReadBytesAsync(std::span<std::byte> buffer)
+{
+	if (m_UseReadinessWait || UsesIoUring())
+	{
+		co_return co_await AsyncInputStream::ReadBytesAsync(buffer);
+	}
+
+	co_return co_await m_Context->RunBlocking(
+	    [this, buffer] { return m_Stream.ReadBytes(buffer); });
+}
+
+Task<std::size_t> AsyncFileInputStream::ReadAtAsync(std::size_t offset, std::span<std::byte> buffer)
+{
+#if CAFE_IO_STREAMS_ENABLE_IO_URING
+	if (UsesIoUring())
+	{
+		std::size_t totalReadSize = 0;
+		while (totalReadSize < buffer.size())
+		{
+			const auto readSize = co_await m_Context->ReadFileAsync(
+			    m_Stream.GetNativeHandle(), offset + totalReadSize, buffer.subspan(totalReadSize));
+			if (!readSize)
+			{
+				break;
+			}
+			totalReadSize += readSize;
+		}
+
+		co_return totalReadSize;
+	}
+#endif
+
+	co_return co_await m_Context->RunBlocking(
+	    [this, offset, buffer] { return m_Stream.ReadAt(offset, buffer); });
+}
+
+void AsyncFileInputStream::Close()
+{
+	m_Stream.Close();
+}
+
+bool AsyncFileInputStream::UsesIoUring() const noexcept
+{
+	return m_Context->UsesIoUring() && m_Stream.GetCachePolicy() == FileCachePolicy::Default;
+}
+
+AsyncFileOutputStream::AsyncFileOutputStream(IoContext& context, FileOutputStream stream)
+    : m_Context{ &context }, m_Stream{ std::move(stream) }, m_UseReadinessWait{ false }
+{
+#if !defined(_WIN32)
+	m_UseReadinessWait = !HasCapability(m_Stream.GetCapabilities(), StreamCapability::Seekable) &&
+	                     m_Stream.SetNonBlocking(true);
+#endif
+}
+
+FileOutputStream& AsyncFileOutputStream::GetUnderlyingStream() noexcept
+{
+	return m_Stream;
+}
+
+Task<std::size_t> AsyncFileOutputStream::WriteBytesAsync(std::span<const std::byte> buffer)
+{
+#if !defined(_WIN32)
+	if (m_UseReadinessWait)
+	{
+		const auto fileHandle = m_Stream.GetNativeHandle();
+		std::size_t totalWrittenSize = 0;
+		while (totalWrittenSize < buffer.size())
+		{
+			const auto writtenSize = write(fileHandle, buffer.data() + totalWrittenSize,
+			                               buffer.size() - totalWrittenSize);
+			if (writtenSize > 0)
+			{
+				totalWrittenSize += static_cast<std::size_t>(writtenSize);
+				continue;
+			}
+
+			// 无法继续写入时返回已写入的部分
+			if (!writtenSize)
+			{
+				break;
+			}
+
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (!IsWouldBlock(errno))
+			{
+				CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
+			}
+
+			co_await m_Context->WaitWritable(fileHandle);
+		}
+
+		co_return totalWrittenSize;
+	}
+#endif
+
+#if CAFE_IO_STREAMS_ENABLE_IO_URING
+	if (UsesIoUring())
+	{
+		std::size_t totalWrittenSize = 0;
+		while (totalWrittenSize < buffer.size())
+		{
+			const auto writtenSize = co_await m_Context->WriteFileAsync(
+			    m_Stream.GetNativeHandle(), IoUringEngine::CurrentPosition,
+			    buffer.subspan(totalWrittenSize));
+			if (!writtenSize)
+			{
+				break;
+			}
+			totalWrittenSize += writtenSize;
+		}
+
+		co_return totalWrittenSize;
+	}
+#endif
+
+	co_return co_await m_Context->RunBlocking(
+	    [this, buffer] { return m_Stream.WriteBytes(buffer); });
+}
+
+Task<std::size_t> AsyncFileOutputStream::WriteAtAsync(std::size_t offset,
+                                                      std::span<const std::byte> buffer)
+{
+#if CAFE_IO_STREAMS_ENABLE_IO_URING
+	if (UsesIoUring())
+	{
+		std::size_t totalWrittenSize = 0;
+		while (totalWrittenSize < buffer.size())
+		{
+			const auto writtenSize = co_await m_Context->WriteFileAsync(
+			    m_Stream.GetNativeHandle(), offset + totalWrittenSize,
+			    buffer.subspan(totalWrittenSize));
+			if (!writtenSize)
+			{
+				break;
+			}
+			totalWrittenSize += writtenSize;
+		}
+
+		co_return totalWrittenSize;
+	}
+#endif
+
+	co_return co_await m_Context->RunBlocking(
+	    [this, offset, buffer] { return m_Stream.WriteAt(offset, buffer); });
+}
+
+Task<> AsyncFileOutputStream::FlushAsync()
+{
+	co_await m_Context->RunBlocking([this] { m_Stream.Flush(); });
+}
+
+void AsyncFileOutputStream::Close()
+{
+	m_Stream.Close();
+}
+
+bool AsyncFileOutputStream::UsesIoUring() const noexcept
+{
+	return m_Context->UsesIoUring() && m_Stream.GetCachePolicy() == FileCachePolicy::Default;
+}
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <Cafe/Io/Streams/Config/StreamConfig.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM
+
+#include "IoContext.h"
+#include "StreamBase.h"
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+#include "FileStream.h"
+#endif
+
+namespace Cafe::Io
+{
+	/// @brief  异步流
+	/// @remark 异步方法的参数均按值传递，以避免协程挂起后引用悬垂
+	///         同一流上同时只应有一个尚未完成的读取或写入操作
+	struct CAFE_PUBLIC AsyncStream
+	{
+		virtual ~AsyncStream();
+
+		virtual void Close();
+	};
+
+	struct CAFE_PUBLIC AsyncInputStream : virtual AsyncStream
+	{
+		/// @brief  异步读取至多 buffer.size() 字节，读取到至少 1 字节后即完成
+		/// @return 读取的字节数，若为 0 表示已到达流末尾
+		virtual Task<std::size_t> ReadSomeBytesAsync(std::span<std::byte> buffer) = 0;
+
+		/// @brief  异步读取直到填满 buffer 或到达流末尾，语义与 InputStream::ReadBytes 一致
+		/// @remark 默认实现重复调用 ReadSomeBytesAsync
+		/// @return 读取的字节数，若小于 buffer.size() 表示已到达流末尾
+		virtual Task<std::size_t> ReadBytesAsync(std::span<std::byte> buffer);
+	};
+
+	struct CAFE_PUBLIC AsyncOutputStream : virtual AsyncStream
+	{
+		/// @brief  异步写入 buffer 的全部内容
+		/// @return 写入的字节数
+		virtual Task<std::size_t> WriteBytesAsync(std::span<const std::byte> buffer) = 0;
+
+		/// @brief  异步刷新流
+		/// @remark 默认实现不进行任何操作
+		virtual Task<> FlushAsync();
+	};
+
+	/// @brief  将同步输入流适配为异步输入流
+	/// @remark 读取在 IoContext 的阻塞线程池中进行，适用于 BufferedInputStream 等无法以就绪通知实现的流
+	///         不持有底层流的所有权
+	class CAFE_PUBLIC AsyncInputStreamAdapter final : public AsyncInputStream
+	{
+	public:
+		AsyncInputStreamAdapter(IoContext& context, InputStream* stream);
+
+		InputStream* GetUnderlyingStream() const noexcept;
+
+		Task<std::size_t> ReadSomeBytesAsync(std::span<std::byte> buffer) override;
+		Task<std::size_t> ReadBytesAsync(std::span<std::byte> buffer) override;
+
+		/// @brief  在阻塞线程池中以底层流调用 func，可用于在协程中复用 BinaryReader 等同步逻辑
+		/// @return 以 func 的返回值完成的任务
+		template <typename Func>
+		Task<std::invoke_result_t<Func&, InputStream&>> Run(Func func)
+		{
+			co_return co_await m_Context->RunBlocking(
+			    [func = std::move(func), stream = m_UnderlyingStream]() mutable {
+				    return func(*stream);
+			    });
+		}
+
+		void Close() override;
+
+	private:
+		IoContext* m_Context;
+		InputStream* m_UnderlyingStream;
+	};
+
+	/// @brief  将同步输出流适配为异步输出流
+	/// @see    AsyncInputStreamAdapter
+	class CAFE_PUBLIC AsyncOutputStreamAdapter final : public AsyncOutputStream
+	{
+	public:
+		AsyncOutputStreamAdapter(IoContext& context, OutputStream* stream);
+
+		OutputStream* GetUnderlyingStream() const noexcept;
+
+		Task<std::size_t> WriteBytesAsync(std::span<const std::byte> buffer) override;
+		Task<> FlushAsync() override;
+
+		/// @see    AsyncInputStreamAdapter::Run
+		template <typename Func>
+		Task<std::invoke_result_t<Func&, OutputStream&>> Run(Func func)
+		{
+			co_return co_await m_Context->RunBlocking(
+			    [func = std::move(func), stream = m_UnderlyingStream]() mutable {
+				    return func(*stream);
+			    });
+		}
+
+		void Close() override;
+
+	private:
+		IoContext* m_Context;
+		OutputStream* m_UnderlyingStream;
+	};
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+	/// @brief  异步文件输入流
+	/// @remark 若文件不可定位（管道、套接字等）且 IoContext::SupportsReadinessWait 为 true，
+	///         句柄将被设为非阻塞模式，读取在 Run 的线程上直接进行，无数据时以 IoContext 等待句柄就绪，
+	///         句柄原本为阻塞模式时将在关闭或析构时恢复，见 FileStreamCommonPart::SetNonBlocking
+	///         否则若 IoContext 使用 io_uring 且流不处于 FileCachePolicy::Direct 模式，读取以 io_uring 批量提交，
+	///         流的位置随之更新
+	///         否则读取在 IoContext 的阻塞线程池中进行
+	class CAFE_PUBLIC AsyncFileInputStream final : public AsyncInputStream
+	{
+	public:
+		AsyncFileInputStream(IoContext& context, FileInputStream stream);
+
+		FileInputStream& GetUnderlyingStream() noexcept;
+
+		Task<std::size_t> ReadSomeBytesAsync(std::span<std::byte> buffer) override;
+		Task<std::size_t> ReadBytesAsync(std::span<std::byte> buffer) override;
+
+		/// @brief  异步读取指定位置的内容，不改变流的当前位置
+		/// @remark 文件必须可定位，语义与 FileInputStream::ReadAt 一致
+		///         可同时发起多个请求，使用 io_uring 时这些请求将被批量提交
+		Task<std::size_t> ReadAtAsync(std::size_t offset, std::span<std::byte> buffer);
+
+		void Close() override;
+
+	private:
+		IoContext* m_Context;
+		FileInputStream m_Stream;
+		bool m_UseReadinessWait;
+
+		/// @brief  以文件句柄的当前位置读取时是否使用 io_uring
+		/// @remark FileCachePolicy::Direct 模式下流的位置及数据在其内部缓存中，因此不使用
+		bool UsesIoUring() const noexcept;
+	};
+
+	/// @brief  异步文件输出流
+	/// @see    AsyncFileInputStream
+	class CAFE_PUBLIC AsyncFileOutputStream final : public AsyncOutputStream
+	{
+	public:
+		AsyncFileOutputStream(IoContext& context, FileOutputStream stream);
+
+		FileOutputStream& GetUnderlyingStream() noexcept;
+
+		Task<std::size_t> WriteBytesAsync(std::span<const std::byte> buffer) override;
+
+		/// @brief  异步写入内容到指定位置，不改变流的当前位置
+		/// @see    AsyncFileInputStream::ReadAtAsync
+		Task<std::size_t> WriteAtAsync(std::size_t offset, std::span<const std::byte> buffer);
+
+		/// @remark 在阻塞线程池中调用 FileOutputStream::Flush
+		Task<> FlushAsync() override;
+
+		void Close() override;
+
+	private:
+		IoContext* m_Context;
+		FileOutputStream m_Stream;
+		bool m_UseReadinessWait;
+
+		/// @see    AsyncFileInputStream::UsesIoUring
+		bool UsesIoUring() const noexcept;
+	};
+#endif
+} // namespace Cafe::Io
+
+#endif
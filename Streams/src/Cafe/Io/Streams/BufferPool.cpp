@@ -0,0 +1,106 @@
+#include <Cafe/Io/Streams/BufferPool.h>
+#include <algorithm>
+
+using namespace Cafe;
+using namespace Io;
+
+void BufferPool::Deleter::operator()(std::byte* buffer) const noexcept
+{
+	if (Pool)
+	{
+		Pool->Release(buffer, Size);
+	}
+	else
+	{
+		delete[] buffer;
+	}
+}
+
+BufferPool::BufferPool(std::size_t maxCachedSize)
+    : m_MaxCachedSize{ maxCachedSize }, m_CachedSize{}
+{
+}
+
+BufferPool::~BufferPool()
+{
+}
+
+BufferPool& BufferPool::GetDefault() noexcept
+{
+	static BufferPool pool;
+	return pool;
+}
+
+BufferPool::Buffer BufferPool::Acquire(BufferPool* pool, std::size_t size)
+{
+	if (pool)
+	{
+		return pool->Acquire(size);
+	}
+
+	return Buffer{ std::make_unique_for_overwrite<std::byte[]>(size).release(),
+		           Deleter{ nullptr, size } };
+}
+
+BufferPool::Buffer BufferPool::Acquire(std::size_t size)
+{
+	{
+		const std::lock_guard lock{ m_Mutex };
+		// 从后向前查找，优先复用最近归还的缓存
+		const auto iter =
+		    std::find_if(m_CachedBuffers.rbegin(), m_CachedBuffers.rend(),
+		                 [size](CachedBuffer const& cachedBuffer) { return cachedBuffer.Size == size; });
+		if (iter != m_CachedBuffers.rend())
+		{
+			auto storage = std::move(iter->Storage);
+			*iter = std::move(m_CachedBuffers.back());
+			m_CachedBuffers.pop_back();
+			m_CachedSize -= size;
+			return Buffer{ storage.release(), Deleter{ this, size } };
+		}
+	}
+
+	return Buffer{ std::make_unique_for_overwrite<std::byte[]>(size).release(),
+		           Deleter{ this, size } };
+}
+
+void BufferPool::Trim() noexcept
+{
+	std::vector<CachedBuffer> cachedBuffers;
+	{
+		const std::lock_guard lock{ m_Mutex };
+		cachedBuffers.swap(m_CachedBuffers);
+		m_CachedSize = 0;
+	}
+}
+
+std::size_t BufferPool::GetMaxCachedSize() const noexcept
+{
+	return m_MaxCachedSize;
+}
+
+std::size_t BufferPool::GetCachedSize() const noexcept
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_CachedSize;
+}
+
+void BufferPool::Release(std::byte* buffer, std::size_t size) noexcept
+{
+	std::unique_ptr<std::byte[]> storage{ buffer };
+	const std::lock_guard lock{ m_Mutex };
+	if (m_CachedSize + size > m_MaxCachedSize)
+	{
+		return;
+	}
+
+	try
+	{
+		m_CachedBuffers.push_back({ size, std::move(storage) });
+		m_CachedSize += size;
+	}
+	catch (...)
+	{
+		// 无法保存时直接释放
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "StreamBase.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Cafe::Io
+{
+	/// @brief  缓存池，供缓存流等频繁创建及销毁的对象复用缓存
+	/// @remark 缓存以未初始化的方式分配，取出的缓存内容未指定
+	///         归还的缓存按大小保存，仅在请求的大小与之相同时复用，保存的总长度超出上限时直接释放
+	///         可由多个线程同时使用，池需在所有从中取出的缓存之后析构
+	class CAFE_PUBLIC BufferPool
+	{
+	public:
+		static constexpr std::size_t DefaultMaxCachedSize = 16 * 1024 * 1024;
+
+		/// @brief  释放缓存时归还到池中，Pool 为空时直接释放
+		struct Deleter
+		{
+			BufferPool* Pool;
+			std::size_t Size;
+
+			void operator()(std::byte* buffer) const noexcept;
+		};
+
+		using Buffer = std::unique_ptr<std::byte[], Deleter>;
+
+		/// @param  maxCachedSize   池中保存的缓存的总长度上限
+		explicit BufferPool(std::size_t maxCachedSize = DefaultMaxCachedSize);
+
+		BufferPool(BufferPool const&) = delete;
+		BufferPool& operator=(BufferPool const&) = delete;
+
+		~BufferPool();
+
+		/// @brief  获得进程内共享的缓存池
+		static BufferPool& GetDefault() noexcept;
+
+		/// @brief  取出大小为 size 的缓存，池中没有相同大小的缓存时将分配新的缓存
+		/// @remark pool 为空时不经过池，仅以未初始化的方式分配
+		static Buffer Acquire(BufferPool* pool, std::size_t size);
+
+		Buffer Acquire(std::size_t size);
+
+		/// @brief  释放池中保存的全部缓存
+		void Trim() noexcept;
+
+		std::size_t GetMaxCachedSize() const noexcept;
+		std::size_t GetCachedSize() const noexcept;
+
+	private:
+		struct CachedBuffer
+		{
+			std::size_t Size;
+			std::unique_ptr<std::byte[]> Storage;
+		};
+
+		mutable std::mutex m_Mutex;
+		std::vector<CachedBuffer> m_CachedBuffers;
+		std::size_t m_MaxCachedSize;
+		std::size_t m_CachedSize;
+
+		void Release(std::byte* buffer, std::size_t size) noexcept;
+	};
+} // namespace Cafe::Io
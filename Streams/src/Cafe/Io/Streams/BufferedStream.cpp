@@ -1,23 +1,46 @@
 #include <Cafe/ErrorHandling/ErrorHandling.h>
 #include <Cafe/Io/Streams/BufferedStream.h>
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <vector>
 
 using namespace Cafe;
 using namespace Io;
 
-BufferedInputStream::BufferedInputStream(InputStream* stream, std::size_t maxBufferSize)
-    : m_UnderlyingStream{ stream },
-      m_LastReadBufferPosition(-1), m_Buffer{ std::make_unique<std::byte[]>(maxBufferSize) },
-      m_MaxBufferSize{ maxBufferSize }, m_ReadSize{}, m_CurrentPosition{}
+BufferedInputStream::BufferedInputStream(InputStream* stream, std::size_t maxBufferSize,
+                                         BufferPool* pool)
+    : m_UnderlyingStream{ stream }, m_SeekableUnderlyingStream{},
+      m_UnderlyingCapabilities{ stream->GetCapabilities() }, m_UnderlyingPosition{},
+      m_Buffer{ BufferPool::Acquire(pool, maxBufferSize) }, m_MaxBufferSize{ maxBufferSize },
+      m_BufferCapacity{ maxBufferSize }, m_ReadSize{}, m_WrapSize{}, m_MarkOffset{ NoMark }
 {
+	UpdateReadWindow(0);
+
+	if (HasCapability(m_UnderlyingCapabilities, StreamCapability::Seekable))
+	{
+		m_SeekableUnderlyingStream = dynamic_cast<SeekableStream<InputStream>*>(stream);
+		if (m_SeekableUnderlyingStream)
+		{
+			m_UnderlyingPosition = m_SeekableUnderlyingStream->GetPosition();
+		}
+	}
 }
 
 BufferedInputStream::BufferedInputStream(BufferedInputStream&& other) noexcept
     : m_UnderlyingStream{ std::exchange(other.m_UnderlyingStream, nullptr) },
-      m_LastReadBufferPosition{ other.m_LastReadBufferPosition },
-      m_Buffer{ std::move(other.m_Buffer) }, m_MaxBufferSize{ other.m_MaxBufferSize },
-      m_ReadSize{ other.m_ReadSize }, m_CurrentPosition{ other.m_CurrentPosition }
+      m_SeekableUnderlyingStream{ std::exchange(other.m_SeekableUnderlyingStream, nullptr) },
+      m_UnderlyingCapabilities{ other.m_UnderlyingCapabilities },
+      m_UnderlyingPosition{ other.m_UnderlyingPosition }, m_Buffer{ std::move(other.m_Buffer) },
+      m_MaxBufferSize{ other.m_MaxBufferSize }, m_BufferCapacity{ other.m_BufferCapacity },
+      m_ReadSize{ std::exchange(other.m_ReadSize, 0) },
+      m_WrapSize{ std::exchange(other.m_WrapSize, 0) }, m_MarkOffset{ std::exchange(
+	                                                         other.m_MarkOffset, NoMark) },
+      m_SpareBuffer{ std::move(other.m_SpareBuffer) }
 {
+	// 虚基类不由移动构造函数初始化，需单独转移读取窗口，缓存的地址不变因此窗口仍然有效
+	m_ReadWindowCurrent = std::exchange(other.m_ReadWindowCurrent, nullptr);
+	m_ReadWindowEnd = std::exchange(other.m_ReadWindowEnd, nullptr);
 }
 
 BufferedInputStream::~BufferedInputStream()
@@ -28,47 +51,111 @@ BufferedInputStream::~BufferedInputStream()
 BufferedInputStream& BufferedInputStream::operator=(BufferedInputStream&& other) noexcept
 {
 	m_UnderlyingStream = std::exchange(other.m_UnderlyingStream, nullptr);
-	m_LastReadBufferPosition = other.m_LastReadBufferPosition;
+	m_SeekableUnderlyingStream = std::exchange(other.m_SeekableUnderlyingStream, nullptr);
+	m_UnderlyingCapabilities = other.m_UnderlyingCapabilities;
+	m_UnderlyingPosition = other.m_UnderlyingPosition;
 	m_Buffer = std::move(other.m_Buffer);
 	m_MaxBufferSize = other.m_MaxBufferSize;
-	m_ReadSize = other.m_ReadSize;
-	m_CurrentPosition = other.m_CurrentPosition;
+	m_BufferCapacity = other.m_BufferCapacity;
+	m_ReadSize = std::exchange(other.m_ReadSize, 0);
+	m_ReadWindowCurrent = std::exchange(other.m_ReadWindowCurrent, nullptr);
+	m_ReadWindowEnd = std::exchange(other.m_ReadWindowEnd, nullptr);
+	m_WrapSize = std::exchange(other.m_WrapSize, 0);
+	m_MarkOffset = std::exchange(other.m_MarkOffset, NoMark);
+	m_SpareBuffer = std::move(other.m_SpareBuffer);
 
 	return *this;
 }
 
 void BufferedInputStream::Close()
 {
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream);
-	    seekableStream && m_LastReadBufferPosition != std::size_t(-1))
+	// 仅在缓存中有未读取的数据时才需要将包装流退回到用户当前读取的位置
+	if (m_SeekableUnderlyingStream && GetCurrentOffset() != m_ReadSize)
 	{
-		seekableStream->SeekFromBegin(m_LastReadBufferPosition + m_CurrentPosition);
+		m_SeekableUnderlyingStream->SeekFromBegin(GetPosition());
 	}
 
 	m_UnderlyingStream = nullptr;
+	m_SeekableUnderlyingStream = nullptr;
+	DiscardBuffer();
 	m_Buffer.reset();
+	m_ReadWindowCurrent = nullptr;
+	m_ReadWindowEnd = nullptr;
+}
+
+StreamCapability BufferedInputStream::GetCapabilities() const
+{
+	auto capabilities = StreamCapability::Borrow;
+	if (m_SeekableUnderlyingStream)
+	{
+		capabilities |= m_UnderlyingCapabilities &
+		                (StreamCapability::Seekable | StreamCapability::KnownSize |
+		                 StreamCapability::PositionalIo);
+	}
+
+	return capabilities;
 }
 
 std::size_t BufferedInputStream::GetAvailableBytes()
 {
-	return m_ReadSize - m_CurrentPosition + m_UnderlyingStream->GetAvailableBytes();
+	return GetAvailableBufferSize() + m_UnderlyingStream->GetAvailableBytes();
 }
 
-std::size_t BufferedInputStream::ReadBytes(std::span<std::byte> const& buffer)
+std::optional<std::byte> BufferedInputStream::Underflow()
 {
-	const auto readSizeFromBuffer =
-	    std::min(m_ReadSize - m_CurrentPosition, static_cast<std::size_t>(buffer.size()));
-	std::memcpy(buffer.data(), &m_Buffer[m_CurrentPosition], readSizeFromBuffer);
-	m_CurrentPosition += readSizeFromBuffer;
-	auto readSize = readSizeFromBuffer;
-	if (readSizeFromBuffer != buffer.size())
+	std::byte value;
+	if (!ReadBytesSlow(std::span(&value, 1)))
 	{
-		readSize += m_UnderlyingStream->ReadBytes(buffer.subspan(readSizeFromBuffer));
-		FlushBuffer(false);
+		return {};
 	}
-	else if (m_CurrentPosition == m_ReadSize)
+
+	return value;
+}
+
+std::size_t BufferedInputStream::ReadBytesSlow(std::span<std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	std::size_t readSize = 0;
+
+	while (true)
 	{
-		FlushBuffer();
+		const auto readSizeFromBuffer =
+		    std::min(m_ReadSize - GetCurrentOffset(), bufferSize - readSize);
+		std::memcpy(buffer.data() + readSize, m_ReadWindowCurrent, readSizeFromBuffer);
+		Advance(readSizeFromBuffer);
+		readSize += readSizeFromBuffer;
+
+		const auto remainedSize = bufferSize - readSize;
+		if (!remainedSize)
+		{
+			break;
+		}
+
+		// 当前段读完后可能已切换到回绕段
+		if (GetCurrentOffset() != m_ReadSize)
+		{
+			continue;
+		}
+
+		// 有标记时需保留读取的数据，总是经过缓存
+		if (remainedSize >= m_MaxBufferSize && !IsMarked())
+		{
+			// 剩余部分不小于缓存大小，直接读取到用户的缓存中以避免额外的复制
+			// 缓存中的数据不再与包装流的位置相邻，需丢弃以免寻位时误用
+			DiscardBuffer();
+			const auto readSizeFromStream = m_UnderlyingStream->ReadBytes(buffer.subspan(readSize));
+			m_UnderlyingPosition += readSizeFromStream;
+			readSize += readSizeFromStream;
+			break;
+		}
+
+		FillBuffer(false, remainedSize);
+
+		// 流已到结尾
+		if (GetCurrentOffset() == m_ReadSize)
+		{
+			break;
+		}
 	}
 
 	return readSize;
@@ -76,76 +163,204 @@ std::size_t BufferedInputStream::ReadBytes(std::span<std::byte> const& buffer)
 
 std::size_t BufferedInputStream::Skip(std::size_t n)
 {
-	if (m_CurrentPosition + n < m_ReadSize)
+	const auto bufferedSize = GetAvailableBufferSize();
+	if (n <= bufferedSize)
 	{
-		m_CurrentPosition += n;
+		Advance(n);
 		return n;
 	}
 
-	const auto skippedSize = m_ReadSize - m_CurrentPosition + m_UnderlyingStream->Skip(n);
-	FlushBuffer(false);
-	return skippedSize;
+	if (IsMarked())
+	{
+		// 跳过的数据也需保留，经过缓存读取
+		std::size_t skippedSize = 0;
+		while (skippedSize < n)
+		{
+			if (GetCurrentOffset() == m_ReadSize)
+			{
+				FillBuffer(false, n - skippedSize);
+
+				// 流已到结尾
+				if (GetCurrentOffset() == m_ReadSize)
+				{
+					break;
+				}
+			}
+
+			const auto size = std::min(n - skippedSize, m_ReadSize - GetCurrentOffset());
+			Advance(size);
+			skippedSize += size;
+		}
+
+		return skippedSize;
+	}
+
+	DiscardBuffer();
+	const auto skippedSize = m_UnderlyingStream->Skip(n - bufferedSize);
+	m_UnderlyingPosition += skippedSize;
+	return bufferedSize + skippedSize;
 }
 
-std::size_t BufferedInputStream::GetPosition() const
+std::span<const std::byte> BufferedInputStream::BorrowBytes(std::size_t maxSize)
 {
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream))
+	if (GetCurrentOffset() == m_ReadSize)
 	{
-		if (m_LastReadBufferPosition == std::size_t(-1))
-		{
-			return seekableStream->GetPosition();
-		}
-		return m_LastReadBufferPosition + m_CurrentPosition;
+		FillBuffer(false);
 	}
 
-	CAFE_THROW(IoException, CAFE_UTF8_SV("Underlying stream is not seekable."));
+	return std::span(m_ReadWindowCurrent, std::min(maxSize, m_ReadSize - GetCurrentOffset()));
 }
 
-void BufferedInputStream::SeekFromBegin(std::size_t pos)
+void BufferedInputStream::Consume(std::size_t n)
 {
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream))
+	if (n <= GetAvailableBufferSize())
 	{
-		seekableStream->SeekFromBegin(pos);
-		FlushBuffer(false);
+		Advance(n);
 	}
 	else
 	{
-		CAFE_THROW(IoException, CAFE_UTF8_SV("Underlying stream is not seekable."));
+		Skip(n);
 	}
 }
 
-void BufferedInputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+std::size_t BufferedInputStream::CopyTo(OutputStream& stream, std::size_t size)
 {
-	if (origin == SeekOrigin::Current && m_CurrentPosition <= diff &&
-	    diff <= m_ReadSize - m_CurrentPosition)
+	std::size_t copySizeFromBuffer = 0;
+	while (copySizeFromBuffer < size)
 	{
-		m_CurrentPosition += diff;
+		if (GetCurrentOffset() == m_ReadSize)
+		{
+			// 有标记时复制的数据也需保留，经过缓存读取
+			if (!IsMarked())
+			{
+				break;
+			}
+
+			FillBuffer(false);
+
+			// 流已到结尾
+			if (GetCurrentOffset() == m_ReadSize)
+			{
+				return copySizeFromBuffer;
+			}
+		}
+
+		const auto copySize = std::min(size - copySizeFromBuffer, m_ReadSize - GetCurrentOffset());
+		// 仅跳过已写出的部分，stream 无法继续写入时停止
+		const auto writtenSize = stream.WriteBytes(std::span(m_ReadWindowCurrent, copySize));
+		Advance(writtenSize);
+		copySizeFromBuffer += writtenSize;
+		if (writtenSize < copySize)
+		{
+			return copySizeFromBuffer;
+		}
+	}
+
+	if (copySizeFromBuffer == size)
+	{
+		return size;
+	}
+
+	DiscardBuffer();
+	const auto copySizeFromStream = m_UnderlyingStream->CopyTo(stream, size - copySizeFromBuffer);
+	m_UnderlyingPosition += copySizeFromStream;
+	return copySizeFromBuffer + copySizeFromStream;
+}
+
+std::size_t BufferedInputStream::GetPosition() const
+{
+	CheckSeekable();
+	return m_UnderlyingPosition - GetAvailableBufferSize();
+}
+
+void BufferedInputStream::SeekFromBegin(std::size_t pos)
+{
+	CheckSeekable();
+
+	// 目标位置仍在缓存中时无需操作包装流
+	// 缓存中的数据依次为当前段及回绕段，回绕段的结尾对应包装流的当前位置
+	const auto bufferEndPosition = m_UnderlyingPosition - m_WrapSize;
+	if (m_WrapSize && bufferEndPosition <= pos && pos <= m_UnderlyingPosition)
+	{
+		m_ReadSize = std::exchange(m_WrapSize, 0);
+		UpdateReadWindow(pos - bufferEndPosition);
+		return;
+	}
+
+	// 当前段开头的 m_WrapSize 个字节已被回绕段覆盖
+	const auto bufferBeginPosition = bufferEndPosition - m_ReadSize;
+	if (bufferBeginPosition + m_WrapSize <= pos && pos <= bufferEndPosition)
+	{
+		UpdateReadWindow(pos - bufferBeginPosition);
 		return;
 	}
 
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream))
+	m_SeekableUnderlyingStream->SeekFromBegin(pos);
+	m_UnderlyingPosition = pos;
+	DiscardBuffer();
+}
+
+void BufferedInputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+	CheckSeekable();
+
+	switch (origin)
 	{
-		if (origin == SeekOrigin::Current)
+	default:
+		assert(!"Invalid origin.");
+		[[fallthrough]];
+	case SeekOrigin::Begin:
+		if (diff < 0)
 		{
-			diff += seekableStream->GetPosition() - (m_ReadSize - m_CurrentPosition);
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
 		}
-		seekableStream->Seek(origin, diff);
-		FlushBuffer(false);
-	}
-	else
+		SeekFromBegin(static_cast<std::size_t>(diff));
+		break;
+	case SeekOrigin::Current:
 	{
-		CAFE_THROW(IoException, CAFE_UTF8_SV("Underlying stream is not seekable."));
+		const auto position = GetPosition();
+		if (diff < 0 && static_cast<std::size_t>(-diff) > position)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+		}
+		SeekFromBegin(position + diff);
+		break;
+	}
+	case SeekOrigin::End:
+		if (HasCapability(m_UnderlyingCapabilities, StreamCapability::KnownSize))
+		{
+			const auto totalSize = m_SeekableUnderlyingStream->GetTotalSize();
+			if (diff > 0 || static_cast<std::size_t>(-diff) > totalSize)
+			{
+				CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+			}
+			SeekFromBegin(totalSize + diff);
+		}
+		else
+		{
+			m_SeekableUnderlyingStream->Seek(origin, diff);
+			m_UnderlyingPosition = m_SeekableUnderlyingStream->GetPosition();
+			DiscardBuffer();
+		}
+		break;
 	}
 }
 
 std::size_t BufferedInputStream::GetTotalSize()
 {
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream))
-	{
-		return seekableStream->GetTotalSize();
-	}
+	CheckSeekable();
+	return m_SeekableUnderlyingStream->GetTotalSize();
+}
 
-	CAFE_THROW(IoException, CAFE_UTF8_SV("Underlying stream is not seekable."));
+std::size_t BufferedInputStream::ReadAt(std::size_t offset, std::span<std::byte> const& buffer)
+{
+	CheckSeekable();
+	return m_SeekableUnderlyingStream->ReadAt(offset, buffer);
+}
+
+InputStream* BufferedInputStream::GetUnderlyingStream() const noexcept
+{
+	return m_UnderlyingStream;
 }
 
 std::size_t BufferedInputStream::GetMaxBufferSize() const noexcept
@@ -160,53 +375,114 @@ std::size_t BufferedInputStream::GetBufferSize() const noexcept
 
 std::size_t BufferedInputStream::GetAvailableBufferSize() const noexcept
 {
-	return m_ReadSize - m_CurrentPosition;
+	return m_ReadSize - GetCurrentOffset() + m_WrapSize;
 }
 
-void BufferedInputStream::FlushBuffer(bool keep, std::size_t needSize)
+void BufferedInputStream::CheckSeekable() const
 {
-	const auto keepSize = keep ? m_ReadSize - m_CurrentPosition : 0;
-	std::memmove(m_Buffer.get(), &m_Buffer[m_CurrentPosition], keepSize);
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream))
+	if (!m_SeekableUnderlyingStream)
 	{
-		m_LastReadBufferPosition = seekableStream->GetPosition() - keepSize;
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Underlying stream is not seekable."));
 	}
-	if (m_MaxBufferSize != keepSize && needSize)
+}
+
+void BufferedInputStream::DiscardBuffer() noexcept
+{
+	m_ReadSize = 0;
+	m_WrapSize = 0;
+	m_MarkOffset = NoMark;
+
+	// 换回原本的缓存
+	if (m_SpareBuffer)
 	{
-		const auto readSize = m_UnderlyingStream->ReadAvailableBytes(
-		    std::span(&m_Buffer[keep ? m_CurrentPosition : 0],
-		              std::min(m_MaxBufferSize - keepSize, needSize)));
-		m_ReadSize = keepSize + readSize;
+		m_Buffer = std::move(m_SpareBuffer);
+		m_BufferCapacity = m_MaxBufferSize;
 	}
-	else
+
+	UpdateReadWindow(0);
+}
+
+void BufferedInputStream::UpdateReadWindow(std::size_t currentOffset) noexcept
+{
+	assert(currentOffset <= m_ReadSize);
+	const auto buffer = m_Buffer.get();
+	m_ReadWindowCurrent = buffer + currentOffset;
+	// 回绕段非空时窗口不包含当前段的最后一个字节，使当前段读完时总经过 Advance 切换到回绕段
+	m_ReadWindowEnd = buffer + (m_WrapSize ? m_ReadSize - 1 : m_ReadSize);
+}
+
+void BufferedInputStream::Advance(std::size_t n) noexcept
+{
+	assert(n <= GetAvailableBufferSize());
+	const auto currentSize = m_ReadSize - GetCurrentOffset();
+	if (n < currentSize || !m_WrapSize)
 	{
-		m_ReadSize = keepSize;
+		m_ReadWindowCurrent += n;
+		return;
 	}
 
-	m_CurrentPosition = 0;
+	m_ReadSize = std::exchange(m_WrapSize, 0);
+	UpdateReadWindow(n - currentSize);
 }
 
 void BufferedInputStream::FillBuffer(bool keep, std::size_t needSize)
 {
-	const auto keepSize = keep ? m_ReadSize - m_CurrentPosition : 0;
-	std::memmove(m_Buffer.get(), &m_Buffer[m_CurrentPosition], keepSize);
-	if (const auto seekableStream = dynamic_cast<SeekableStream<InputStream>*>(m_UnderlyingStream))
-	{
-		m_LastReadBufferPosition = seekableStream->GetPosition() - keepSize;
-	}
-	if (m_MaxBufferSize != keepSize && needSize)
+	if (IsMarked())
 	{
-		const auto readSize = m_UnderlyingStream->ReadBytes(
-		    std::span(&m_Buffer[keep ? m_CurrentPosition : 0],
-		              std::min(m_MaxBufferSize - keepSize, needSize)));
-		m_ReadSize = keepSize + readSize;
+		// 标记之后的数据需保留，缓存不会回绕
+		assert(!m_WrapSize);
 	}
 	else
 	{
-		m_ReadSize = keepSize;
+		// 没有需保留的数据时回到缓存开头，使空闲部分连续
+		if (!keep || GetCurrentOffset() == m_ReadSize)
+		{
+			DiscardBuffer();
+		}
+
+		needSize = std::min(needSize, m_BufferCapacity);
 	}
 
-	m_CurrentPosition = 0;
+	while (GetAvailableBufferSize() < needSize)
+	{
+		if (IsMarked() && m_ReadSize == m_BufferCapacity)
+		{
+			ReserveMarkedSpace(needSize - GetAvailableBufferSize());
+		}
+
+		// 当前段已到达缓存结尾时写入缓存开头直到当前段未读的部分，此时数据不足保证空闲部分非空
+		const auto wrapped = m_WrapSize || m_ReadSize == m_BufferCapacity;
+		const auto freeBuffer =
+		    wrapped ? std::span(m_Buffer.get() + m_WrapSize, GetCurrentOffset() - m_WrapSize)
+		            : std::span(m_Buffer.get() + m_ReadSize, m_BufferCapacity - m_ReadSize);
+
+		std::size_t readSize;
+		if (m_SeekableUnderlyingStream)
+		{
+			// 可寻位的流读取时不会长时间阻塞，尽量读满缓存以减少调用次数
+			readSize = m_UnderlyingStream->ReadBytes(freeBuffer);
+		}
+		else
+		{
+			// 先读取已到达的数据，不足时才阻塞读取所需的部分
+			readSize = m_UnderlyingStream->ReadAvailableBytes(freeBuffer);
+			if (!readSize)
+			{
+				readSize = m_UnderlyingStream->ReadBytes(freeBuffer.subspan(
+				    0, std::min(needSize - GetAvailableBufferSize(), freeBuffer.size())));
+			}
+		}
+
+		// 流已到结尾
+		if (!readSize)
+		{
+			break;
+		}
+
+		(wrapped ? m_WrapSize : m_ReadSize) += readSize;
+		m_UnderlyingPosition += readSize;
+		UpdateReadWindow(GetCurrentOffset());
+	}
 }
 
 std::optional<std::byte> BufferedInputStream::PeekByte()
@@ -216,40 +492,142 @@ std::optional<std::byte> BufferedInputStream::PeekByte()
 		CAFE_THROW(IoException, CAFE_UTF8_SV("BufferSize is 0, PeekByte is not implementable."));
 	}
 
-	if (m_CurrentPosition == m_ReadSize)
+	if (GetCurrentOffset() == m_ReadSize)
 	{
-		FillBuffer(false, 1);
+		FillBuffer(false);
 
 		// 流已到结尾
-		if (m_CurrentPosition == m_ReadSize)
+		if (GetCurrentOffset() == m_ReadSize)
 		{
 			return {};
 		}
 	}
 
-	return m_Buffer[m_CurrentPosition];
+	return *m_ReadWindowCurrent;
 }
 
 std::size_t BufferedInputStream::PeekBytes(std::span<std::byte> const& buffer)
 {
-	FillBuffer(true, buffer.size());
+	const auto segments = PeekSegments(buffer.size());
+
+	std::size_t readSize = 0;
+	for (const auto& segment : segments)
+	{
+		const auto size = std::min(segment.size(), buffer.size() - readSize);
+		std::memcpy(buffer.data() + readSize, segment.data(), size);
+		readSize += size;
+	}
 
-	const auto readSize = std::min(m_ReadSize, static_cast<std::size_t>(buffer.size()));
-	std::memcpy(buffer.data(), m_Buffer.get(), readSize);
 	return readSize;
 }
 
-BufferedOutputStream::BufferedOutputStream(OutputStream* stream, std::size_t bufferSize)
-    : m_UnderlyingStream{ stream }, m_Buffer{ std::make_unique<std::byte[]>(bufferSize) },
-      m_BufferSize{ bufferSize }, m_CurrentPosition{}
+std::array<std::span<const std::byte>, 2> BufferedInputStream::PeekSegments(std::size_t minSize)
+{
+	if (GetAvailableBufferSize() < minSize)
+	{
+		FillBuffer(true, minSize);
+	}
+
+	return { std::span<const std::byte>(m_ReadWindowCurrent, m_ReadSize - GetCurrentOffset()),
+		     std::span<const std::byte>(m_Buffer.get(), m_WrapSize) };
+}
+
+void BufferedInputStream::Mark()
+{
+	if (m_WrapSize)
+	{
+		// 标记期间缓存不会回绕，将未读数据原地轮转为连续的一段
+		const auto currentOffset = GetCurrentOffset();
+		std::rotate(m_Buffer.get(), m_Buffer.get() + currentOffset, m_Buffer.get() + m_ReadSize);
+		m_ReadSize = m_ReadSize - currentOffset + std::exchange(m_WrapSize, 0);
+		UpdateReadWindow(0);
+	}
+
+	m_MarkOffset = GetCurrentOffset();
+}
+
+void BufferedInputStream::Reset() noexcept
+{
+	if (IsMarked())
+	{
+		UpdateReadWindow(m_MarkOffset);
+	}
+}
+
+void BufferedInputStream::Release() noexcept
+{
+	m_MarkOffset = NoMark;
+
+	// 取消标记后扩大的缓存也可能回绕，需复制两段
+	if (m_SpareBuffer && GetAvailableBufferSize() <= m_MaxBufferSize)
+	{
+		const auto currentSize = m_ReadSize - GetCurrentOffset();
+		std::memcpy(m_SpareBuffer.get(), m_ReadWindowCurrent, currentSize);
+		std::memcpy(m_SpareBuffer.get() + currentSize, m_Buffer.get(), m_WrapSize);
+		m_Buffer = std::move(m_SpareBuffer);
+		m_BufferCapacity = m_MaxBufferSize;
+		m_ReadSize = currentSize + std::exchange(m_WrapSize, 0);
+		UpdateReadWindow(0);
+	}
+}
+
+bool BufferedInputStream::IsMarked() const noexcept
+{
+	return m_MarkOffset != NoMark;
+}
+
+void BufferedInputStream::ReserveMarkedSpace(std::size_t extraSize)
+{
+	assert(IsMarked() && !m_WrapSize);
+
+	// 寻位后当前位置可能在标记之前，需保留两者中较前位置之后的数据
+	const auto currentOffset = GetCurrentOffset();
+	const auto keepOffset = std::min(m_MarkOffset, currentOffset);
+	const auto keepSize = m_ReadSize - keepOffset;
+	const auto needCapacity = keepSize + extraSize;
+	if (keepSize <= m_BufferCapacity / 2 && needCapacity <= m_BufferCapacity)
+	{
+		// 保留的数据不超过缓存的一半时移动到开头，移动的开销可由之后的读取分摊
+		std::memmove(m_Buffer.get(), m_Buffer.get() + keepOffset, keepSize);
+	}
+	else
+	{
+		const auto newCapacity = std::max(m_BufferCapacity * 2, needCapacity);
+		auto newBuffer = BufferPool::Acquire(nullptr, newCapacity);
+		std::memcpy(newBuffer.get(), m_Buffer.get() + keepOffset, keepSize);
+		if (m_SpareBuffer)
+		{
+			m_Buffer = std::move(newBuffer);
+		}
+		else
+		{
+			m_SpareBuffer = std::exchange(m_Buffer, std::move(newBuffer));
+		}
+		m_BufferCapacity = newCapacity;
+	}
+
+	m_ReadSize = keepSize;
+	m_MarkOffset -= keepOffset;
+	UpdateReadWindow(currentOffset - keepOffset);
+}
+
+BufferedOutputStream::BufferedOutputStream(OutputStream* stream, std::size_t bufferSize,
+                                           BufferPool* pool)
+    : m_UnderlyingStream{ stream }, m_Buffer{ BufferPool::Acquire(pool, bufferSize) },
+      m_BufferSize{ bufferSize }
 {
+	m_WriteWindowCurrent = m_Buffer.get();
+	m_WriteWindowEnd = m_Buffer.get() + bufferSize;
 }
 
 BufferedOutputStream::BufferedOutputStream(BufferedOutputStream&& other) noexcept
     : m_UnderlyingStream{ std::exchange(other.m_UnderlyingStream, nullptr) }, m_Buffer{ std::move(
 	                                                                              other.m_Buffer) },
-      m_BufferSize{ other.m_BufferSize }, m_CurrentPosition{ other.m_CurrentPosition }
+      m_BufferSize{ other.m_BufferSize }
 {
+	// 虚基类不由移动构造函数初始化，需单独转移写入窗口，缓存的地址不变因此窗口仍然有效
+	m_WriteWindowCurrent = std::exchange(other.m_WriteWindowCurrent, nullptr);
+	m_WriteWindowEnd = std::exchange(other.m_WriteWindowEnd, nullptr);
 }
 
 BufferedOutputStream::~BufferedOutputStream()
@@ -259,16 +637,22 @@ BufferedOutputStream::~BufferedOutputStream()
 
 BufferedOutputStream& BufferedOutputStream::operator=(BufferedOutputStream&& other) noexcept
 {
-	Flush();
+	Close();
 
 	m_UnderlyingStream = std::exchange(other.m_UnderlyingStream, nullptr);
 	m_Buffer = std::move(other.m_Buffer);
 	m_BufferSize = other.m_BufferSize;
-	m_CurrentPosition = other.m_CurrentPosition;
+	m_WriteWindowCurrent = std::exchange(other.m_WriteWindowCurrent, nullptr);
+	m_WriteWindowEnd = std::exchange(other.m_WriteWindowEnd, nullptr);
 
 	return *this;
 }
 
+StreamCapability BufferedOutputStream::GetCapabilities() const
+{
+	return StreamCapability::Borrow;
+}
+
 void BufferedOutputStream::Close()
 {
 	if (m_UnderlyingStream)
@@ -277,34 +661,117 @@ void BufferedOutputStream::Close()
 
 		m_UnderlyingStream = nullptr;
 		m_Buffer.reset();
+		m_WriteWindowCurrent = nullptr;
+		m_WriteWindowEnd = nullptr;
 	}
 }
 
-std::size_t BufferedOutputStream::WriteBytes(std::span<const std::byte> const& buffer)
+bool BufferedOutputStream::Overflow(std::byte value)
 {
-	const auto writeSizeToBuffer =
-	    std::min(m_BufferSize - m_CurrentPosition, static_cast<std::size_t>(buffer.size()));
-	std::memcpy(&m_Buffer[m_CurrentPosition], buffer.data(), writeSizeToBuffer);
-	m_CurrentPosition += writeSizeToBuffer;
-	auto writtenSize = writeSizeToBuffer;
-	if (writeSizeToBuffer != buffer.size())
+	WriteBuffer();
+
+	// 缓存大小为 0 时直接写入包装流
+	if (m_WriteWindowCurrent == m_WriteWindowEnd)
 	{
-		Flush();
-		writtenSize += m_UnderlyingStream->WriteBytes(buffer.subspan(writeSizeToBuffer));
+		return m_UnderlyingStream->WriteByte(value);
+	}
+
+	*m_WriteWindowCurrent++ = value;
+	return true;
+}
+
+std::size_t
+BufferedOutputStream::WriteBytesVectored(std::span<const std::span<const std::byte>> const& buffers)
+{
+	std::size_t totalSize = 0;
+	for (const auto& buffer : buffers)
+	{
+		totalSize += buffer.size();
 	}
-	else if (m_CurrentPosition == m_BufferSize)
+
+	if (totalSize <= GetFreeSize())
 	{
-		Flush();
+		for (const auto& buffer : buffers)
+		{
+			std::memcpy(m_WriteWindowCurrent, buffer.data(), buffer.size());
+			m_WriteWindowCurrent += buffer.size();
+		}
+
+		if (m_WriteWindowCurrent == m_WriteWindowEnd)
+		{
+			WriteBuffer();
+		}
+
+		return totalSize;
+	}
+
+	// 缓存不足，将已缓存的内容与全部数据合并为一次写入，避免分别写出
+	// 分段较少时使用栈上的数组，避免每次写出都分配内存
+	constexpr std::size_t InlineSegmentCount = 8;
+	std::array<std::span<const std::byte>, InlineSegmentCount + 1> inlineSegments;
+	std::vector<std::span<const std::byte>> heapSegments;
+	std::span<std::span<const std::byte>> segments;
+	if (buffers.size() <= InlineSegmentCount)
+	{
+		segments = inlineSegments;
+	}
+	else
+	{
+		heapSegments.resize(buffers.size() + 1);
+		segments = heapSegments;
 	}
 
-	return writtenSize;
+	std::size_t segmentCount = 0;
+	if (const auto bufferedSize = GetBufferedSize())
+	{
+		segments[segmentCount++] = std::span<const std::byte>(m_Buffer.get(), bufferedSize);
+	}
+	std::ranges::copy(buffers, segments.begin() + segmentCount);
+	segmentCount += buffers.size();
+
+	m_UnderlyingStream->WriteBytesVectored(segments.first(segmentCount));
+	m_WriteWindowCurrent = m_Buffer.get();
+
+	return totalSize;
 }
 
 void BufferedOutputStream::Flush()
 {
-	if (m_CurrentPosition)
+	WriteBuffer();
+	m_UnderlyingStream->Flush();
+}
+
+void BufferedOutputStream::Sync(DurabilityLevel level)
+{
+	WriteBuffer();
+	m_UnderlyingStream->Sync(level);
+}
+
+std::span<std::byte> BufferedOutputStream::AcquireWriteBuffer(std::size_t size)
+{
+	if (size > GetFreeSize())
+	{
+		WriteBuffer();
+	}
+
+	return std::span(m_WriteWindowCurrent, std::min(size, GetFreeSize()));
+}
+
+void BufferedOutputStream::Commit(std::size_t n)
+{
+	assert(n <= GetFreeSize());
+	m_WriteWindowCurrent += n;
+	if (m_WriteWindowCurrent == m_WriteWindowEnd)
+	{
+		WriteBuffer();
+	}
+}
+
+void BufferedOutputStream::WriteBuffer()
+{
+	if (const auto bufferedSize = GetBufferedSize())
 	{
-		m_UnderlyingStream->WriteBytes(std::span(m_Buffer.get(), m_CurrentPosition));
-		m_CurrentPosition = 0;
+		m_UnderlyingStream->WriteBytes(std::span(m_Buffer.get(), bufferedSize));
+		m_WriteWindowCurrent = m_Buffer.get();
 	}
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "BufferPool.h"
 #include "StreamBase.h"
+#include <array>
+#include <cstring>
 #include <memory>
 
 namespace Cafe::Io
@@ -8,13 +11,19 @@ namespace Cafe::Io
 	/// @brief  缓存输入流
 	/// @remark 用于频繁小长度的读取时降低 IO 压力
 	///         本类不会取得包装流的所有权，在本类管理期间不应在外部操作包装流，否则可能导致错误
-	class CAFE_PUBLIC BufferedInputStream : public SeekableStream<InputStream>
+	///         包装流的能力在构造时查询一次并缓存，当前位置在用户空间中维护
+	///         缓存不会被初始化，可指定缓存池以在频繁创建及销毁时复用缓存
+	///         缓存为环形使用，填充时写入空闲部分，不会移动已缓存的数据，因此未读数据可能分为两段
+	///         可由 Mark 及 Reset 回到之前读取的位置，包装流不可寻位时也可使用，适用于需要回溯的解析器
+	class CAFE_PUBLIC BufferedInputStream final : public SeekableStream<InputStream>
 	{
 	public:
 		static constexpr std::size_t DefaultBufferSize = 1024;
 
+		/// @param  pool    从中取得缓存的缓存池，关闭时归还，为空时直接分配缓存
 		explicit BufferedInputStream(InputStream* stream,
-		                             std::size_t maxBufferSize = DefaultBufferSize);
+		                             std::size_t maxBufferSize = DefaultBufferSize,
+		                             BufferPool* pool = nullptr);
 
 		BufferedInputStream(BufferedInputStream const&) = delete;
 		BufferedInputStream(BufferedInputStream&& other) noexcept;
@@ -24,21 +33,50 @@ namespace Cafe::Io
 		BufferedInputStream& operator=(BufferedInputStream const&) = delete;
 		BufferedInputStream& operator=(BufferedInputStream&& other) noexcept;
 
-		/// @remark 关闭时若包装流是可寻位的将会设为用户当前读取的位置，并释放缓存
+		/// @remark 关闭时若包装流是可寻位的将会设为用户当前读取的位置，并释放或归还缓存
 		///         之后流处于无效状态，不可进行除析构以外的任何操作
 		void Close() override;
 
+		/// @remark 包含 StreamCapability::Borrow 及包装流的寻位相关能力
+		StreamCapability GetCapabilities() const override;
+
 		std::size_t GetAvailableBytes() override;
-		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
+
+		/// @remark 缓存中的数据足够时将内联完成
+		std::size_t ReadBytes(std::span<std::byte> const& buffer) override
+		{
+			if (buffer.size() < static_cast<std::size_t>(m_ReadWindowEnd - m_ReadWindowCurrent))
+			    [[likely]]
+			{
+				std::memcpy(buffer.data(), m_ReadWindowCurrent, buffer.size());
+				m_ReadWindowCurrent += buffer.size();
+				return buffer.size();
+			}
+
+			return ReadBytesSlow(buffer);
+		}
+
 		std::size_t Skip(std::size_t n) override;
 
+		/// @remark 借出缓存中的数据，缓存为空时将先填充缓存，借出的长度不超过缓存大小
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+		/// @remark 先写出缓存中的数据，剩余部分交由包装流的 CopyTo 完成
+		std::size_t CopyTo(OutputStream& stream, std::size_t size = std::size_t(-1)) override;
+
 		std::size_t GetPosition() const override;
 		void SeekFromBegin(std::size_t pos) override;
 		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
 		std::size_t GetTotalSize() override;
 
+		/// @remark 直接转发到包装流，不经过也不影响缓存
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
+
 		std::size_t GetMaxBufferSize() const noexcept;
+		/// @brief  获得当前段中的数据长度，包含已读取但仍保留在缓存中的部分
 		std::size_t GetBufferSize() const noexcept;
+		/// @brief  获得缓存中未读的数据长度，包含回绕的部分
 		std::size_t GetAvailableBufferSize() const noexcept;
 
 		InputStream* GetUnderlyingStream() const noexcept;
@@ -47,29 +85,96 @@ namespace Cafe::Io
 		/// @brief  不消费地读取一段数据
 		/// @remark 若 buffer 大小大于实际缓存大小，仅会读取实际缓存
 		std::size_t PeekBytes(std::span<std::byte> const& buffer);
+		/// @brief  不消费且不复制地查看缓存中的数据
+		/// @remark 缓存中的数据不足 minSize 时将先填充缓存，minSize 超过缓存大小时仅填满缓存
+		///         返回的两段依次连接即为缓存中全部未读的数据，第二段为回绕到缓存开头的部分，可能为空
+		///         返回的 span 在下一次读取、寻位或填充前有效
+		std::array<std::span<const std::byte>, 2> PeekSegments(std::size_t minSize = 1);
+
+		/// @brief  标记当前位置，之后读取的数据将被保留直到 Release，以便 Reset 回到标记的位置
+		/// @remark 已有标记时将替换原有的标记
+		///         标记期间缓存不会回绕，空间不足时将会扩大缓存以保留标记之后的全部数据，
+		///         因此应在回溯不再需要时尽早 Release
+		///         寻位到缓存以外的位置将会取消标记
+		void Mark();
+		/// @brief  回到标记的位置，标记仍然保留
+		/// @remark 没有标记时无操作
+		void Reset() noexcept;
+		/// @brief  取消标记，不改变当前位置
+		/// @remark 若缓存曾被扩大，在未读数据可容纳于原本的缓存时换回原本的缓存
+		void Release() noexcept;
+		bool IsMarked() const noexcept;
 
 	private:
 		InputStream* m_UnderlyingStream;
-		std::size_t m_LastReadBufferPosition;
-		std::unique_ptr<std::byte[]> m_Buffer;
+		// 仅在包装流具有 StreamCapability::Seekable 时非空
+		SeekableStream<InputStream>* m_SeekableUnderlyingStream;
+		StreamCapability m_UnderlyingCapabilities;
+		// 包装流的当前位置，即缓存结尾对应的位置，仅在包装流可寻位时有意义
+		std::size_t m_UnderlyingPosition;
+		BufferPool::Buffer m_Buffer;
 		std::size_t m_MaxBufferSize;
+		// 缓存的实际大小，标记期间扩大缓存时大于 m_MaxBufferSize
+		std::size_t m_BufferCapacity;
+		// 当前段为 [0, m_ReadSize)，其中当前位置之后的部分为未读的部分
+		// 当前位置由读取窗口的起始 m_ReadWindowCurrent 表示，以便 ReadByte 内联地前移
+		// 当前段到达缓存结尾后，继续填充的数据写入缓存开头的 [0, m_WrapSize)，即回绕段
+		// 回绕段非空时当前段总有未读的数据，当前段读完后回绕段将成为新的当前段
 		std::size_t m_ReadSize;
-		std::size_t m_CurrentPosition;
+		std::size_t m_WrapSize;
+		// 标记的位置在当前段中的偏移，没有标记时为 NoMark，有标记时回绕段总为空
+		std::size_t m_MarkOffset;
+		// 标记期间扩大缓存时保存原本的缓存，以便之后换回
+		BufferPool::Buffer m_SpareBuffer;
+
+		static constexpr std::size_t NoMark = std::size_t(-1);
+
+		/// @remark 经过 ReadBytesSlow 读取，以便在当前段读完时切换到回绕段或填充缓存
+		std::optional<std::byte> Underflow() override;
+
+		std::size_t ReadBytesSlow(std::span<std::byte> const& buffer);
+
+		/// @brief  获得当前位置在当前段中的偏移
+		std::size_t GetCurrentOffset() const noexcept
+		{
+			return static_cast<std::size_t>(m_ReadWindowCurrent - m_Buffer.get());
+		}
+
+		/// @brief  将当前位置设为当前段中的 currentOffset，并按当前段及回绕段更新读取窗口
+		/// @remark 缓存、当前段或回绕段改变后均需调用
+		void UpdateReadWindow(std::size_t currentOffset) noexcept;
 
-		void FlushBuffer(bool keep = true, std::size_t needSize = std::size_t(-1));
-		void FillBuffer(bool keep = true, std::size_t needSize = std::size_t(-1));
+		void CheckSeekable() const;
+		/// @brief  丢弃缓存中的数据并取消标记
+		void DiscardBuffer() noexcept;
+
+		/// @brief  消费缓存中的 n 个字节，n 不超过缓存中未读的长度
+		/// @remark 当前段读完时切换到回绕段
+		void Advance(std::size_t n) noexcept;
+
+		/// @brief  从包装流读取到缓存的空闲部分，直到缓存中至少有 needSize 个字节、缓存已满或流已到结尾
+		/// @param  keep    是否保留缓存中未读取的数据，保留的数据不会被移动
+		/// @remark 有标记时总会保留标记之后的数据，needSize 不受缓存大小的限制
+		void FillBuffer(bool keep = true, std::size_t needSize = 1);
+
+		/// @brief  标记期间当前段已到达缓存结尾时，丢弃标记及当前位置之前的数据并在必要时扩大缓存，
+		///         使当前段之后至少有 extraSize 个字节的空闲
+		void ReserveMarkedSpace(std::size_t extraSize);
 	};
 
 	/// @brief  缓存输出流
 	/// @remark 用于频繁小长度的写入时降低 IO 压力
 	///         本类不会取得包装流的所有权，在本类管理期间不应在外部操作包装流，否则可能导致错误
-	class CAFE_PUBLIC BufferedOutputStream : public OutputStream
+	///         缓存不会被初始化，可指定缓存池以在频繁创建及销毁时复用缓存
+	class CAFE_PUBLIC BufferedOutputStream final : public OutputStream
 	{
 	public:
 		static constexpr std::size_t DefaultBufferSize = 1024;
 
+		/// @param  pool    从中取得缓存的缓存池，关闭时归还，为空时直接分配缓存
 		explicit BufferedOutputStream(OutputStream* stream,
-		                              std::size_t bufferSize = DefaultBufferSize);
+		                              std::size_t bufferSize = DefaultBufferSize,
+		                              BufferPool* pool = nullptr);
 		BufferedOutputStream(BufferedOutputStream const&) = delete;
 		BufferedOutputStream(BufferedOutputStream&& other) noexcept;
 
@@ -78,17 +183,61 @@ namespace Cafe::Io
 		BufferedOutputStream& operator=(BufferedOutputStream const&) = delete;
 		BufferedOutputStream& operator=(BufferedOutputStream&& other) noexcept;
 
-		/// @remark 关闭时将会向包装流写出所有缓存内容，并释放缓存
+		/// @remark 关闭时将会向包装流写出所有缓存内容并刷新包装流，之后释放或归还缓存
 		///         之后流处于无效状态，不可进行除析构以外的任何操作
 		void Close() override;
 
-		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override;
+		StreamCapability GetCapabilities() const override;
+
+		/// @remark 缓存空间足够时将内联完成
+		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+		{
+			if (buffer.size() < GetFreeSize()) [[likely]]
+			{
+				std::memcpy(m_WriteWindowCurrent, buffer.data(), buffer.size());
+				m_WriteWindowCurrent += buffer.size();
+				return buffer.size();
+			}
+
+			return WriteBytesVectored(std::span(&buffer, 1));
+		}
+
+		/// @remark 缓存无法容纳全部数据时，已缓存的内容将与 buffers 合并为一次向量写入
+		std::size_t
+		WriteBytesVectored(std::span<const std::span<const std::byte>> const& buffers) override;
+
+		/// @remark 写出缓存内容后刷新包装流
 		void Flush() override;
+		/// @remark 写出缓存内容后将 level 转发给包装流
+		void Sync(DurabilityLevel level = DurabilityLevel::Full) override;
+
+		/// @remark 返回缓存中的空闲部分，若空闲部分不足 size 则先刷新缓存
+		///         返回的长度不超过缓存大小
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
 
 	private:
 		OutputStream* m_UnderlyingStream;
-		std::unique_ptr<std::byte[]> m_Buffer;
+		// 缓存中已写入的部分为 [m_Buffer, m_WriteWindowCurrent)，写入窗口为缓存中其余的空闲部分
+		BufferPool::Buffer m_Buffer;
 		std::size_t m_BufferSize;
-		std::size_t m_CurrentPosition;
+
+		/// @remark 写入窗口为空即缓存已满，写出缓存后写入
+		bool Overflow(std::byte value) override;
+
+		/// @brief  获得缓存中已写入的长度
+		std::size_t GetBufferedSize() const noexcept
+		{
+			return static_cast<std::size_t>(m_WriteWindowCurrent - m_Buffer.get());
+		}
+
+		/// @brief  获得缓存中空闲的长度
+		std::size_t GetFreeSize() const noexcept
+		{
+			return static_cast<std::size_t>(m_WriteWindowEnd - m_WriteWindowCurrent);
+		}
+
+		/// @brief  向包装流写出缓存内容，不刷新包装流
+		void WriteBuffer();
 	};
 } // namespace Cafe::Io
@@ -1,31 +1,296 @@
 #include <Cafe/Io/Streams/FileStream.h>
+#include <Cafe/Misc/Scope.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <sys/ioctl.h>
+#endif
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#endif
 
 using namespace Cafe;
 using namespace Io;
 
-FileInputStream::FileInputStream(std::filesystem::path const& path)
-    : FileInputStream{ PathToNativeString(path) }
+namespace
+{
+	template <typename GetTotalSizeFunc>
+	std::size_t GetSeekTarget(SeekOrigin origin, std::ptrdiff_t diff, std::size_t position,
+	                          GetTotalSizeFunc&& getTotalSize)
+	{
+		std::size_t base;
+		switch (origin)
+		{
+		default:
+			assert(!"Invalid origin.");
+			[[fallthrough]];
+		case SeekOrigin::Begin:
+			base = 0;
+			break;
+		case SeekOrigin::Current:
+			base = position;
+			break;
+		case SeekOrigin::End:
+			base = getTotalSize();
+			break;
+		}
+
+		if (diff < 0 && std::size_t(0) - static_cast<std::size_t>(diff) > base)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot set position."));
+		}
+
+		return base + static_cast<std::size_t>(diff);
+	}
+} // namespace
+
+#if !defined(_WIN32)
+namespace
+{
+	// 单次 readv/writev 提交的最大缓存数，超出的部分将分批提交
+	constexpr std::size_t MaxIoVecCount = 64;
+
+	// FileCachePolicy::Direct 模式下内部缓存的大小
+	constexpr std::size_t DirectIoBufferSize = 1024 * 1024;
+
+	// 无法查询对齐要求时使用的对齐，是常见设备逻辑块大小及页大小的倍数
+	constexpr std::size_t DefaultDirectIoAlignment = 4096;
+
+	int GetCachePolicyOpenFlags(FileCachePolicy cachePolicy)
+	{
+		if (cachePolicy == FileCachePolicy::Direct)
+		{
+#if defined(O_DIRECT)
+			return O_DIRECT;
+#elif !defined(F_NOCACHE)
+			CAFE_THROW(FileIoException,
+			           CAFE_UTF8_SV("Direct I/O is not supported on this platform."));
+#endif
+		}
+
+		return 0;
+	}
+
+	std::size_t GetDirectIoAlignment([[maybe_unused]] int fileHandle) noexcept
+	{
+		std::size_t alignment = DefaultDirectIoAlignment;
+#if defined(__linux__) && defined(STATX_DIOALIGN)
+		// 自 Linux 6.1 起可查询文件实际的对齐要求，均为 2 的幂
+		if (struct statx fileStat;
+		    statx(fileHandle, "", AT_EMPTY_PATH, STATX_DIOALIGN, &fileStat) == 0 &&
+		    (fileStat.stx_mask & STATX_DIOALIGN))
+		{
+			alignment = std::max({ alignment, static_cast<std::size_t>(fileStat.stx_dio_mem_align),
+			                       static_cast<std::size_t>(fileStat.stx_dio_offset_align) });
+		}
+#endif
+		return alignment;
+	}
+
+	std::unique_ptr<Detail::DirectIoBuffer> CreateDirectIoBuffer(int fileHandle,
+	                                                             StreamCapability capabilities)
+	{
+		if (!HasCapability(capabilities, StreamCapability::Seekable))
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Direct I/O requires a seekable file."));
+		}
+
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+		if (fcntl(fileHandle, F_NOCACHE, 1) == -1)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot disable file cache."));
+		}
+#endif
+
+		const auto alignment = GetDirectIoAlignment(fileHandle);
+		const auto capacity = (DirectIoBufferSize + alignment - 1) & ~(alignment - 1);
+		return std::make_unique<Detail::DirectIoBuffer>(Detail::DirectIoBuffer{
+		    .Storage = { static_cast<std::byte*>(
+		                     ::operator new[](capacity, std::align_val_t{ alignment })),
+		                 { alignment } },
+		    .Alignment = alignment,
+		    .Capacity = capacity,
+		    .BufferOffset = 0,
+		    .BufferSize = 0,
+		    .Cursor = 0 });
+	}
+
+	bool IsAligned(const void* ptr, std::size_t alignment) noexcept
+	{
+		return !(reinterpret_cast<std::uintptr_t>(ptr) & (alignment - 1));
+	}
+
+	/// @brief  以对齐的偏移及长度读取，直到填满 data 或到达结尾
+	std::size_t DirectRead(int fileHandle, std::byte* data, std::size_t size, std::size_t offset,
+	                       std::size_t alignment)
+	{
+		std::size_t totalReadSize = 0;
+		while (totalReadSize < size)
+		{
+			const auto readSize = pread(fileHandle, data + totalReadSize, size - totalReadSize,
+			                            static_cast<off_t>(offset + totalReadSize));
+			if (readSize == ssize_t(-1))
+			{
+				CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot read file."));
+			}
+
+			totalReadSize += static_cast<std::size_t>(readSize);
+			// 读取的长度不对齐时已到结尾，且之后的偏移不再满足对齐要求
+			if (!readSize || (static_cast<std::size_t>(readSize) & (alignment - 1)))
+			{
+				break;
+			}
+		}
+
+		return totalReadSize;
+	}
+
+	void PositionalWriteAll(int fileHandle, const std::byte* data, std::size_t size,
+	                        std::size_t offset)
+	{
+		while (size)
+		{
+			const auto writtenSize = pwrite(fileHandle, data, size, static_cast<off_t>(offset));
+			if (writtenSize == ssize_t(-1))
+			{
+				CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
+			}
+
+			data += writtenSize;
+			size -= static_cast<std::size_t>(writtenSize);
+			offset += static_cast<std::size_t>(writtenSize);
+		}
+	}
+
+	/// @brief  写出不满足对齐要求的数据
+	void UnalignedWriteAll(int fileHandle, const std::byte* data, std::size_t size,
+	                       std::size_t offset)
+	{
+#if defined(O_DIRECT)
+		// O_DIRECT 下无法写出不对齐的数据，暂时关闭 O_DIRECT 经由页缓存写出
+		const auto flags = fcntl(fileHandle, F_GETFL);
+		if (flags == -1 || fcntl(fileHandle, F_SETFL, flags & ~O_DIRECT) == -1)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
+		}
+
+		CAFE_SCOPE_EXIT
+		{
+			fcntl(fileHandle, F_SETFL, flags);
+		};
+#endif
+
+		PositionalWriteAll(fileHandle, data, size, offset);
+	}
+
+	std::size_t GetFileSize(int fileHandle)
+	{
+		struct stat fileStat;
+		if (fstat(fileHandle, &fileStat) == -1)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot fetch file size."));
+		}
+
+		return static_cast<std::size_t>(fileStat.st_size);
+	}
+} // namespace
+#endif
+
+#if defined(__linux__)
+namespace
+{
+	// sendfile 单次最多传输 0x7ffff000 字节，统一限制内核复制单次请求的长度
+	constexpr std::size_t MaxKernelCopySize = 0x40000000;
+
+	enum class KernelCopyMethod
+	{
+		CopyFileRange,
+		SendFile,
+		Splice
+	};
+
+	bool IsPipe(int fileHandle) noexcept
+	{
+		struct stat fileStat;
+		return fstat(fileHandle, &fileStat) == 0 && S_ISFIFO(fileStat.st_mode);
+	}
+
+	ssize_t KernelCopy(KernelCopyMethod method, int inHandle, int outHandle, std::size_t size)
+	{
+		switch (method)
+		{
+		default:
+			assert(!"Invalid method.");
+			[[fallthrough]];
+		case KernelCopyMethod::CopyFileRange:
+			return copy_file_range(inHandle, nullptr, outHandle, nullptr, size, 0);
+		case KernelCopyMethod::SendFile:
+			return sendfile(outHandle, inHandle, nullptr, size);
+		case KernelCopyMethod::Splice:
+			return splice(inHandle, nullptr, outHandle, nullptr, size, SPLICE_F_MOVE);
+		}
+	}
+
+	// 表示此方式不适用于这对文件，应尝试其他方式
+	bool IsKernelCopyUnsupported(int error) noexcept
+	{
+		return error == EXDEV || error == EINVAL || error == ENOSYS || error == EOPNOTSUPP;
+	}
+
+	bool IsAppending(int fileHandle) noexcept
+	{
+		const auto flags = fcntl(fileHandle, F_GETFL);
+		return flags != -1 && (flags & O_APPEND);
+	}
+} // namespace
+#endif
+
+FileInputStream::FileInputStream(std::filesystem::path const& path, FileCachePolicy cachePolicy)
+    : FileInputStream{ PathToNativeString(path), cachePolicy }
 {
 }
 
-FileInputStream::FileInputStream(Encoding::StringView<PathNativeCodePage> const& path)
+FileInputStream::FileInputStream(Encoding::StringView<PathNativeCodePage> const& path,
+                                 FileCachePolicy cachePolicy)
 {
 	Encoding::String<PathNativeCodePage> pathStr;
 	const auto pathStrValue = reinterpret_cast<const char*>(
 	    path.IsNullTerminated() ? path.GetData() : (pathStr = path).GetData());
 
 #if defined(_WIN32)
+	if (cachePolicy == FileCachePolicy::Direct)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Direct I/O is not supported on this platform."));
+	}
+
 	m_FileHandle =
 	    CreateFileW(reinterpret_cast<LPCWSTR>(pathStrValue), GENERIC_READ, FILE_SHARE_READ, nullptr,
 	                OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, nullptr);
 #else
-	m_FileHandle = open(pathStrValue, O_RDONLY);
+	m_FileHandle = open(pathStrValue, O_RDONLY | GetCachePolicyOpenFlags(cachePolicy));
 #endif
 
 	if (m_FileHandle == InvalidHandleValue)
 	{
 		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Open file failed."));
 	}
+
+	InitializeCapabilities();
+
+#if !defined(_WIN32)
+	if (cachePolicy == FileCachePolicy::Direct)
+	{
+		m_DirectIoBuffer = CreateDirectIoBuffer(m_FileHandle, m_Capabilities);
+		// 读取需经由内部缓存，因此不可并发调用 ReadAt
+		m_Capabilities = StreamCapability::Seekable | StreamCapability::KnownSize;
+	}
+#endif
 }
 
 FileInputStream::FileInputStream(Detail::SpecifyNativeHandleTag, NativeHandle fileHandle,
@@ -37,15 +302,156 @@ FileInputStream::FileInputStream(Detail::SpecifyNativeHandleTag, NativeHandle fi
 	{
 		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Invalid fileHandle."));
 	}
+
+	if (IsPositionTracked())
+	{
+		m_Position = FileStreamCommonPart::GetPosition();
+	}
 }
 
 FileInputStream::~FileInputStream()
 {
 }
 
+void FileInputStream::Close()
+{
+	m_DirectIoBuffer.reset();
+	m_Position = 0;
+	m_CachedSize = std::size_t(-1);
+	FileStreamCommonPart::Close();
+}
+
+FileCachePolicy FileInputStream::GetCachePolicy() const noexcept
+{
+	return m_DirectIoBuffer ? FileCachePolicy::Direct : FileCachePolicy::Default;
+}
+
+std::size_t FileInputStream::GetPosition() const
+{
+	if (m_DirectIoBuffer)
+	{
+		return m_DirectIoBuffer->BufferOffset + m_DirectIoBuffer->Cursor;
+	}
+
+	if (IsPositionTracked())
+	{
+		return m_Position;
+	}
+
+	return FileStreamCommonPart::GetPosition();
+}
+
+void FileInputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+#if !defined(_WIN32)
+	if (m_DirectIoBuffer)
+	{
+		auto& directIoBuffer = *m_DirectIoBuffer;
+		const auto target =
+		    GetSeekTarget(origin, diff, GetPosition(), [this] { return GetTotalSize(); });
+		// 目标位置在缓存中时保留缓存，否则下次读取时读入目标位置所在的块
+		if (target >= directIoBuffer.BufferOffset &&
+		    target <= directIoBuffer.BufferOffset + directIoBuffer.BufferSize)
+		{
+			directIoBuffer.Cursor = target - directIoBuffer.BufferOffset;
+		}
+		else
+		{
+			directIoBuffer.BufferOffset = target & ~(directIoBuffer.Alignment - 1);
+			directIoBuffer.BufferSize = 0;
+			directIoBuffer.Cursor = target - directIoBuffer.BufferOffset;
+		}
+		return;
+	}
+#endif
+
+	if (IsPositionTracked())
+	{
+		const auto target =
+		    GetSeekTarget(origin, diff, m_Position, [this] { return GetTotalSize(); });
+		if (target != m_Position)
+		{
+			FileStreamCommonPart::Seek(SeekOrigin::Begin, static_cast<std::ptrdiff_t>(target));
+			m_Position = target;
+		}
+		return;
+	}
+
+	FileStreamCommonPart::Seek(origin, diff);
+}
+
+std::size_t FileInputStream::GetTotalSize()
+{
+	if (!HasCapability(m_Capabilities, StreamCapability::Seekable))
+	{
+		return FileStreamCommonPart::GetTotalSize();
+	}
+
+	if (m_CachedSize == std::size_t(-1))
+	{
+		RefreshSize();
+	}
+
+	return m_CachedSize;
+}
+
+std::size_t FileInputStream::RefreshSize()
+{
+#if defined(_WIN32)
+	m_CachedSize = FileStreamCommonPart::GetTotalSize();
+#else
+	struct stat fileStat;
+	if (fstat(m_FileHandle, &fileStat) == -1)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot fetch file size."));
+	}
+
+	if (S_ISREG(fileStat.st_mode))
+	{
+		m_CachedSize = static_cast<std::size_t>(fileStat.st_size);
+	}
+	else
+	{
+		// 块设备等的 st_size 没有意义，寻位到结尾获得长度后恢复文件句柄的位置
+		const auto size = lseek(m_FileHandle, 0, SEEK_END);
+		if (size == off_t(-1) ||
+		    lseek(m_FileHandle, static_cast<off_t>(m_Position), SEEK_SET) == off_t(-1))
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot fetch file size."));
+		}
+		m_CachedSize = static_cast<std::size_t>(size);
+	}
+#endif
+
+	return m_CachedSize;
+}
+
 std::size_t FileInputStream::GetAvailableBytes()
 {
-	return GetTotalSize() - GetPosition();
+	if (!HasCapability(m_Capabilities, StreamCapability::Seekable))
+	{
+		// 管道等不可寻位的文件，查询已到达但尚未读取的字节数
+#if defined(_WIN32)
+		DWORD availableSize;
+		if (GetFileType(m_FileHandle) != FILE_TYPE_PIPE ||
+		    !PeekNamedPipe(m_FileHandle, nullptr, 0, nullptr, &availableSize, nullptr))
+		{
+			return 0;
+		}
+#else
+		int availableSize;
+		if (ioctl(m_FileHandle, FIONREAD, &availableSize) == -1)
+		{
+			return 0;
+		}
+#endif
+		return static_cast<std::size_t>(availableSize);
+	}
+
+	// 可能已寻位到结尾以后
+	const auto totalSize = GetTotalSize();
+	const auto position = GetPosition();
+	return totalSize > position ? totalSize - position : 0;
 }
 
 std::size_t FileInputStream::ReadBytes(std::span<std::byte> const& buffer)
@@ -75,20 +481,79 @@ std::size_t FileInputStream::ReadBytes(std::span<std::byte> const& buffer)
 		size -= readSize;
 	}
 
+	OnBytesRead(buffer.size() - size);
 	return buffer.size() - size;
 #else
+	if (m_DirectIoBuffer)
+	{
+		return DirectReadBytes(buffer);
+	}
+
 	const auto readSize = read(m_FileHandle, data, size);
 	if (readSize == ssize_t(-1))
 	{
 		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot read file."));
 	}
 
+	OnBytesRead(static_cast<std::size_t>(readSize));
 	return static_cast<std::size_t>(readSize);
 #endif
 }
 
+std::size_t
+FileInputStream::ReadBytesVectored(std::span<const std::span<std::byte>> const& buffers)
+{
+#if defined(_WIN32)
+	// ReadFileScatter 要求缓存按页对齐，无法用于一般情况
+	return InputStream::ReadBytesVectored(buffers);
+#else
+	if (m_DirectIoBuffer)
+	{
+		return InputStream::ReadBytesVectored(buffers);
+	}
+
+	std::size_t totalReadSize = 0;
+	auto remainedBuffers = buffers;
+
+	while (!remainedBuffers.empty())
+	{
+		iovec ioVecs[MaxIoVecCount];
+		const auto ioVecCount = std::min(MaxIoVecCount, remainedBuffers.size());
+		std::size_t requestedSize = 0;
+		for (std::size_t i = 0; i < ioVecCount; ++i)
+		{
+			ioVecs[i].iov_base = remainedBuffers[i].data();
+			ioVecs[i].iov_len = remainedBuffers[i].size();
+			requestedSize += remainedBuffers[i].size();
+		}
+
+		const auto readSize = readv(m_FileHandle, ioVecs, static_cast<int>(ioVecCount));
+		if (readSize == ssize_t(-1))
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot read file."));
+		}
+
+		OnBytesRead(static_cast<std::size_t>(readSize));
+		totalReadSize += static_cast<std::size_t>(readSize);
+		if (static_cast<std::size_t>(readSize) != requestedSize)
+		{
+			break;
+		}
+
+		remainedBuffers = remainedBuffers.subspan(ioVecCount);
+	}
+
+	return totalReadSize;
+#endif
+}
+
 std::size_t FileInputStream::Skip(std::size_t n)
 {
+	if (!HasCapability(m_Capabilities, StreamCapability::Seekable))
+	{
+		return InputStream::Skip(n);
+	}
+
 	n = std::min(n, GetAvailableBytes());
 
 	if (n > static_cast<std::size_t>(std::numeric_limits<std::ptrdiff_t>::max()))
@@ -105,6 +570,217 @@ std::size_t FileInputStream::Skip(std::size_t n)
 	return n;
 }
 
+std::size_t FileInputStream::ReadAt(std::size_t offset, std::span<std::byte> const& buffer)
+{
+	if (m_DirectIoBuffer)
+	{
+		return FileStreamCommonPart::ReadAt(offset, buffer);
+	}
+
+	auto data = buffer.data();
+	auto size = static_cast<std::size_t>(buffer.size());
+
+	while (size)
+	{
+#if defined(_WIN32)
+		OVERLAPPED overlapped{};
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = static_cast<DWORD>(static_cast<std::uint64_t>(offset) >> 32);
+
+		DWORD readSize;
+		if (!ReadFile(m_FileHandle, data,
+		              static_cast<DWORD>(std::min(
+		                  size, static_cast<std::size_t>(std::numeric_limits<DWORD>::max()))),
+		              &readSize, &overlapped))
+		{
+			if (GetLastError() == ERROR_HANDLE_EOF)
+			{
+				break;
+			}
+
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot read file."));
+		}
+#else
+		const auto readSize = pread(m_FileHandle, data, size, static_cast<off_t>(offset));
+		if (readSize == ssize_t(-1))
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot read file."));
+		}
+#endif
+
+		// 已到结尾
+		if (!readSize)
+		{
+			break;
+		}
+
+		data += readSize;
+		size -= static_cast<std::size_t>(readSize);
+		offset += static_cast<std::size_t>(readSize);
+	}
+
+#if defined(_WIN32)
+	// 同步句柄的文件指针已被 ReadFile 改变
+	if (!buffer.empty() && IsPositionTracked())
+	{
+		m_Position = FileStreamCommonPart::GetPosition();
+	}
+#endif
+
+	return buffer.size() - size;
+}
+
+std::size_t FileInputStream::CopyTo(OutputStream& stream, std::size_t size)
+{
+	std::size_t copiedSize = 0;
+
+#if defined(__linux__)
+	// 直接读写模式下的数据可能仍在流内部的缓存中，且内核复制不满足对齐要求
+	if (const auto fileOutputStream = dynamic_cast<FileOutputStream*>(&stream);
+	    fileOutputStream && !m_DirectIoBuffer &&
+	    fileOutputStream->GetCachePolicy() == FileCachePolicy::Default)
+	{
+		const auto outHandle = fileOutputStream->GetNativeHandle();
+
+		KernelCopyMethod methods[2];
+		std::size_t methodCount;
+		if (IsPipe(m_FileHandle) || IsPipe(outHandle))
+		{
+			methods[0] = KernelCopyMethod::Splice;
+			methodCount = 1;
+		}
+		else if (IsAppending(outHandle))
+		{
+			// copy_file_range 对追加模式的输出以 EBADF 失败，sendfile 亦不支持，直接在用户空间复制
+			methodCount = 0;
+		}
+		else
+		{
+			methods[0] = KernelCopyMethod::CopyFileRange;
+			methods[1] = KernelCopyMethod::SendFile;
+			methodCount = 2;
+		}
+
+		// 失败的调用不会复制任何内容，因此可以在任意时刻换用其他方式继续复制
+		for (std::size_t i = 0; i < methodCount && copiedSize < size; ++i)
+		{
+			while (copiedSize < size)
+			{
+				const auto result = KernelCopy(methods[i], m_FileHandle, outHandle,
+				                               std::min(size - copiedSize, MaxKernelCopySize));
+				if (result == ssize_t(-1))
+				{
+					if (IsKernelCopyUnsupported(errno))
+					{
+						break;
+					}
+
+					CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot copy file."));
+				}
+
+				// 已到结尾
+				if (!result)
+				{
+					return copiedSize;
+				}
+
+				OnBytesRead(static_cast<std::size_t>(result));
+				copiedSize += static_cast<std::size_t>(result);
+			}
+		}
+
+		if (copiedSize == size)
+		{
+			return copiedSize;
+		}
+	}
+#endif
+
+	return copiedSize + InputStream::CopyTo(stream, size - copiedSize);
+}
+
+bool FileInputStream::IsPositionTracked() const noexcept
+{
+	return HasCapability(m_Capabilities, StreamCapability::Seekable) && !m_DirectIoBuffer;
+}
+
+void FileInputStream::OnBytesRead(std::size_t size) noexcept
+{
+	if (!IsPositionTracked())
+	{
+		return;
+	}
+
+	m_Position += size;
+	// 读取到缓存的长度以后说明文件已增长
+	if (m_CachedSize != std::size_t(-1) && m_Position > m_CachedSize)
+	{
+		m_CachedSize = m_Position;
+	}
+}
+
+#if !defined(_WIN32)
+std::size_t FileInputStream::DirectReadBytes(std::span<std::byte> const& buffer)
+{
+	auto& directIoBuffer = *m_DirectIoBuffer;
+	const auto alignmentMask = directIoBuffer.Alignment - 1;
+	auto data = buffer.data();
+	auto size = static_cast<std::size_t>(buffer.size());
+
+	while (size)
+	{
+		if (directIoBuffer.Cursor < directIoBuffer.BufferSize)
+		{
+			const auto copySize = std::min(size, directIoBuffer.BufferSize - directIoBuffer.Cursor);
+			std::memcpy(data, directIoBuffer.Storage.get() + directIoBuffer.Cursor, copySize);
+			directIoBuffer.Cursor += copySize;
+			data += copySize;
+			size -= copySize;
+			continue;
+		}
+
+		// 缓存已读完，移动到当前位置所在的块
+		const auto position = directIoBuffer.BufferOffset + directIoBuffer.Cursor;
+		directIoBuffer.BufferOffset = position & ~alignmentMask;
+		directIoBuffer.BufferSize = 0;
+		directIoBuffer.Cursor = position & alignmentMask;
+
+		// 位置及用户缓存均对齐时直接读入用户缓存，省去一次复制
+		if (!directIoBuffer.Cursor && size > alignmentMask &&
+		    IsAligned(data, directIoBuffer.Alignment))
+		{
+			const auto requestSize = size & ~alignmentMask;
+			const auto readSize = DirectRead(m_FileHandle, data, requestSize,
+			                                 directIoBuffer.BufferOffset, directIoBuffer.Alignment);
+			const auto newPosition = directIoBuffer.BufferOffset + readSize;
+			directIoBuffer.BufferOffset = newPosition & ~alignmentMask;
+			directIoBuffer.Cursor = newPosition & alignmentMask;
+			data += readSize;
+			size -= readSize;
+
+			// 已到结尾
+			if (readSize != requestSize)
+			{
+				break;
+			}
+			continue;
+		}
+
+		directIoBuffer.BufferSize =
+		    DirectRead(m_FileHandle, directIoBuffer.Storage.get(), directIoBuffer.Capacity,
+		               directIoBuffer.BufferOffset, directIoBuffer.Alignment);
+
+		// 已到结尾
+		if (directIoBuffer.Cursor >= directIoBuffer.BufferSize)
+		{
+			break;
+		}
+	}
+
+	return buffer.size() - size;
+}
+#endif
+
 FileInputStream FileInputStream::CreateStdInStream()
 {
 #ifdef _WIN32
@@ -114,19 +790,25 @@ FileInputStream FileInputStream::CreateStdInStream()
 #endif
 }
 
-FileOutputStream::FileOutputStream(std::filesystem::path const& path, FileOpenMode openMode)
-    : FileOutputStream{ PathToNativeString(path), openMode }
+FileOutputStream::FileOutputStream(std::filesystem::path const& path, FileOpenMode openMode,
+                                   FileCachePolicy cachePolicy)
+    : FileOutputStream{ PathToNativeString(path), openMode, cachePolicy }
 {
 }
 
 FileOutputStream::FileOutputStream(Encoding::StringView<PathNativeCodePage> const& path,
-                                   FileOpenMode openMode)
+                                   FileOpenMode openMode, FileCachePolicy cachePolicy)
 {
 	Encoding::String<PathNativeCodePage> pathStr;
 	const auto pathStrValue = reinterpret_cast<const char*>(
 	    path.IsNullTerminated() ? path.GetData() : (pathStr = path).GetData());
 
 #if defined(_WIN32)
+	if (cachePolicy == FileCachePolicy::Direct)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Direct I/O is not supported on this platform."));
+	}
+
 	m_FileHandle =
 	    CreateFileW(reinterpret_cast<LPCWSTR>(pathStrValue), GENERIC_READ | GENERIC_WRITE, 0,
 	                nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
@@ -148,7 +830,7 @@ FileOutputStream::FileOutputStream(Encoding::StringView<PathNativeCodePage> cons
 	}
 #else
 
-	auto openModeValue = O_CREAT | O_RDWR;
+	auto openModeValue = O_CREAT | O_RDWR | GetCachePolicyOpenFlags(cachePolicy);
 	switch (openMode)
 	{
 	default:
@@ -158,7 +840,10 @@ FileOutputStream::FileOutputStream(Encoding::StringView<PathNativeCodePage> cons
 		openModeValue |= O_TRUNC;
 		break;
 	case FileOpenMode::Append:
-		openModeValue |= O_APPEND;
+		if (cachePolicy != FileCachePolicy::Direct)
+		{
+			openModeValue |= O_APPEND;
+		}
 		break;
 	case FileOpenMode::Overwrite:
 		break;
@@ -171,6 +856,18 @@ FileOutputStream::FileOutputStream(Encoding::StringView<PathNativeCodePage> cons
 	{
 		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Open file failed."));
 	}
+
+	InitializeCapabilities();
+
+#if !defined(_WIN32)
+	if (cachePolicy == FileCachePolicy::Direct)
+	{
+		m_DirectIoBuffer = CreateDirectIoBuffer(m_FileHandle, m_Capabilities);
+		// 写入需经由内部缓存，因此不可并发调用 WriteAt
+		m_Capabilities = StreamCapability::Seekable | StreamCapability::KnownSize;
+		ResetDirectIoBuffer(openMode == FileOpenMode::Append ? GetFileSize(m_FileHandle) : 0);
+	}
+#endif
 }
 
 FileOutputStream::FileOutputStream(Detail::SpecifyNativeHandleTag, NativeHandle fileHandle,
@@ -186,6 +883,83 @@ FileOutputStream::FileOutputStream(Detail::SpecifyNativeHandleTag, NativeHandle
 
 FileOutputStream::~FileOutputStream()
 {
+	FileOutputStream::Close();
+}
+
+void FileOutputStream::Close()
+{
+	ResetDropCache();
+
+#if !defined(_WIN32)
+	if (m_DirectIoBuffer)
+	{
+		CAFE_SCOPE_EXIT
+		{
+			m_DirectIoBuffer.reset();
+			FileStreamCommonPart::Close();
+		};
+
+		WriteDirectIoBuffer();
+		return;
+	}
+#endif
+
+	FileStreamCommonPart::Close();
+}
+
+FileCachePolicy FileOutputStream::GetCachePolicy() const noexcept
+{
+	return m_DirectIoBuffer ? FileCachePolicy::Direct : FileCachePolicy::Default;
+}
+
+std::size_t FileOutputStream::GetPosition() const
+{
+	if (m_DirectIoBuffer)
+	{
+		return m_DirectIoBuffer->BufferOffset + m_DirectIoBuffer->Cursor;
+	}
+
+	return FileStreamCommonPart::GetPosition();
+}
+
+void FileOutputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+#if !defined(_WIN32)
+	if (m_DirectIoBuffer)
+	{
+		auto& directIoBuffer = *m_DirectIoBuffer;
+		const auto target =
+		    GetSeekTarget(origin, diff, GetPosition(), [this] { return GetTotalSize(); });
+		// 缓存中 BufferSize 以后的部分可能与文件内容不一致，因此仅在此范围内移动
+		if (target >= directIoBuffer.BufferOffset &&
+		    target <= directIoBuffer.BufferOffset + directIoBuffer.BufferSize)
+		{
+			directIoBuffer.Cursor = target - directIoBuffer.BufferOffset;
+		}
+		else
+		{
+			WriteDirectIoBuffer();
+			ResetDirectIoBuffer(target);
+		}
+		return;
+	}
+#endif
+
+	ResetDropCache();
+	FileStreamCommonPart::Seek(origin, diff);
+}
+
+std::size_t FileOutputStream::GetTotalSize()
+{
+#if !defined(_WIN32)
+	if (m_DirectIoBuffer)
+	{
+		return std::max(GetFileSize(m_FileHandle),
+		                m_DirectIoBuffer->BufferOffset + m_DirectIoBuffer->BufferSize);
+	}
+#endif
+
+	return FileStreamCommonPart::GetTotalSize();
 }
 
 std::size_t FileOutputStream::WriteBytes(std::span<const std::byte> const& buffer)
@@ -217,25 +991,365 @@ std::size_t FileOutputStream::WriteBytes(std::span<const std::byte> const& buffe
 
 	return buffer.size() - size;
 #else
+	if (m_DirectIoBuffer)
+	{
+		return DirectWriteBytes(buffer);
+	}
+
 	const auto writtenSize = write(m_FileHandle, data, size);
 	if (writtenSize == ssize_t(-1))
 	{
 		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
 	}
 
+	if (m_DropCacheWindowSize)
+	{
+		OnBytesWritten(static_cast<std::size_t>(writtenSize));
+	}
+
 	return static_cast<std::size_t>(writtenSize);
 #endif
 }
 
+std::size_t
+FileOutputStream::WriteBytesVectored(std::span<const std::span<const std::byte>> const& buffers)
+{
+#if defined(_WIN32)
+	// WriteFileGather 要求缓存按页对齐，无法用于一般情况
+	return OutputStream::WriteBytesVectored(buffers);
+#else
+	if (m_DirectIoBuffer)
+	{
+		return OutputStream::WriteBytesVectored(buffers);
+	}
+
+	std::size_t totalWrittenSize = 0;
+	auto remainedBuffers = buffers;
+
+	while (!remainedBuffers.empty())
+	{
+		iovec ioVecs[MaxIoVecCount];
+		const auto ioVecCount = std::min(MaxIoVecCount, remainedBuffers.size());
+		for (std::size_t i = 0; i < ioVecCount; ++i)
+		{
+			ioVecs[i].iov_base = const_cast<std::byte*>(remainedBuffers[i].data());
+			ioVecs[i].iov_len = remainedBuffers[i].size();
+		}
+
+		auto currentIoVec = ioVecs;
+		auto currentIoVecCount = ioVecCount;
+		while (currentIoVecCount)
+		{
+			const auto writtenSize =
+			    writev(m_FileHandle, currentIoVec, static_cast<int>(currentIoVecCount));
+			if (writtenSize == ssize_t(-1))
+			{
+				CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
+			}
+
+			totalWrittenSize += static_cast<std::size_t>(writtenSize);
+
+			// 跳过已完整写出的缓存，并调整部分写出的缓存
+			auto remainedWrittenSize = static_cast<std::size_t>(writtenSize);
+			while (currentIoVecCount && remainedWrittenSize >= currentIoVec->iov_len)
+			{
+				remainedWrittenSize -= currentIoVec->iov_len;
+				++currentIoVec;
+				--currentIoVecCount;
+			}
+
+			if (currentIoVecCount)
+			{
+				currentIoVec->iov_base =
+				    static_cast<std::byte*>(currentIoVec->iov_base) + remainedWrittenSize;
+				currentIoVec->iov_len -= remainedWrittenSize;
+			}
+		}
+
+		remainedBuffers = remainedBuffers.subspan(ioVecCount);
+	}
+
+	if (m_DropCacheWindowSize)
+	{
+		OnBytesWritten(totalWrittenSize);
+	}
+
+	return totalWrittenSize;
+#endif
+}
+
 void FileOutputStream::Flush()
+{
+	Sync(m_FlushDurability);
+}
+
+void FileOutputStream::Sync(DurabilityLevel level)
 {
 #if defined(_WIN32)
-	FlushFileBuffers(m_FileHandle);
+	if (level < DurabilityLevel::Data)
+	{
+		return;
+	}
+
+	if (!FlushFileBuffers(m_FileHandle))
+	{
+		// 控制台等不支持同步
+		const auto error = GetLastError();
+		if (error != ERROR_INVALID_HANDLE && error != ERROR_INVALID_FUNCTION)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot sync file."));
+		}
+	}
+#else
+	if (m_DirectIoBuffer)
+	{
+		WriteDirectIoBuffer();
+	}
+
+	int result;
+	switch (level)
+	{
+	default:
+		assert(!"Invalid level.");
+		[[fallthrough]];
+	case DurabilityLevel::None:
+		return;
+	case DurabilityLevel::WriteBack:
+#if defined(__linux__)
+		result = sync_file_range(m_FileHandle, 0, 0, SYNC_FILE_RANGE_WRITE);
+		break;
+#else
+		return;
+#endif
+	case DurabilityLevel::Data:
+#if defined(__APPLE__)
+		result = fsync(m_FileHandle);
 #else
-	fsync(m_FileHandle);
+		result = fdatasync(m_FileHandle);
+#endif
+		break;
+	case DurabilityLevel::Full:
+		result = fsync(m_FileHandle);
+		break;
+	}
+
+	// 管道等不支持同步
+	if (result == -1 && errno != EINVAL && errno != ESPIPE)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot sync file."));
+	}
 #endif
 }
 
+void FileOutputStream::SetFlushDurability(DurabilityLevel level) noexcept
+{
+	m_FlushDurability = level;
+}
+
+DurabilityLevel FileOutputStream::GetFlushDurability() const noexcept
+{
+	return m_FlushDurability;
+}
+
+bool FileOutputStream::SetDropCacheAfterWrite([[maybe_unused]] bool enable,
+                                              [[maybe_unused]] std::size_t windowSize) noexcept
+{
+#if defined(__linux__)
+	ResetDropCache();
+	m_DropCacheWindowSize = enable ? std::max(windowSize, std::size_t(1)) : 0;
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::size_t FileOutputStream::WriteAt(std::size_t offset, std::span<const std::byte> const& buffer)
+{
+	if (m_DirectIoBuffer)
+	{
+		return FileStreamCommonPart::WriteAt(offset, buffer);
+	}
+
+	auto data = buffer.data();
+	auto size = static_cast<std::size_t>(buffer.size());
+
+	while (size)
+	{
+#if defined(_WIN32)
+		OVERLAPPED overlapped{};
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = static_cast<DWORD>(static_cast<std::uint64_t>(offset) >> 32);
+
+		DWORD writtenSize;
+		if (!WriteFile(m_FileHandle, data,
+		               static_cast<DWORD>(std::min(
+		                   size, static_cast<std::size_t>(std::numeric_limits<DWORD>::max()))),
+		               &writtenSize, &overlapped))
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
+		}
+#else
+		const auto writtenSize = pwrite(m_FileHandle, data, size, static_cast<off_t>(offset));
+		if (writtenSize == ssize_t(-1))
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot write file."));
+		}
+#endif
+
+		assert(size >= static_cast<std::size_t>(writtenSize));
+		data += writtenSize;
+		size -= static_cast<std::size_t>(writtenSize);
+		offset += static_cast<std::size_t>(writtenSize);
+	}
+
+	return buffer.size() - size;
+}
+
+void FileOutputStream::OnBytesWritten([[maybe_unused]] std::size_t size) noexcept
+{
+#if defined(__linux__)
+	if (m_DropCacheOffset == std::size_t(-1))
+	{
+		// 以追加模式打开时写入前无法得知写入的位置，因此在首次写入后确定
+		const auto pos = lseek(m_FileHandle, 0, SEEK_CUR);
+		if (pos == off_t(-1))
+		{
+			return;
+		}
+		m_DropCacheOffset = static_cast<std::size_t>(pos) - size;
+	}
+
+	m_DropCachePendingSize += size;
+	if (m_DropCachePendingSize < m_DropCacheWindowSize)
+	{
+		return;
+	}
+
+	// 上一部分已在之前开始写回，等待其完成后丢弃页面，此时通常已无需等待
+	if (m_DropCacheStartedSize)
+	{
+		sync_file_range(m_FileHandle, static_cast<off_t>(m_DropCacheOffset),
+		                static_cast<off_t>(m_DropCacheStartedSize),
+		                SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+		                    SYNC_FILE_RANGE_WAIT_AFTER);
+		posix_fadvise(m_FileHandle, static_cast<off_t>(m_DropCacheOffset),
+		              static_cast<off_t>(m_DropCacheStartedSize), POSIX_FADV_DONTNEED);
+		m_DropCacheOffset += m_DropCacheStartedSize;
+	}
+
+	// 开始写回新写入的部分但不等待
+	sync_file_range(m_FileHandle, static_cast<off_t>(m_DropCacheOffset),
+	                static_cast<off_t>(m_DropCachePendingSize), SYNC_FILE_RANGE_WRITE);
+	m_DropCacheStartedSize = std::exchange(m_DropCachePendingSize, 0);
+#endif
+}
+
+void FileOutputStream::ResetDropCache() noexcept
+{
+#if defined(__linux__)
+	if (m_DropCacheOffset != std::size_t(-1))
+	{
+		// 丢弃已开始写回的部分，尚未开始写回的部分仅丢弃其中已写回的页面，不等待
+		if (m_DropCacheStartedSize)
+		{
+			sync_file_range(m_FileHandle, static_cast<off_t>(m_DropCacheOffset),
+			                static_cast<off_t>(m_DropCacheStartedSize),
+			                SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+			                    SYNC_FILE_RANGE_WAIT_AFTER);
+		}
+		posix_fadvise(m_FileHandle, static_cast<off_t>(m_DropCacheOffset),
+		              static_cast<off_t>(m_DropCacheStartedSize + m_DropCachePendingSize),
+		              POSIX_FADV_DONTNEED);
+	}
+#endif
+
+	m_DropCacheOffset = std::size_t(-1);
+	m_DropCacheStartedSize = 0;
+	m_DropCachePendingSize = 0;
+}
+
+#if !defined(_WIN32)
+std::size_t FileOutputStream::DirectWriteBytes(std::span<const std::byte> const& buffer)
+{
+	auto& directIoBuffer = *m_DirectIoBuffer;
+	const auto alignmentMask = directIoBuffer.Alignment - 1;
+	auto data = buffer.data();
+	auto size = static_cast<std::size_t>(buffer.size());
+
+	while (size)
+	{
+		if (directIoBuffer.Cursor == directIoBuffer.Capacity)
+		{
+			WriteDirectIoBuffer();
+			ResetDirectIoBuffer(directIoBuffer.BufferOffset + directIoBuffer.Capacity);
+		}
+
+		// 位置及用户数据均对齐且缓存为空时直接写出用户数据，省去一次复制
+		if (!directIoBuffer.Cursor && !directIoBuffer.BufferSize && size > alignmentMask &&
+		    IsAligned(data, directIoBuffer.Alignment))
+		{
+			const auto writeSize = size & ~alignmentMask;
+			PositionalWriteAll(m_FileHandle, data, writeSize, directIoBuffer.BufferOffset);
+			directIoBuffer.BufferOffset += writeSize;
+			data += writeSize;
+			size -= writeSize;
+			continue;
+		}
+
+		// 当前位置超出文件结尾时，中间的部分以 0 填充
+		if (directIoBuffer.Cursor > directIoBuffer.BufferSize)
+		{
+			std::memset(directIoBuffer.Storage.get() + directIoBuffer.BufferSize, 0,
+			            directIoBuffer.Cursor - directIoBuffer.BufferSize);
+		}
+
+		const auto copySize = std::min(size, directIoBuffer.Capacity - directIoBuffer.Cursor);
+		std::memcpy(directIoBuffer.Storage.get() + directIoBuffer.Cursor, data, copySize);
+		directIoBuffer.Cursor += copySize;
+		directIoBuffer.BufferSize = std::max(directIoBuffer.BufferSize, directIoBuffer.Cursor);
+		data += copySize;
+		size -= copySize;
+	}
+
+	return buffer.size();
+}
+
+void FileOutputStream::WriteDirectIoBuffer()
+{
+	auto& directIoBuffer = *m_DirectIoBuffer;
+	const auto alignedSize = directIoBuffer.BufferSize & ~(directIoBuffer.Alignment - 1);
+	if (alignedSize)
+	{
+		PositionalWriteAll(m_FileHandle, directIoBuffer.Storage.get(), alignedSize,
+		                   directIoBuffer.BufferOffset);
+	}
+
+	// 不足一个块的结尾部分若补齐后写出会覆盖文件中已有的数据或改变文件长度，因此经由页缓存写出
+	if (alignedSize != directIoBuffer.BufferSize)
+	{
+		UnalignedWriteAll(m_FileHandle, directIoBuffer.Storage.get() + alignedSize,
+		                  directIoBuffer.BufferSize - alignedSize,
+		                  directIoBuffer.BufferOffset + alignedSize);
+	}
+}
+
+void FileOutputStream::ResetDirectIoBuffer(std::size_t pos)
+{
+	auto& directIoBuffer = *m_DirectIoBuffer;
+	directIoBuffer.BufferOffset = pos & ~(directIoBuffer.Alignment - 1);
+	directIoBuffer.BufferSize = 0;
+	directIoBuffer.Cursor = pos - directIoBuffer.BufferOffset;
+
+	// 之后写出整块时会覆盖 pos 之前的部分，因此需先读入该块已有的数据
+	if (directIoBuffer.Cursor)
+	{
+		directIoBuffer.BufferSize =
+		    DirectRead(m_FileHandle, directIoBuffer.Storage.get(), directIoBuffer.Alignment,
+		               directIoBuffer.BufferOffset, directIoBuffer.Alignment);
+	}
+}
+#endif
+
 FileOutputStream FileOutputStream::CreateStdOutStream()
 {
 #ifdef _WIN32
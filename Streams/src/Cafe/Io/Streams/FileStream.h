@@ -7,8 +7,12 @@
 #include "StreamBase.h"
 #include "MemoryStream.h"
 #include <Cafe/Encoding/Strings.h>
+#include <algorithm>
 #include <filesystem>
 #include <cassert>
+#include <limits>
+#include <memory>
+#include <new>
 
 #if defined(_WIN32)
 #include <Cafe/Encoding/CodePage/UTF-16.h>
@@ -18,6 +22,8 @@
 #elif defined(__linux__) || defined(__APPLE__)
 #include <Cafe/Encoding/CodePage/UTF-8.h>
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
 #include <sys/mman.h>
@@ -69,8 +75,67 @@ namespace Cafe::Io
 
 	CAFE_DEFINE_GENERAL_EXCEPTION(FileIoException, IoException);
 
+	/// @brief  文件的缓存策略
+	enum class FileCachePolicy
+	{
+		/// @brief  读写经过系统的页缓存
+		Default,
+
+		/// @brief  读写绕过系统的页缓存，适用于只写一次或只读一次的大量数据，避免挤占其他数据的缓存
+		/// @remark Linux 等平台上以 O_DIRECT 打开，macOS 上以 F_NOCACHE 实现，Windows 上暂不支持
+		///         O_DIRECT 要求读写的偏移、长度及内存地址均对齐，流内部维护对齐的缓存以满足此要求，
+		///         因此写入的数据在 Flush 或 Close 之前可能仍在流内部的缓存中
+		///         仅支持可寻位的文件，ReadAt 及 WriteAt 经由内部缓存完成，不再具有 PositionalIo 能力
+		///         直接操作 GetNativeHandle 返回的句柄时需自行满足对齐要求
+		Direct
+	};
+
+	/// @brief  对文件或映射内存的访问模式提示，供系统调整预读及缓存策略
+	/// @remark 提示不影响读写的正确性
+	enum class AccessHint
+	{
+		/// @brief  无特殊的访问模式，恢复系统默认的策略
+		Normal,
+		/// @brief  将顺序访问，系统可增大预读窗口
+		Sequential,
+		/// @brief  将随机访问，系统可停止预读
+		Random,
+		/// @brief  不久后将访问，系统可提前读入
+		WillNeed,
+		/// @brief  不久后不会访问，系统可丢弃已缓存的页面
+		DontNeed,
+		/// @brief  仅访问一次，系统可优先淘汰已缓存的页面
+		NoReuse
+	};
+
 	namespace Detail
 	{
+		/// @brief  FileCachePolicy::Direct 模式下使用的对齐缓存
+		struct DirectIoBuffer
+		{
+			struct AlignedDeleter
+			{
+				std::size_t Alignment;
+
+				void operator()(std::byte* ptr) const noexcept
+				{
+					::operator delete[](ptr, std::align_val_t{ Alignment });
+				}
+			};
+
+			std::unique_ptr<std::byte[], AlignedDeleter> Storage;
+			// 偏移、长度及内存地址的对齐要求，总是 2 的幂
+			std::size_t Alignment;
+			// 缓存的大小，总是 Alignment 的倍数
+			std::size_t Capacity;
+			// Storage 开头对应的文件偏移，总是 Alignment 的倍数
+			std::size_t BufferOffset;
+			// 缓存中有效数据的长度
+			std::size_t BufferSize;
+			// 用户当前位置相对 BufferOffset 的偏移，可能超出 BufferSize
+			std::size_t Cursor;
+		};
+
 		template <typename BaseStream>
 		struct FileStreamCommonPart : SeekableStream<BaseStream>
 		{
@@ -96,7 +161,8 @@ namespace Cafe::Io
 			    ;
 
 			explicit FileStreamCommonPart(NativeHandle nativeHandle = InvalidHandleValue) noexcept
-			    : m_FileHandle{ nativeHandle }, m_ShouldNotDestroy{ false }
+			    : m_FileHandle{ nativeHandle }, m_ShouldNotDestroy{ false },
+			      m_Capabilities{ StreamCapability::None }
 #if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
 #if defined(_WIN32)
 			      ,
@@ -107,13 +173,20 @@ namespace Cafe::Io
 #endif
 #endif
 			{
+				if (m_FileHandle != InvalidHandleValue)
+				{
+					InitializeCapabilities();
+				}
 			}
 
 			FileStreamCommonPart(FileStreamCommonPart const&) = delete;
 
 			FileStreamCommonPart(FileStreamCommonPart&& other) noexcept
 			    : m_FileHandle{ std::exchange(other.m_FileHandle, InvalidHandleValue) },
-			      m_ShouldNotDestroy{ other.m_ShouldNotDestroy }
+			      m_ShouldNotDestroy{ other.m_ShouldNotDestroy }, m_Capabilities{
+				      std::exchange(other.m_Capabilities, StreamCapability::None)
+			      },
+			      m_RestoreBlocking{ std::exchange(other.m_RestoreBlocking, false) }
 #if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
 #if defined(_WIN32)
 			      ,
@@ -145,6 +218,8 @@ namespace Cafe::Io
 					Close();
 					m_FileHandle = std::exchange(other.m_FileHandle, InvalidHandleValue);
 					m_ShouldNotDestroy = other.m_ShouldNotDestroy;
+					m_Capabilities = std::exchange(other.m_Capabilities, StreamCapability::None);
+					m_RestoreBlocking = std::exchange(other.m_RestoreBlocking, false);
 #if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
 #if defined(_WIN32)
 					m_FileMapping = std::exchange(other.m_FileMapping, nullptr);
@@ -163,6 +238,12 @@ namespace Cafe::Io
 			{
 #if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
 				Unmap();
+#endif
+#if !defined(_WIN32)
+				if (m_RestoreBlocking)
+				{
+					SetNonBlocking(false);
+				}
 #endif
 				if (!m_ShouldNotDestroy && m_FileHandle != InvalidHandleValue)
 				{
@@ -175,11 +256,119 @@ namespace Cafe::Io
 				}
 			}
 
+			/// @remark 能力在获得文件句柄时根据句柄的实际类型确定
+			///         仅普通文件及块设备是可寻位的，管道、套接字及终端等均不可寻位
+			StreamCapability GetCapabilities() const override
+			{
+				return m_Capabilities;
+			}
+
 			NativeHandle GetNativeHandle() const noexcept
 			{
 				return m_FileHandle;
 			}
 
+#if !defined(_WIN32)
+			/// @brief  设置句柄是否处于非阻塞模式，并相应更新 StreamCapability::NonBlocking
+			/// @remark 非阻塞模式属于打开的文件描述，将影响共享该文件描述的其他句柄（如 dup 或子进程继承的句柄），
+			///         因此由本方法从阻塞模式设为非阻塞模式后，Close 及析构时将恢复为阻塞模式
+			/// @return 是否成功
+			bool SetNonBlocking(bool enable) noexcept
+			{
+				const auto flags = fcntl(m_FileHandle, F_GETFL);
+				if (flags == -1)
+				{
+					return false;
+				}
+
+				if (enable != static_cast<bool>(flags & O_NONBLOCK))
+				{
+					if (fcntl(m_FileHandle, F_SETFL, flags ^ O_NONBLOCK) == -1)
+					{
+						return false;
+					}
+
+					// 显式恢复为阻塞模式后无需再恢复
+					m_RestoreBlocking = enable;
+				}
+
+				if (enable)
+				{
+					m_Capabilities |= StreamCapability::NonBlocking;
+				}
+				else
+				{
+					m_Capabilities = m_Capabilities & ~StreamCapability::NonBlocking;
+				}
+
+				return true;
+			}
+#endif
+
+			/// @brief  提示之后对文件指定范围的访问模式
+			/// @param  offset  范围的起始偏移
+			/// @param  size    范围的长度，为 0 表示直到文件结尾
+			/// @remark 具有 posix_fadvise 的平台上以其实现，对同一文件的其他句柄无影响
+			///         macOS 上仅支持 Normal、Sequential、Random 及 WillNeed，Windows 上不支持
+			/// @return 提示是否被系统接受，失败时通常可以忽略
+			bool Advise([[maybe_unused]] AccessHint hint, [[maybe_unused]] std::size_t offset = 0,
+			            [[maybe_unused]] std::size_t size = 0) noexcept
+			{
+#if defined(POSIX_FADV_NORMAL)
+				int advice;
+				switch (hint)
+				{
+				default:
+					assert(!"Invalid hint.");
+					[[fallthrough]];
+				case AccessHint::Normal:
+					advice = POSIX_FADV_NORMAL;
+					break;
+				case AccessHint::Sequential:
+					advice = POSIX_FADV_SEQUENTIAL;
+					break;
+				case AccessHint::Random:
+					advice = POSIX_FADV_RANDOM;
+					break;
+				case AccessHint::WillNeed:
+					advice = POSIX_FADV_WILLNEED;
+					break;
+				case AccessHint::DontNeed:
+					advice = POSIX_FADV_DONTNEED;
+					break;
+				case AccessHint::NoReuse:
+					advice = POSIX_FADV_NOREUSE;
+					break;
+				}
+
+				return posix_fadvise(m_FileHandle, static_cast<off_t>(offset),
+				                     static_cast<off_t>(size), advice) == 0;
+#elif defined(__APPLE__)
+				switch (hint)
+				{
+				case AccessHint::Normal:
+				case AccessHint::Sequential:
+					return fcntl(m_FileHandle, F_RDAHEAD, 1) != -1;
+				case AccessHint::Random:
+					return fcntl(m_FileHandle, F_RDAHEAD, 0) != -1;
+				case AccessHint::WillNeed:
+				{
+					radvisory advisory{};
+					advisory.ra_offset = static_cast<off_t>(offset);
+					advisory.ra_count = static_cast<int>(
+					    std::min(size ? size : static_cast<std::size_t>(
+					                               std::numeric_limits<int>::max()),
+					             static_cast<std::size_t>(std::numeric_limits<int>::max())));
+					return fcntl(m_FileHandle, F_RDADVISE, &advisory) != -1;
+				}
+				default:
+					return false;
+				}
+#else
+				return false;
+#endif
+			}
+
 			std::size_t GetPosition() const override
 			{
 #if defined(_WIN32)
@@ -312,6 +501,65 @@ namespace Cafe::Io
 #endif
 			}
 
+			/// @brief  提示之后对 MapToMemory 映射的内存指定范围的访问模式
+			/// @param  offset  范围相对映射开头的偏移
+			/// @param  size    范围的长度，为 0 表示直到映射结尾
+			/// @remark 非 Windows 平台上以 madvise 实现，NoReuse 在支持时对应 MADV_COLD
+			///         映射是共享的，因此 DontNeed 不会丢失已写入的数据
+			///         Windows 上不支持
+			/// @return 提示是否被系统接受，未映射时返回 false
+			bool AdviseMapping([[maybe_unused]] AccessHint hint,
+			                   [[maybe_unused]] std::size_t offset = 0,
+			                   [[maybe_unused]] std::size_t size = 0) noexcept
+			{
+#if defined(_WIN32)
+				return false;
+#else
+				if (!m_FileView || offset >= m_FileViewSize)
+				{
+					return false;
+				}
+
+				size = size ? std::min(size, m_FileViewSize - offset) : m_FileViewSize - offset;
+
+				int advice;
+				switch (hint)
+				{
+				default:
+					assert(!"Invalid hint.");
+					[[fallthrough]];
+				case AccessHint::Normal:
+					advice = MADV_NORMAL;
+					break;
+				case AccessHint::Sequential:
+					advice = MADV_SEQUENTIAL;
+					break;
+				case AccessHint::Random:
+					advice = MADV_RANDOM;
+					break;
+				case AccessHint::WillNeed:
+					advice = MADV_WILLNEED;
+					break;
+				case AccessHint::DontNeed:
+					advice = MADV_DONTNEED;
+					break;
+				case AccessHint::NoReuse:
+#if defined(MADV_COLD)
+					advice = MADV_COLD;
+					break;
+#else
+					return false;
+#endif
+				}
+
+				// 映射的开头按页对齐，madvise 要求起始地址同样对齐
+				const auto pageMask = static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) - 1;
+				const auto alignedOffset = offset & ~pageMask;
+				return madvise(static_cast<std::byte*>(m_FileView) + alignedOffset,
+				               size + (offset - alignedOffset), advice) == 0;
+#endif
+			}
+
 			void Unmap() noexcept
 			{
 #if defined(_WIN32)
@@ -335,11 +583,41 @@ namespace Cafe::Io
 				}
 #endif
 			}
+#endif
 
 		protected:
 			NativeHandle m_FileHandle;
 			bool m_ShouldNotDestroy;
+			StreamCapability m_Capabilities;
+			// 句柄由 SetNonBlocking 设为非阻塞模式，关闭时需恢复为阻塞模式
+			bool m_RestoreBlocking = false;
+
+			void InitializeCapabilities() noexcept
+			{
+				m_Capabilities = StreamCapability::None;
+#if defined(_WIN32)
+				if (GetFileType(m_FileHandle) == FILE_TYPE_DISK)
+				{
+					m_Capabilities = StreamCapability::Seekable | StreamCapability::KnownSize |
+					                 StreamCapability::PositionalIo;
+				}
+#else
+				if (struct stat fileStat; fstat(m_FileHandle, &fileStat) == 0 &&
+				                          (S_ISREG(fileStat.st_mode) || S_ISBLK(fileStat.st_mode)))
+				{
+					m_Capabilities = StreamCapability::Seekable | StreamCapability::KnownSize |
+					                 StreamCapability::PositionalIo;
+				}
+
+				if (const auto flags = fcntl(m_FileHandle, F_GETFL);
+				    flags != -1 && (flags & O_NONBLOCK))
+				{
+					m_Capabilities |= StreamCapability::NonBlocking;
+				}
+#endif
+			}
 
+#if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
 		private:
 #if defined(_WIN32)
 			HANDLE m_FileMapping;
@@ -359,15 +637,19 @@ namespace Cafe::Io
 
 	constexpr Detail::SpecifyNativeHandleTag SpecifyNativeHandle{};
 
-	class CAFE_PUBLIC FileInputStream : public Detail::FileStreamCommonPart<InputStream>
+	class CAFE_PUBLIC FileInputStream final : public Detail::FileStreamCommonPart<InputStream>
 	{
 	public:
-		explicit FileInputStream(std::filesystem::path const& path);
-		explicit FileInputStream(Encoding::StringView<PathNativeCodePage> const& path);
+		/// @throw  FileIoException 无法打开文件，或以 FileCachePolicy::Direct 打开不可寻位的文件
+		explicit FileInputStream(std::filesystem::path const& path,
+		                         FileCachePolicy cachePolicy = FileCachePolicy::Default);
+		explicit FileInputStream(Encoding::StringView<PathNativeCodePage> const& path,
+		                         FileCachePolicy cachePolicy = FileCachePolicy::Default);
 
 		/// @brief  直接以已获得的文件句柄构造
 		/// @param  fileHandle      文件句柄
 		/// @param  transferOwner   转移所有权，若为 true 则 Close() 会关闭此句柄
+		/// @remark 文件可寻位时以句柄当前的位置作为初始位置，之后不应在外部改变句柄的位置
 		explicit FileInputStream(Detail::SpecifyNativeHandleTag, NativeHandle fileHandle,
 		                         bool transferOwner = true);
 
@@ -379,15 +661,63 @@ namespace Cafe::Io
 		FileInputStream& operator=(FileInputStream const&) = delete;
 		FileInputStream& operator=(FileInputStream&&) = default;
 
+		void Close() override;
+
+		FileCachePolicy GetCachePolicy() const noexcept;
+
+		/// @remark 文件可寻位时位置在用户空间中跟踪，不需要系统调用
+		std::size_t GetPosition() const override;
+		/// @remark 目标位置即为当前位置时不需要系统调用
+		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
+		/// @remark 文件可寻位时长度在首次获取后被缓存，之后不需要系统调用
+		///         读取到缓存的长度以后时将随之更新，但文件在外部被扩大或截断时缓存的长度可能过时，
+		///         此时 GetAvailableBytes 及 Skip 等均基于过时的长度，需调用 RefreshSize 更新
+		std::size_t GetTotalSize() override;
+
+		/// @brief  重新获取并缓存文件长度，用于读取仍在增长的文件
+		/// @return 新的文件长度
+		/// @throw  FileIoException 无法获取文件长度，如文件不可寻位
+		std::size_t RefreshSize();
+
+		/// @remark 文件可寻位时不需要系统调用
 		std::size_t GetAvailableBytes() override;
 		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
+		/// @remark 非 Windows 平台上使用 readv 实现
+		std::size_t
+		ReadBytesVectored(std::span<const std::span<std::byte>> const& buffers) override;
 
 		std::size_t Skip(std::size_t n) override;
 
+		/// @remark 非 Windows 平台上使用 pread 实现，可由多个线程同时调用
+		///         Windows 平台上使用带 OVERLAPPED 的 ReadFile 实现，同步句柄的文件指针会被改变
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
+
+		/// @remark Linux 平台上若 stream 为 FileOutputStream，将在内核中完成复制
+		///         任意一方为管道时使用 splice，否则依次尝试 copy_file_range 及 sendfile
+		///         均不可用时或其他情况下使用 InputStream::CopyTo 的实现
+		std::size_t CopyTo(OutputStream& stream, std::size_t size = std::size_t(-1)) override;
+
 		static FileInputStream CreateStdInStream();
+
+	private:
+		// 以 io_uring 在文件句柄的当前位置读取后需更新在用户空间中跟踪的位置
+		friend class AsyncFileInputStream;
+
+		// 仅在 FileCachePolicy::Direct 模式下非空
+		std::unique_ptr<Detail::DirectIoBuffer> m_DirectIoBuffer;
+		// 在用户空间中跟踪的位置，与文件句柄的位置一致，仅在 IsPositionTracked() 时有意义
+		std::size_t m_Position = 0;
+		// 缓存的文件长度，尚未获取时为 std::size_t(-1)
+		std::size_t m_CachedSize = std::size_t(-1);
+
+		/// @brief  文件可寻位且不处于 FileCachePolicy::Direct 模式时，位置在用户空间中跟踪
+		bool IsPositionTracked() const noexcept;
+		void OnBytesRead(std::size_t size) noexcept;
+
+		std::size_t DirectReadBytes(std::span<std::byte> const& buffer);
 	};
 
-	class CAFE_PUBLIC FileOutputStream : public Detail::FileStreamCommonPart<OutputStream>
+	class CAFE_PUBLIC FileOutputStream final : public Detail::FileStreamCommonPart<OutputStream>
 	{
 	public:
 		enum class FileOpenMode
@@ -397,10 +727,15 @@ namespace Cafe::Io
 			Append
 		};
 
+		/// @remark 以 FileCachePolicy::Direct 打开时，FileOpenMode::Append 以打开时寻位到结尾模拟，
+		///         因为追加模式下无法按对齐的偏移改写已写出的块
+		/// @throw  FileIoException 无法打开文件，或以 FileCachePolicy::Direct 打开不可寻位的文件
 		explicit FileOutputStream(std::filesystem::path const& path,
-		                          FileOpenMode openMode = FileOpenMode::Truncate);
+		                          FileOpenMode openMode = FileOpenMode::Truncate,
+		                          FileCachePolicy cachePolicy = FileCachePolicy::Default);
 		explicit FileOutputStream(Encoding::StringView<PathNativeCodePage> const& path,
-		                          FileOpenMode openMode = FileOpenMode::Truncate);
+		                          FileOpenMode openMode = FileOpenMode::Truncate,
+		                          FileCachePolicy cachePolicy = FileCachePolicy::Default);
 
 		/// @brief  直接以已获得的文件句柄构造
 		/// @param  fileHandle      文件句柄
@@ -416,11 +751,83 @@ namespace Cafe::Io
 		FileOutputStream& operator=(FileOutputStream const&) = delete;
 		FileOutputStream& operator=(FileOutputStream&&) = default;
 
+		/// @remark FileCachePolicy::Direct 模式下将先写出内部缓存中的数据，
+		///         不足一个对齐块的结尾部分经由页缓存写出，因此文件长度与写入的数据一致
+		void Close() override;
+
+		FileCachePolicy GetCachePolicy() const noexcept;
+
+		std::size_t GetPosition() const override;
+		/// @remark FileCachePolicy::Direct 模式下目标位置不在内部缓存中时将先写出缓存
+		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
+		std::size_t GetTotalSize() override;
+
 		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override;
+		/// @remark 非 Windows 平台上使用 writev 实现
+		std::size_t
+		WriteBytesVectored(std::span<const std::span<const std::byte>> const& buffers) override;
+
+		/// @brief  以 GetFlushDurability() 指定的程度调用 Sync
 		void Flush() override;
 
+		/// @remark FileCachePolicy::Direct 模式下将先写出内部缓存中的数据
+		///         DurabilityLevel::WriteBack 仅 Linux 上支持，以 sync_file_range 实现，其他平台上无操作
+		///         DurabilityLevel::Data 以 fdatasync 实现，不支持的平台上以 fsync 代替
+		///         DurabilityLevel::Full 以 fsync 实现，Windows 上 Data 及 Full 均以 FlushFileBuffers 实现
+		///         文件不支持同步（如管道）时忽略同步操作
+		/// @throw  FileIoException 同步失败
+		void Sync(DurabilityLevel level = DurabilityLevel::Full) override;
+
+		/// @brief  设置 Flush 的持久化程度，默认为 DurabilityLevel::Full
+		/// @remark 仅需将数据交给系统时可设置为 DurabilityLevel::None，之后以 Sync 显式持久化
+		void SetFlushDurability(DurabilityLevel level) noexcept;
+		DurabilityLevel GetFlushDurability() const noexcept;
+
+		static constexpr std::size_t DefaultDropCacheWindowSize = 8 * 1024 * 1024;
+
+		/// @brief  设置是否在写回后丢弃写入的页面，适用于写入大量之后不再读取的数据的场景
+		/// @param  windowSize  每写入 windowSize 字节即开始写回这部分数据，并等待上一部分写回完成后丢弃其页面，
+		///                     因此页缓存中至多保留约 2 倍于此的本流写入的数据
+		/// @remark 仅对以 WriteBytes 及 WriteBytesVectored 连续写入的数据有效，寻位后将重新开始计算
+		///         仅 Linux 上支持，以 sync_file_range 及 posix_fadvise 实现
+		///         FileCachePolicy::Direct 模式下写入不经过页缓存，无需设置
+		/// @return 当前平台是否支持
+		bool SetDropCacheAfterWrite(bool enable,
+		                            std::size_t windowSize = DefaultDropCacheWindowSize) noexcept;
+
+		/// @remark 非 Windows 平台上使用 pwrite 实现，可由多个线程同时调用
+		///         Windows 平台上使用带 OVERLAPPED 的 WriteFile 实现，同步句柄的文件指针会被改变
+		///         以 FileOpenMode::Append 打开时，部分平台（如 Linux）会忽略 offset 而追加到结尾
+		std::size_t WriteAt(std::size_t offset, std::span<const std::byte> const& buffer) override;
+
 		static FileOutputStream CreateStdOutStream();
 		static FileOutputStream CreateStdErrStream();
+
+	private:
+		// 仅在 FileCachePolicy::Direct 模式下非空
+		std::unique_ptr<Detail::DirectIoBuffer> m_DirectIoBuffer;
+
+		DurabilityLevel m_FlushDurability = DurabilityLevel::Full;
+
+		// 为 0 表示未启用写回后丢弃页面
+		std::size_t m_DropCacheWindowSize = 0;
+		// 已开始写回但尚未丢弃的范围的起始偏移，为 std::size_t(-1) 表示尚未确定
+		std::size_t m_DropCacheOffset = std::size_t(-1);
+		// 已开始写回但尚未丢弃的长度
+		std::size_t m_DropCacheStartedSize = 0;
+		// 已写入但尚未开始写回的长度
+		std::size_t m_DropCachePendingSize = 0;
+
+		void OnBytesWritten(std::size_t size) noexcept;
+		void ResetDropCache() noexcept;
+
+		std::size_t DirectWriteBytes(std::span<const std::byte> const& buffer);
+
+		/// @brief  写出内部缓存中的全部数据，缓存的内容保持不变
+		void WriteDirectIoBuffer();
+
+		/// @brief  使内部缓存对应 pos 所在的块，pos 不对齐时将先读入该块已有的数据
+		void ResetDirectIoBuffer(std::size_t pos);
 	};
 } // namespace Cafe::Io
 
@@ -0,0 +1,205 @@
+#include <Cafe/ErrorHandling/ErrorHandling.h>
+#include <Cafe/Io/Streams/GroupCommitAppender.h>
+#include <algorithm>
+
+using namespace Cafe;
+using namespace Io;
+
+void GroupCommitAppender::Group::Clear() noexcept
+{
+	// 保留存储以供下一组复用
+	Records.clear();
+	Segments.clear();
+	Size = 0;
+	Promises.clear();
+}
+
+GroupCommitAppender::GroupCommitAppender(OutputStream* stream, DurabilityLevel durability,
+                                         std::size_t maxPendingSize)
+    : m_UnderlyingStream{ stream }, m_Durability{ durability }, m_MaxPendingSize{ maxPendingSize },
+      m_CommittedGroupCount{}, m_Stopping{ false }
+{
+	assert(stream);
+	m_Worker = std::thread{ &GroupCommitAppender::WorkerMain, this };
+}
+
+GroupCommitAppender::~GroupCommitAppender()
+{
+	Close();
+}
+
+void GroupCommitAppender::Close()
+{
+	if (!m_Worker.joinable())
+	{
+		return;
+	}
+
+	// 后台线程在写入全部已提交的记录后才会退出
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_WorkerCondition.notify_all();
+	m_ProducerCondition.notify_all();
+	m_Worker.join();
+}
+
+std::future<void> GroupCommitAppender::Append(std::span<const std::byte> const& record)
+{
+	return AppendVectored(std::span(&record, 1));
+}
+
+std::future<void>
+GroupCommitAppender::AppendVectored(std::span<const std::span<const std::byte>> const& parts)
+{
+	// 在持有锁前复制记录，避免阻塞其他提交线程与后台线程
+	std::size_t recordSize = 0;
+	for (const auto& part : parts)
+	{
+		recordSize += part.size();
+	}
+
+	std::vector<std::byte> record;
+	record.reserve(recordSize);
+	for (const auto& part : parts)
+	{
+		record.insert(record.end(), part.begin(), part.end());
+	}
+
+	std::unique_lock lock{ m_Mutex };
+	m_ProducerCondition.wait(lock, [this] {
+		return m_Stopping || m_Exception || m_PendingGroup.Size < m_MaxPendingSize;
+	});
+
+	if (m_Stopping)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Appender has been closed."));
+	}
+
+	std::promise<void> promise;
+	auto future = promise.get_future();
+	if (m_Exception)
+	{
+		promise.set_exception(m_Exception);
+		return future;
+	}
+
+	auto& group = m_PendingGroup;
+	if (!record.empty())
+	{
+		group.Segments.emplace_back(record);
+		group.Size += record.size();
+		group.Records.push_back(std::move(record));
+	}
+	group.Promises.push_back(std::move(promise));
+
+	// 仅在组由空变为非空时唤醒，后台线程写入期间提交的记录将在写入完成后一并取走
+	const auto shouldNotify = group.Promises.size() == 1;
+	lock.unlock();
+	if (shouldNotify)
+	{
+		m_WorkerCondition.notify_one();
+	}
+
+	return future;
+}
+
+OutputStream* GroupCommitAppender::GetUnderlyingStream() const noexcept
+{
+	return m_UnderlyingStream;
+}
+
+std::size_t GroupCommitAppender::GetCommittedGroupCount() const
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_CommittedGroupCount;
+}
+
+void GroupCommitAppender::WorkerMain()
+{
+	std::unique_lock lock{ m_Mutex };
+	while (true)
+	{
+		m_WorkerCondition.wait(
+		    lock, [this] { return m_Stopping || !m_PendingGroup.Promises.empty(); });
+
+		if (m_PendingGroup.Promises.empty())
+		{
+			return;
+		}
+
+		std::swap(m_PendingGroup, m_CommittingGroup);
+		auto exception = m_Exception;
+		lock.unlock();
+		m_ProducerCondition.notify_all();
+
+		auto& group = m_CommittingGroup;
+		if (!exception)
+		{
+			try
+			{
+				WriteGroup(group);
+				m_UnderlyingStream->Sync(m_Durability);
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+		}
+
+		// 先更新状态再完成承诺，使等待者返回后观察到的状态包含本组
+		lock.lock();
+		if (exception)
+		{
+			m_Exception = exception;
+		}
+		else
+		{
+			++m_CommittedGroupCount;
+		}
+		lock.unlock();
+
+		for (auto& promise : group.Promises)
+		{
+			if (exception)
+			{
+				promise.set_exception(exception);
+			}
+			else
+			{
+				promise.set_value();
+			}
+		}
+		group.Clear();
+
+		lock.lock();
+	}
+}
+
+void GroupCommitAppender::WriteGroup(Group& group)
+{
+	auto remaining = std::span(group.Segments);
+	std::size_t writtenSize = 0;
+	while (true)
+	{
+		// 跳过已完整写出的部分，并截去部分写出的记录中已写出的前缀
+		while (!remaining.empty() && writtenSize >= remaining.front().size())
+		{
+			writtenSize -= remaining.front().size();
+			remaining = remaining.subspan(1);
+		}
+
+		if (remaining.empty())
+		{
+			return;
+		}
+
+		remaining.front() = remaining.front().subspan(writtenSize);
+		writtenSize = m_UnderlyingStream->WriteBytesVectored(remaining);
+		if (!writtenSize)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot write group."));
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "StreamBase.h"
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Cafe::Io
+{
+	/// @brief  组提交追加器，供多个线程并发向同一个输出流追加记录
+	/// @remark 后台线程将提交时间相近的记录合并为一组，以一次向量写入写出后调用一次 Sync，
+	///         因此持久化的开销由同组的记录分摊，适用于预写日志等每条记录都需持久化的场景
+	///         写入不完整时将继续写入剩余部分，直至整组写出或出错
+	///         记录按提交的顺序写入，同一线程先后提交的记录在流中的顺序与提交顺序一致
+	///         写入或同步失败后包装流的状态未知，此后提交的记录都将以同一异常失败
+	///         本类不会取得包装流的所有权，在本类管理期间不应在外部操作包装流，否则可能导致错误
+	///         后台线程引用本对象，因此本类不可移动
+	class CAFE_PUBLIC GroupCommitAppender
+	{
+	public:
+		static constexpr std::size_t DefaultMaxPendingSize = 4 * 1024 * 1024;
+
+		/// @param  stream          包装流
+		/// @param  durability      每组写入后调用 Sync 的持久化程度
+		/// @param  maxPendingSize  尚未开始写入的记录的总长度上限，超出时提交的线程将等待，
+		///                         单条记录的长度不受此限制
+		explicit GroupCommitAppender(OutputStream* stream,
+		                             DurabilityLevel durability = DurabilityLevel::Data,
+		                             std::size_t maxPendingSize = DefaultMaxPendingSize);
+
+		GroupCommitAppender(GroupCommitAppender const&) = delete;
+		GroupCommitAppender& operator=(GroupCommitAppender const&) = delete;
+
+		~GroupCommitAppender();
+
+		/// @brief  写入并持久化已提交的全部记录后结束后台线程
+		/// @remark 之后不可再提交记录
+		void Close();
+
+		/// @brief  提交一条记录，record 的内容将被复制，因此返回后即可复用
+		/// @remark 可由多个线程同时调用
+		/// @return 在记录所在的组写入并持久化后就绪的 future，失败时持有写入或同步时抛出的异常
+		/// @throw  IoException 已关闭
+		std::future<void> Append(std::span<const std::byte> const& record);
+
+		/// @brief  提交由多个部分组成的一条记录，各部分在流中连续存放
+		/// @see    Append
+		std::future<void> AppendVectored(std::span<const std::span<const std::byte>> const& parts);
+
+		OutputStream* GetUnderlyingStream() const noexcept;
+
+		/// @brief  获得已写入并持久化的组数
+		std::size_t GetCommittedGroupCount() const;
+
+	private:
+		struct Group
+		{
+			// 组内各记录的副本，在提交线程持有锁前复制，移动时存储的地址不变
+			std::vector<std::vector<std::byte>> Records;
+			// 按提交顺序引用 Records 中各记录的存储，后台线程以向量写入一并写出
+			std::vector<std::span<const std::byte>> Segments;
+			// 组内全部记录的总长度
+			std::size_t Size = 0;
+			std::vector<std::promise<void>> Promises;
+
+			void Clear() noexcept;
+		};
+
+		OutputStream* m_UnderlyingStream;
+		DurabilityLevel m_Durability;
+		std::size_t m_MaxPendingSize;
+
+		// 以下成员由 m_Mutex 保护
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_WorkerCondition;
+		std::condition_variable m_ProducerCondition;
+		// 正在收集的组，后台线程开始写入时与 m_CommittingGroup 交换，因此两者的存储可被复用
+		Group m_PendingGroup;
+		std::exception_ptr m_Exception;
+		std::size_t m_CommittedGroupCount;
+		bool m_Stopping;
+
+		// 仅由后台线程访问
+		Group m_CommittingGroup;
+
+		std::thread m_Worker;
+
+		void WorkerMain();
+
+		/// @brief  写出 group 内的全部记录，写入不完整时继续写入剩余部分
+		/// @throw  IoException 无法继续写入
+		void WriteGroup(Group& group);
+	};
+} // namespace Cafe::Io
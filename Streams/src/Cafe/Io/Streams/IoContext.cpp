@@ -0,0 +1,450 @@
+#include <Cafe/Io/Streams/IoContext.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM
+
+#include <cerrno>
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+#include <Cafe/Io/Streams/IoUring.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <poll.h>
+#endif
+
+using namespace Cafe;
+using namespace Io;
+
+namespace
+{
+	Detail::DetachedTask RunDetached(IoContext& context, Task<> task)
+	{
+		co_await context.Schedule();
+		co_await task;
+	}
+
+#if defined(__linux__)
+	// 单次 epoll_wait 最多取出的事件数
+	constexpr int MaxEventCount = 64;
+#endif
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+	// 积累的请求数达到此值时立即提交，而不等待 Run 的线程空闲
+	constexpr std::uint32_t IoUringSubmitBatchSize = 32;
+	// 存在积累的请求时 Run 最多再恢复此数目的协程即提交，避免就绪队列持续非空时请求迟迟得不到提交
+	constexpr std::uint32_t IoUringMaxDeferredResumeCount = 16;
+	// 单次从完成队列取出的最大结果数
+	constexpr std::size_t IoUringReapBatchSize = 64;
+
+	// 当前线程正在执行 Run 的 IoContext，用于判断提交是否可以推迟到 Run 的线程空闲时
+	thread_local IoContext* CurrentRunningContext = nullptr;
+#endif
+} // namespace
+
+IoContext::IoContext(std::size_t blockingThreadCount, bool useIoUring)
+    :
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+      m_IoUringHasPending{ false },
+#endif
+      m_Stopped{ false }, m_ShuttingDown{ false }
+{
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+	if (useIoUring && IoUringEngine::IsSupported())
+	{
+		try
+		{
+			m_IoUring = std::make_unique<IoUringEngine>();
+		}
+		catch (IoException const&)
+		{
+			// 无法创建时回退到阻塞线程池
+		}
+	}
+#else
+	static_cast<void>(useIoUring);
+#endif
+
+#if defined(__linux__)
+	m_EpollHandle = epoll_create1(EPOLL_CLOEXEC);
+	if (m_EpollHandle == -1)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot create epoll instance."));
+	}
+
+	m_WakeUpHandle = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (m_WakeUpHandle == -1)
+	{
+		close(m_EpollHandle);
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot create eventfd."));
+	}
+
+	// 唤醒句柄以空指针标识
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr;
+	if (epoll_ctl(m_EpollHandle, EPOLL_CTL_ADD, m_WakeUpHandle, &event) == -1)
+	{
+		close(m_WakeUpHandle);
+		close(m_EpollHandle);
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot register eventfd."));
+	}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+	// io_uring 实例以引擎的地址标识，完成队列非空时可读
+	if (m_IoUring)
+	{
+		event.data.ptr = m_IoUring.get();
+		if (epoll_ctl(m_EpollHandle, EPOLL_CTL_ADD, m_IoUring->GetNativeHandle(), &event) == -1)
+		{
+			m_IoUring.reset();
+		}
+	}
+#endif
+
+	m_ReactorThread = std::thread{ &IoContext::ReactorMain, this };
+#endif
+
+	m_BlockingThreads.reserve(blockingThreadCount);
+	for (std::size_t i = 0; i < blockingThreadCount; ++i)
+	{
+		m_BlockingThreads.emplace_back(&IoContext::BlockingThreadMain, this);
+	}
+}
+
+IoContext::~IoContext()
+{
+	Stop();
+
+	{
+		const std::lock_guard lock{ m_BlockingMutex };
+		m_ShuttingDown.store(true, std::memory_order_release);
+	}
+	m_BlockingCondition.notify_all();
+
+	for (auto& thread : m_BlockingThreads)
+	{
+		thread.join();
+	}
+
+#if defined(__linux__)
+	const std::uint64_t value = 1;
+	[[maybe_unused]] const auto writeResult = write(m_WakeUpHandle, &value, sizeof(value));
+	m_ReactorThread.join();
+
+	close(m_WakeUpHandle);
+	close(m_EpollHandle);
+#endif
+}
+
+void IoContext::Run()
+{
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+	const auto previousContext = std::exchange(CurrentRunningContext, this);
+	CAFE_SCOPE_EXIT
+	{
+		CurrentRunningContext = previousContext;
+	};
+
+	// 存在积累的请求以来恢复的协程数
+	std::uint32_t deferredResumeCount = 0;
+#endif
+
+	while (true)
+	{
+		std::coroutine_handle<> handle;
+
+		{
+			std::unique_lock lock{ m_QueueMutex };
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+			// 没有就绪的协程或已推迟足够久时提交积累的 io_uring 请求
+			if (!m_IoUringHasPending.load(std::memory_order_relaxed))
+			{
+				deferredResumeCount = 0;
+			}
+			else if (m_ReadyQueue.empty() || deferredResumeCount >= IoUringMaxDeferredResumeCount)
+			{
+				lock.unlock();
+				FlushIoUringSubmissions();
+				lock.lock();
+				deferredResumeCount = 0;
+			}
+#endif
+
+			m_QueueCondition.wait(lock, [this] {
+				return m_Stopped.load(std::memory_order_relaxed) || !m_ReadyQueue.empty();
+			});
+
+			if (m_Stopped.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			handle = m_ReadyQueue.front();
+			m_ReadyQueue.pop_front();
+		}
+
+		handle.resume();
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+		++deferredResumeCount;
+#endif
+	}
+}
+
+void IoContext::Stop()
+{
+	{
+		const std::lock_guard lock{ m_QueueMutex };
+		m_Stopped.store(true, std::memory_order_relaxed);
+	}
+	m_QueueCondition.notify_all();
+}
+
+bool IoContext::IsStopped() const noexcept
+{
+	return m_Stopped.load(std::memory_order_relaxed);
+}
+
+void IoContext::Post(std::coroutine_handle<> handle)
+{
+	{
+		const std::lock_guard lock{ m_QueueMutex };
+		m_ReadyQueue.push_back(handle);
+	}
+	m_QueueCondition.notify_one();
+}
+
+void IoContext::Spawn(Task<> task)
+{
+	RunDetached(*this, std::move(task));
+}
+
+void IoContext::PostBlocking(std::function<void()> job)
+{
+	{
+		const std::lock_guard lock{ m_BlockingMutex };
+		m_BlockingQueue.push_back(std::move(job));
+	}
+	m_BlockingCondition.notify_one();
+}
+
+void IoContext::BlockingThreadMain()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock lock{ m_BlockingMutex };
+			m_BlockingCondition.wait(lock, [this] {
+				return m_ShuttingDown.load(std::memory_order_relaxed) || !m_BlockingQueue.empty();
+			});
+
+			// 关闭时丢弃尚未执行的任务
+			if (m_ShuttingDown.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			job = std::move(m_BlockingQueue.front());
+			m_BlockingQueue.pop_front();
+		}
+
+		job();
+	}
+}
+
+#if defined(__linux__)
+void IoContext::ReactorMain()
+{
+	epoll_event events[MaxEventCount];
+
+	while (!m_ShuttingDown.load(std::memory_order_acquire))
+	{
+		const auto count = epoll_wait(m_EpollHandle, events, MaxEventCount, -1);
+		if (count == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return;
+		}
+
+		for (int i = 0; i < count; ++i)
+		{
+			const auto address = events[i].data.ptr;
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+			if (address && address == m_IoUring.get())
+			{
+				ReapIoUringCompletions();
+				continue;
+			}
+#endif
+			if (!address)
+			{
+				std::uint64_t value;
+				[[maybe_unused]] const auto readResult =
+				    read(m_WakeUpHandle, &value, sizeof(value));
+				continue;
+			}
+
+			Post(std::coroutine_handle<>::from_address(address));
+		}
+	}
+}
+#endif
+
+bool IoContext::UsesIoUring() const noexcept
+{
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+	return static_cast<bool>(m_IoUring);
+#else
+	return false;
+#endif
+}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+void IoContext::QueueIoUring(IoUringAwaiter* awaiter)
+{
+	const std::lock_guard lock{ m_IoUringMutex };
+
+	const auto userData = reinterpret_cast<std::uintptr_t>(awaiter);
+	if (awaiter->m_IsWrite)
+	{
+		m_IoUring->QueueWrite(awaiter->m_Handle, awaiter->m_Offset,
+		                      std::span<const std::byte>(awaiter->m_Buffer, awaiter->m_Size),
+		                      userData);
+	}
+	else
+	{
+		m_IoUring->QueueRead(awaiter->m_Handle, awaiter->m_Offset,
+		                     std::span(awaiter->m_Buffer, awaiter->m_Size), userData);
+	}
+
+	// 不在 Run 的线程上时没有机会推迟提交，应立即提交
+	// 提交后请求可能立即完成，协程可能在其他线程上恢复，此后不可再访问 awaiter
+	if (CurrentRunningContext != this ||
+	    m_IoUring->GetPendingSubmissionCount() >= IoUringSubmitBatchSize)
+	{
+		m_IoUring->Submit();
+	}
+
+	m_IoUringHasPending.store(m_IoUring->GetPendingSubmissionCount() != 0,
+	                          std::memory_order_relaxed);
+}
+
+void IoContext::FlushIoUringSubmissions()
+{
+	const std::lock_guard lock{ m_IoUringMutex };
+	m_IoUring->Submit();
+	m_IoUringHasPending.store(m_IoUring->GetPendingSubmissionCount() != 0,
+	                          std::memory_order_relaxed);
+}
+
+void IoContext::ReapIoUringCompletions()
+{
+	IoUringCompletion completions[IoUringReapBatchSize];
+	while (true)
+	{
+		// 提交在持有 m_IoUringMutex 时进行，持有锁取出完成结果可保证提交方对等待体的写入先于此处的访问，
+		// 而非仅依赖系统调用隐含的屏障
+		std::size_t count;
+		{
+			const std::lock_guard lock{ m_IoUringMutex };
+			count = m_IoUring->ReapCompletions(completions);
+		}
+
+		if (!count)
+		{
+			break;
+		}
+
+		// 一次加入运行队列，避免逐个加锁
+		{
+			const std::lock_guard lock{ m_QueueMutex };
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const auto awaiter = reinterpret_cast<IoUringAwaiter*>(completions[i].UserData);
+				awaiter->m_Result = completions[i].Result;
+				m_ReadyQueue.push_back(awaiter->m_Coroutine);
+			}
+		}
+
+		if (count == 1)
+		{
+			m_QueueCondition.notify_one();
+		}
+		else
+		{
+			m_QueueCondition.notify_all();
+		}
+	}
+
+	// 完成队列已腾出空间，重新提交内核此前暂未接受的请求
+	if (m_IoUringHasPending.load(std::memory_order_relaxed))
+	{
+		try
+		{
+			FlushIoUringSubmissions();
+		}
+		catch (IoException const&)
+		{
+			// 请求仍保留在提交队列中，错误留待 Run 的线程再次提交时报告
+		}
+	}
+}
+
+std::size_t IoContext::CheckIoUringResult(std::int32_t result)
+{
+	if (result < 0)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("io_uring request failed."));
+	}
+
+	return static_cast<std::size_t>(result);
+}
+#endif
+
+void IoContext::RegisterWait(NativeHandle handle, bool writable, std::coroutine_handle<> coroutine)
+{
+#if defined(__linux__)
+	// 使用 EPOLLONESHOT，事件触发后句柄保持注册但不再报告，下次等待时以 EPOLL_CTL_MOD 重新启用
+	// 句柄关闭时内核会自动移除注册
+	epoll_event event{};
+	event.events = (writable ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+	event.data.ptr = coroutine.address();
+
+	if (epoll_ctl(m_EpollHandle, EPOLL_CTL_MOD, handle, &event) == -1)
+	{
+		if (errno != ENOENT || epoll_ctl(m_EpollHandle, EPOLL_CTL_ADD, handle, &event) == -1)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot wait for handle."));
+		}
+	}
+#elif !defined(_WIN32)
+	// 无 epoll 时在阻塞线程池中以 poll 等待
+	PostBlocking([this, handle, writable, coroutine] {
+		pollfd pollHandle{};
+		pollHandle.fd = handle;
+		pollHandle.events = writable ? POLLOUT : POLLIN;
+		while (poll(&pollHandle, 1, -1) == -1 && errno == EINTR)
+		{
+		}
+		Post(coroutine);
+	});
+#else
+	static_cast<void>(handle);
+	static_cast<void>(writable);
+	static_cast<void>(coroutine);
+	CAFE_THROW(IoException, CAFE_UTF8_SV("Waiting for handle readiness is not supported."));
+#endif
+}
+
+#endif
@@ -0,0 +1,562 @@
+#pragma once
+
+#include <Cafe/Io/Streams/Config/StreamConfig.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM
+
+#include "StreamBase.h"
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Cafe::Io
+{
+	template <typename T = void>
+	class Task;
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+	class IoUringEngine;
+#endif
+
+	namespace Detail
+	{
+		struct TaskFinalAwaiter
+		{
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			template <typename Promise>
+			std::coroutine_handle<>
+			await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+			{
+				// 对称转移到等待者，避免递归恢复导致栈增长
+				const auto continuation = handle.promise().m_Continuation;
+				return continuation ? continuation : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+
+		template <typename T>
+		struct TaskPromiseBase
+		{
+			std::coroutine_handle<> m_Continuation;
+
+			std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+
+			TaskFinalAwaiter final_suspend() const noexcept
+			{
+				return {};
+			}
+		};
+
+		template <typename T>
+		struct TaskPromise : TaskPromiseBase<T>
+		{
+			std::variant<std::monostate, T, std::exception_ptr> m_Result;
+
+			Task<T> get_return_object() noexcept;
+
+			template <typename U>
+			void return_value(U&& value)
+			{
+				m_Result.template emplace<1>(std::forward<U>(value));
+			}
+
+			void unhandled_exception() noexcept
+			{
+				m_Result.template emplace<2>(std::current_exception());
+			}
+
+			T GetResult()
+			{
+				if (m_Result.index() == 2)
+				{
+					std::rethrow_exception(std::get<2>(m_Result));
+				}
+
+				return std::move(std::get<1>(m_Result));
+			}
+		};
+
+		template <>
+		struct TaskPromise<void> : TaskPromiseBase<void>
+		{
+			std::exception_ptr m_Exception;
+
+			Task<void> get_return_object() noexcept;
+
+			void return_void() const noexcept
+			{
+			}
+
+			void unhandled_exception() noexcept
+			{
+				m_Exception = std::current_exception();
+			}
+
+			void GetResult()
+			{
+				if (m_Exception)
+				{
+					std::rethrow_exception(m_Exception);
+				}
+			}
+		};
+	} // namespace Detail
+
+	/// @brief  惰性启动的协程任务
+	/// @remark 任务在首次被 co_await 时开始执行，完成后恢复等待者
+	///         任务仅可被等待一次，析构时若协程尚未完成则直接销毁协程帧
+	template <typename T>
+	class [[nodiscard]] Task
+	{
+	public:
+		using promise_type = Detail::TaskPromise<T>;
+
+		Task() noexcept : m_Handle{}
+		{
+		}
+
+		explicit Task(std::coroutine_handle<promise_type> handle) noexcept : m_Handle{ handle }
+		{
+		}
+
+		Task(Task const&) = delete;
+
+		Task(Task&& other) noexcept : m_Handle{ std::exchange(other.m_Handle, nullptr) }
+		{
+		}
+
+		~Task()
+		{
+			if (m_Handle)
+			{
+				m_Handle.destroy();
+			}
+		}
+
+		Task& operator=(Task const&) = delete;
+
+		Task& operator=(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_Handle)
+				{
+					m_Handle.destroy();
+				}
+				m_Handle = std::exchange(other.m_Handle, nullptr);
+			}
+
+			return *this;
+		}
+
+		bool IsValid() const noexcept
+		{
+			return static_cast<bool>(m_Handle);
+		}
+
+		auto operator co_await() const noexcept
+		{
+			struct Awaiter
+			{
+				std::coroutine_handle<promise_type> m_Handle;
+
+				bool await_ready() const noexcept
+				{
+					return !m_Handle || m_Handle.done();
+				}
+
+				std::coroutine_handle<>
+				await_suspend(std::coroutine_handle<> awaitingHandle) const noexcept
+				{
+					m_Handle.promise().m_Continuation = awaitingHandle;
+					return m_Handle;
+				}
+
+				T await_resume() const
+				{
+					return m_Handle.promise().GetResult();
+				}
+			};
+
+			assert(m_Handle);
+			return Awaiter{ m_Handle };
+		}
+
+	private:
+		std::coroutine_handle<promise_type> m_Handle;
+	};
+
+	namespace Detail
+	{
+		template <typename T>
+		Task<T> TaskPromise<T>::get_return_object() noexcept
+		{
+			return Task<T>{ std::coroutine_handle<TaskPromise>::from_promise(*this) };
+		}
+
+		inline Task<void> TaskPromise<void>::get_return_object() noexcept
+		{
+			return Task<void>{ std::coroutine_handle<TaskPromise>::from_promise(*this) };
+		}
+
+		/// @brief  立即启动且完成时自行销毁的协程，用于 SyncWait 及 IoContext::Spawn
+		struct DetachedTask
+		{
+			struct promise_type
+			{
+				DetachedTask get_return_object() const noexcept
+				{
+					return {};
+				}
+
+				std::suspend_never initial_suspend() const noexcept
+				{
+					return {};
+				}
+
+				std::suspend_never final_suspend() const noexcept
+				{
+					return {};
+				}
+
+				void return_void() const noexcept
+				{
+				}
+
+				void unhandled_exception() const noexcept
+				{
+					std::terminate();
+				}
+			};
+		};
+
+		template <typename T>
+		DetachedTask RunAndSetPromise(Task<T> task, std::promise<T>& promise)
+		{
+			try
+			{
+				if constexpr (std::is_void_v<T>)
+				{
+					co_await task;
+					promise.set_value();
+				}
+				else
+				{
+					promise.set_value(co_await task);
+				}
+			}
+			catch (...)
+			{
+				promise.set_exception(std::current_exception());
+			}
+		}
+	} // namespace Detail
+
+	/// @brief  在当前线程上阻塞等待任务完成并返回其结果
+	/// @remark 不可在 IoContext 的工作线程上调用，否则可能死锁
+	template <typename T>
+	T SyncWait(Task<T> task)
+	{
+		std::promise<T> promise;
+		auto future = promise.get_future();
+		Detail::RunAndSetPromise(std::move(task), promise);
+		return future.get();
+	}
+
+	/// @brief  协程执行器
+	/// @remark 包含三部分：
+	///         运行队列，由调用 Run 的线程执行就绪的协程，可由少量线程服务大量协程
+	///         反应器，在 Linux 上以 epoll 等待管道、套接字等句柄就绪，由内部的一个线程执行
+	///         阻塞线程池，用于执行无法以就绪通知实现的阻塞操作，例如普通文件的读写
+	///         启用 io_uring 时，普通文件的读写由 io_uring 完成：请求在 Run 的线程空闲或积累足够多时批量提交，
+	///         完成结果由反应器取出，无需占用阻塞线程池
+	class CAFE_PUBLIC IoContext
+	{
+	public:
+		static constexpr std::size_t DefaultBlockingThreadCount = 2;
+
+		/// @param  blockingThreadCount 阻塞线程池的线程数
+		/// @param  useIoUring          若为 true 且系统支持则使用 io_uring，否则忽略
+		explicit IoContext(std::size_t blockingThreadCount = DefaultBlockingThreadCount,
+		                   bool useIoUring = true);
+
+		IoContext(IoContext const&) = delete;
+		IoContext& operator=(IoContext const&) = delete;
+
+		/// @remark 将会调用 Stop 并等待内部线程结束，析构前应确保所有调用 Run 的线程均已返回
+		///         阻塞线程池中尚未开始执行的任务将被丢弃
+		~IoContext();
+
+		/// @brief  在当前线程上执行就绪的协程，直到 Stop 被调用
+		/// @remark 可由多个线程同时调用
+		void Run();
+
+		/// @brief  停止执行，所有 Run 调用将在执行完当前协程后返回
+		void Stop();
+
+		bool IsStopped() const noexcept;
+
+		/// @brief  将协程加入运行队列
+		void Post(std::coroutine_handle<> handle);
+
+		/// @brief  启动一个任务，任务将在 Run 的线程上开始执行，完成后自行销毁
+		/// @remark 任务中未捕获的异常将导致 std::terminate
+		void Spawn(Task<> task);
+
+		/// @brief  返回一个等待体，等待后当前协程将在 Run 的线程上恢复
+		auto Schedule() noexcept
+		{
+			struct Awaiter
+			{
+				IoContext* m_Context;
+
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				void await_suspend(std::coroutine_handle<> handle) const
+				{
+					m_Context->Post(handle);
+				}
+
+				void await_resume() const noexcept
+				{
+				}
+			};
+
+			return Awaiter{ this };
+		}
+
+		/// @brief  在阻塞线程池中执行 func，完成后当前协程将在 Run 的线程上恢复并返回其结果
+		/// @remark func 抛出的异常将在等待处重新抛出
+		template <typename Func>
+		auto RunBlocking(Func func)
+		{
+			using ResultType = std::invoke_result_t<Func&>;
+
+			struct Awaiter
+			{
+				IoContext* m_Context;
+				Func m_Func;
+				std::conditional_t<std::is_void_v<ResultType>, std::monostate,
+				                   std::optional<ResultType>>
+				    m_Result;
+				std::exception_ptr m_Exception;
+
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				void await_suspend(std::coroutine_handle<> handle)
+				{
+					m_Context->PostBlocking([this, handle] {
+						try
+						{
+							if constexpr (std::is_void_v<ResultType>)
+							{
+								m_Func();
+							}
+							else
+							{
+								m_Result.emplace(m_Func());
+							}
+						}
+						catch (...)
+						{
+							m_Exception = std::current_exception();
+						}
+
+						m_Context->Post(handle);
+					});
+				}
+
+				ResultType await_resume()
+				{
+					if (m_Exception)
+					{
+						std::rethrow_exception(m_Exception);
+					}
+
+					if constexpr (!std::is_void_v<ResultType>)
+					{
+						return std::move(*m_Result);
+					}
+				}
+			};
+
+			return Awaiter{ this, std::move(func), {}, {} };
+		}
+
+		using NativeHandle =
+#if defined(_WIN32)
+		    void*
+#else
+		    int
+#endif
+		    ;
+
+		/// @brief  表示是否支持以就绪通知等待句柄
+		/// @remark Linux 上由反应器以 epoll 实现，其他 POSIX 平台上将在阻塞线程池中以 poll 等待
+		///         Windows 上不支持，应使用 RunBlocking
+		static constexpr bool SupportsReadinessWait =
+#if defined(_WIN32)
+		    false
+#else
+		    true
+#endif
+		    ;
+
+		/// @brief  返回一个等待体，等待后当前协程将在 handle 可读时于 Run 的线程上恢复
+		/// @remark handle 应为非阻塞模式的管道、套接字等，同一句柄同时只能有一个等待者
+		auto WaitReadable(NativeHandle handle) noexcept
+		{
+			return ReadinessAwaiter{ this, handle, false };
+		}
+
+		/// @brief  返回一个等待体，等待后当前协程将在 handle 可写时于 Run 的线程上恢复
+		/// @see    WaitReadable
+		auto WaitWritable(NativeHandle handle) noexcept
+		{
+			return ReadinessAwaiter{ this, handle, true };
+		}
+
+		/// @brief  表示是否使用 io_uring，若为 true 则可使用 ReadFileAsync 及 WriteFileAsync
+		bool UsesIoUring() const noexcept;
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+		/// @brief  返回一个等待体，以 io_uring 读取文件，完成后当前协程将在 Run 的线程上恢复
+		/// @remark 仅当 UsesIoUring() 为 true 时可用
+		/// @param  offset  读取的偏移，可为 IoUringEngine::CurrentPosition
+		/// @return 等待结果为读取的字节数
+		auto ReadFileAsync(int handle, std::uint64_t offset, std::span<std::byte> buffer) noexcept
+		{
+			return IoUringAwaiter{ this, handle, false, offset, buffer.data(), buffer.size() };
+		}
+
+		/// @brief  返回一个等待体，以 io_uring 写入文件，完成后当前协程将在 Run 的线程上恢复
+		/// @see    ReadFileAsync
+		/// @return 等待结果为写入的字节数
+		auto WriteFileAsync(int handle, std::uint64_t offset,
+		                    std::span<const std::byte> buffer) noexcept
+		{
+			return IoUringAwaiter{
+				this, handle, true, offset, const_cast<std::byte*>(buffer.data()), buffer.size()
+			};
+		}
+#endif
+
+	private:
+		struct ReadinessAwaiter
+		{
+			IoContext* m_Context;
+			NativeHandle m_Handle;
+			bool m_Writable;
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle) const
+			{
+				m_Context->RegisterWait(m_Handle, m_Writable, handle);
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+		struct IoUringAwaiter
+		{
+			IoContext* m_Context;
+			int m_Handle;
+			bool m_IsWrite;
+			std::uint64_t m_Offset;
+			std::byte* m_Buffer;
+			std::size_t m_Size;
+			std::coroutine_handle<> m_Coroutine{};
+			std::int32_t m_Result{};
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				m_Coroutine = handle;
+				m_Context->QueueIoUring(this);
+			}
+
+			std::size_t await_resume() const
+			{
+				return CheckIoUringResult(m_Result);
+			}
+		};
+
+		std::unique_ptr<IoUringEngine> m_IoUring;
+		// 保护提交队列，反应器取出完成结果时亦持有此锁以保证提交方的写入可见
+		std::mutex m_IoUringMutex;
+		std::atomic<bool> m_IoUringHasPending;
+
+		void QueueIoUring(IoUringAwaiter* awaiter);
+		void FlushIoUringSubmissions();
+		void ReapIoUringCompletions();
+		static std::size_t CheckIoUringResult(std::int32_t result);
+#endif
+
+		std::mutex m_QueueMutex;
+		std::condition_variable m_QueueCondition;
+		std::deque<std::coroutine_handle<>> m_ReadyQueue;
+		std::atomic<bool> m_Stopped;
+		std::atomic<bool> m_ShuttingDown;
+
+		std::mutex m_BlockingMutex;
+		std::condition_variable m_BlockingCondition;
+		std::deque<std::function<void()>> m_BlockingQueue;
+		std::vector<std::thread> m_BlockingThreads;
+
+#if defined(__linux__)
+		int m_EpollHandle;
+		int m_WakeUpHandle;
+		std::thread m_ReactorThread;
+
+		void ReactorMain();
+#endif
+
+		void PostBlocking(std::function<void()> job);
+		void BlockingThreadMain();
+		void RegisterWait(NativeHandle handle, bool writable, std::coroutine_handle<> coroutine);
+	};
+} // namespace Cafe::Io
+
+#endif
@@ -0,0 +1,336 @@
+#include <Cafe/Io/Streams/IoUring.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <vector>
+
+using namespace Cafe;
+using namespace Io;
+
+namespace
+{
+	// 与 read/write 一致，限制单次请求的长度
+	constexpr std::size_t MaxRequestSize = 0x7ffff000;
+
+	int IoUringSetup(unsigned entries, io_uring_params* params) noexcept
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+	}
+
+	int IoUringEnter(int ringHandle, unsigned toSubmit, unsigned minComplete,
+	                 unsigned flags) noexcept
+	{
+		return static_cast<int>(
+		    syscall(__NR_io_uring_enter, ringHandle, toSubmit, minComplete, flags, nullptr, 0));
+	}
+
+	int IoUringRegister(int ringHandle, unsigned opcode, const void* arg,
+	                    unsigned argCount) noexcept
+	{
+		return static_cast<int>(syscall(__NR_io_uring_register, ringHandle, opcode, arg, argCount));
+	}
+
+	// 读取/写入 IORING_OP_READ、IORING_OP_WRITE 及以 -1 作为偏移所需的内核特性
+	constexpr std::uint32_t RequiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_RW_CUR_POS;
+
+	std::uint32_t LoadAcquire(std::uint32_t* value) noexcept
+	{
+		return std::atomic_ref{ *value }.load(std::memory_order_acquire);
+	}
+
+	void StoreRelease(std::uint32_t* value, std::uint32_t newValue) noexcept
+	{
+		std::atomic_ref{ *value }.store(newValue, std::memory_order_release);
+	}
+
+	void PrepareReadWrite(io_uring_sqe* entry, std::uint8_t opcode, int fileHandle,
+	                      std::uint64_t offset, const void* buffer, std::size_t size,
+	                      std::uint64_t userData, IoUringRequestFlags flags,
+	                      std::uint16_t bufferIndex) noexcept
+	{
+		const auto useRegisteredBuffer = HasFlag(flags, IoUringRequestFlags::RegisteredBuffer);
+		if (useRegisteredBuffer)
+		{
+			opcode = opcode == IORING_OP_READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+		}
+		entry->opcode = opcode;
+		entry->fd = fileHandle;
+		entry->off = offset;
+		entry->addr = reinterpret_cast<std::uintptr_t>(buffer);
+		entry->len = static_cast<std::uint32_t>(std::min(size, MaxRequestSize));
+		entry->user_data = userData;
+		if (useRegisteredBuffer)
+		{
+			entry->buf_index = bufferIndex;
+		}
+		if (HasFlag(flags, IoUringRequestFlags::FixedFile))
+		{
+			entry->flags |= IOSQE_FIXED_FILE;
+		}
+	}
+} // namespace
+
+bool IoUringEngine::IsSupported() noexcept
+{
+	static const bool supported = [] {
+		io_uring_params params{};
+		const auto ringHandle = IoUringSetup(1, &params);
+		if (ringHandle < 0)
+		{
+			return false;
+		}
+
+		close(ringHandle);
+		return (params.features & RequiredFeatures) == RequiredFeatures;
+	}();
+
+	return supported;
+}
+
+IoUringEngine::IoUringEngine(std::uint32_t queueDepth)
+    : m_LocalSubmissionTail{}, m_PendingSubmissionCount{}
+{
+	io_uring_params params{};
+	m_RingHandle = IoUringSetup(queueDepth, &params);
+	if (m_RingHandle < 0)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot create io_uring instance."));
+	}
+
+	CAFE_SCOPE_FAIL
+	{
+		close(m_RingHandle);
+	};
+
+	if ((params.features & RequiredFeatures) != RequiredFeatures)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("io_uring is too old to be used."));
+	}
+
+	m_QueueDepth = params.sq_entries;
+
+	// 有 IORING_FEAT_SINGLE_MMAP 时提交队列与完成队列共享同一映射
+	m_RingSize = std::max(params.sq_off.array + params.sq_entries * sizeof(std::uint32_t),
+	                      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+	m_Ring = mmap(nullptr, m_RingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	              m_RingHandle, IORING_OFF_SQ_RING);
+	if (m_Ring == MAP_FAILED)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot map io_uring rings."));
+	}
+
+	CAFE_SCOPE_FAIL
+	{
+		munmap(m_Ring, m_RingSize);
+	};
+
+	m_SubmissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	const auto entries = mmap(nullptr, m_SubmissionEntriesSize, PROT_READ | PROT_WRITE,
+	                          MAP_SHARED | MAP_POPULATE, m_RingHandle, IORING_OFF_SQES);
+	if (entries == MAP_FAILED)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot map io_uring submission entries."));
+	}
+	m_SubmissionEntries = static_cast<io_uring_sqe*>(entries);
+
+	const auto ring = static_cast<std::byte*>(m_Ring);
+	m_SubmissionHead = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.head);
+	m_SubmissionTail = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.tail);
+	m_SubmissionMask = *reinterpret_cast<std::uint32_t*>(ring + params.sq_off.ring_mask);
+	m_SubmissionArray = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.array);
+	m_LocalSubmissionTail = *m_SubmissionTail;
+
+	m_CompletionHead = reinterpret_cast<std::uint32_t*>(ring + params.cq_off.head);
+	m_CompletionTail = reinterpret_cast<std::uint32_t*>(ring + params.cq_off.tail);
+	m_CompletionMask = *reinterpret_cast<std::uint32_t*>(ring + params.cq_off.ring_mask);
+	m_CompletionEntries = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+}
+
+IoUringEngine::~IoUringEngine()
+{
+	munmap(m_SubmissionEntries, m_SubmissionEntriesSize);
+	munmap(m_Ring, m_RingSize);
+	close(m_RingHandle);
+}
+
+int IoUringEngine::GetNativeHandle() const noexcept
+{
+	return m_RingHandle;
+}
+
+std::uint32_t IoUringEngine::GetQueueDepth() const noexcept
+{
+	return m_QueueDepth;
+}
+
+std::uint32_t IoUringEngine::GetPendingSubmissionCount() const noexcept
+{
+	return m_PendingSubmissionCount;
+}
+
+void IoUringEngine::QueueRead(int fileHandle, std::uint64_t offset, std::span<std::byte> buffer,
+                              std::uint64_t userData, IoUringRequestFlags flags,
+                              std::uint16_t bufferIndex)
+{
+	PrepareReadWrite(AcquireSubmissionEntry(), IORING_OP_READ, fileHandle, offset, buffer.data(),
+	                 buffer.size(), userData, flags, bufferIndex);
+}
+
+void IoUringEngine::QueueRead(FileInputStream const& stream, std::uint64_t offset,
+                              std::span<std::byte> buffer, std::uint64_t userData)
+{
+	QueueRead(stream.GetNativeHandle(), offset, buffer, userData);
+}
+
+void IoUringEngine::QueueWrite(int fileHandle, std::uint64_t offset,
+                               std::span<const std::byte> buffer, std::uint64_t userData,
+                               IoUringRequestFlags flags, std::uint16_t bufferIndex)
+{
+	PrepareReadWrite(AcquireSubmissionEntry(), IORING_OP_WRITE, fileHandle, offset,
+	                 buffer.data(), buffer.size(), userData, flags, bufferIndex);
+}
+
+void IoUringEngine::QueueWrite(FileOutputStream const& stream, std::uint64_t offset,
+                               std::span<const std::byte> buffer, std::uint64_t userData)
+{
+	QueueWrite(stream.GetNativeHandle(), offset, buffer, userData);
+}
+
+void IoUringEngine::QueueSync(int fileHandle, std::uint64_t userData, bool dataOnly,
+                              IoUringRequestFlags flags)
+{
+	const auto entry = AcquireSubmissionEntry();
+	entry->opcode = IORING_OP_FSYNC;
+	entry->fd = fileHandle;
+	entry->fsync_flags = dataOnly ? IORING_FSYNC_DATASYNC : 0;
+	entry->user_data = userData;
+	if (HasFlag(flags, IoUringRequestFlags::FixedFile))
+	{
+		entry->flags |= IOSQE_FIXED_FILE;
+	}
+}
+
+std::uint32_t IoUringEngine::Submit()
+{
+	return Enter(0, 0);
+}
+
+std::uint32_t IoUringEngine::SubmitAndWait(std::uint32_t waitCount)
+{
+	return Enter(waitCount, waitCount ? IORING_ENTER_GETEVENTS : 0);
+}
+
+std::size_t IoUringEngine::ReapCompletions(std::span<IoUringCompletion> completions) noexcept
+{
+	// 完成队列的头部仅由本方修改，尾部由内核修改
+	const auto head = *m_CompletionHead;
+	const auto tail = LoadAcquire(m_CompletionTail);
+	const auto count = std::min(static_cast<std::size_t>(tail - head), completions.size());
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto& entry = m_CompletionEntries[(head + i) & m_CompletionMask];
+		completions[i] = { entry.user_data, entry.res };
+	}
+
+	StoreRelease(m_CompletionHead, head + static_cast<std::uint32_t>(count));
+	return count;
+}
+
+void IoUringEngine::RegisterBuffers(std::span<const std::span<std::byte>> buffers)
+{
+	std::vector<iovec> ioVecs;
+	ioVecs.reserve(buffers.size());
+	for (const auto& buffer : buffers)
+	{
+		ioVecs.push_back({ buffer.data(), buffer.size() });
+	}
+
+	if (IoUringRegister(m_RingHandle, IORING_REGISTER_BUFFERS, ioVecs.data(),
+	                    static_cast<unsigned>(ioVecs.size())) < 0)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot register buffers."));
+	}
+}
+
+void IoUringEngine::UnregisterBuffers()
+{
+	if (IoUringRegister(m_RingHandle, IORING_UNREGISTER_BUFFERS, nullptr, 0) < 0)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot unregister buffers."));
+	}
+}
+
+void IoUringEngine::RegisterFiles(std::span<const int> fileHandles)
+{
+	if (IoUringRegister(m_RingHandle, IORING_REGISTER_FILES, fileHandles.data(),
+	                    static_cast<unsigned>(fileHandles.size())) < 0)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot register files."));
+	}
+}
+
+void IoUringEngine::UnregisterFiles()
+{
+	if (IoUringRegister(m_RingHandle, IORING_UNREGISTER_FILES, nullptr, 0) < 0)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot unregister files."));
+	}
+}
+
+io_uring_sqe* IoUringEngine::AcquireSubmissionEntry()
+{
+	// 未使用 SQPOLL 时内核在 io_uring_enter 中同步消费提交队列，因此提交后必然有空位
+	if (m_LocalSubmissionTail - LoadAcquire(m_SubmissionHead) == m_QueueDepth)
+	{
+		Submit();
+	}
+
+	const auto index = m_LocalSubmissionTail & m_SubmissionMask;
+	const auto entry = &m_SubmissionEntries[index];
+	std::memset(entry, 0, sizeof(io_uring_sqe));
+	m_SubmissionArray[index] = index;
+	++m_LocalSubmissionTail;
+	++m_PendingSubmissionCount;
+
+	return entry;
+}
+
+std::uint32_t IoUringEngine::Enter(std::uint32_t waitCount, unsigned flags)
+{
+	StoreRelease(m_SubmissionTail, m_LocalSubmissionTail);
+
+	const auto toSubmit = m_PendingSubmissionCount;
+	if (!toSubmit && !waitCount)
+	{
+		return 0;
+	}
+
+	int result;
+	while ((result = IoUringEnter(m_RingHandle, toSubmit, waitCount, flags)) < 0)
+	{
+		// 内核暂时无法接受请求，通常是因为完成队列已满，请求保留在提交队列中，由调用方取出完成结果后再次提交
+		if (errno == EAGAIN || errno == EBUSY)
+		{
+			return 0;
+		}
+
+		if (errno != EINTR)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Cannot submit io_uring requests."));
+		}
+	}
+
+	const auto submitted = static_cast<std::uint32_t>(result);
+	m_PendingSubmissionCount -= std::min(submitted, m_PendingSubmissionCount);
+	return submitted;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <Cafe/Io/Streams/Config/StreamConfig.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_ENABLE_IO_URING
+
+#include "FileStream.h"
+#include <cstdint>
+#include <span>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace Cafe::Io
+{
+	/// @brief  io_uring 请求的选项
+	enum class IoUringRequestFlags : std::uint8_t
+	{
+		None = 0,
+		/// @brief  文件句柄参数为以 IoUringEngine::RegisterFiles 注册的文件的索引
+		FixedFile = 1 << 0,
+		/// @brief  缓存位于以 IoUringEngine::RegisterBuffers 注册的缓存中，bufferIndex 参数为其索引
+		RegisteredBuffer = 1 << 1
+	};
+
+	constexpr IoUringRequestFlags operator|(IoUringRequestFlags a, IoUringRequestFlags b) noexcept
+	{
+		return static_cast<IoUringRequestFlags>(static_cast<std::uint8_t>(a) |
+		                                        static_cast<std::uint8_t>(b));
+	}
+
+	constexpr bool HasFlag(IoUringRequestFlags flags, IoUringRequestFlags flag) noexcept
+	{
+		return (static_cast<std::uint8_t>(flags) & static_cast<std::uint8_t>(flag)) ==
+		       static_cast<std::uint8_t>(flag);
+	}
+
+	/// @brief  已完成的 io_uring 请求
+	struct IoUringCompletion
+	{
+		/// @brief  提交请求时指定的用户数据
+		std::uint64_t UserData;
+
+		/// @brief  请求的结果，非负值为传输的字节数，负值为 -errno
+		std::int32_t Result;
+	};
+
+	/// @brief  基于 io_uring 的批量文件读写引擎
+	/// @remark 请求仅在 Queue* 系列方法中写入提交队列，直到 Submit 或 SubmitAndWait 时才以一次系统调用批量提交
+	///         完成队列与内核共享，ReapCompletions 在无需等待时不进行任何系统调用
+	///         本类不是线程安全的，多个线程使用同一实例时需自行同步
+	///         直接以原始系统调用实现，不依赖 liburing，要求内核版本不低于 5.6
+	class CAFE_PUBLIC IoUringEngine
+	{
+	public:
+		static constexpr std::uint32_t DefaultQueueDepth = 256;
+
+		/// @brief  作为偏移使用时表示使用并更新文件的当前位置，与 read/write 语义一致
+		static constexpr std::uint64_t CurrentPosition = std::uint64_t(-1);
+
+		/// @brief  表示当前系统是否支持本引擎
+		/// @remark 内核版本过低或 io_uring 被禁用（例如受 seccomp 限制）时返回 false，结果会被缓存
+		static bool IsSupported() noexcept;
+
+		/// @brief  创建引擎
+		/// @param  queueDepth  提交队列的深度，内核会将其向上取整为 2 的幂，完成队列的深度为其 2 倍
+		/// @throw  IoException 无法创建 io_uring 实例
+		explicit IoUringEngine(std::uint32_t queueDepth = DefaultQueueDepth);
+
+		IoUringEngine(IoUringEngine const&) = delete;
+		IoUringEngine& operator=(IoUringEngine const&) = delete;
+
+		~IoUringEngine();
+
+		/// @brief  获得 io_uring 实例的句柄
+		/// @remark 完成队列非空时句柄可读，可用于 epoll 等待完成
+		int GetNativeHandle() const noexcept;
+
+		std::uint32_t GetQueueDepth() const noexcept;
+
+		/// @brief  获得已加入提交队列但尚未提交的请求数
+		std::uint32_t GetPendingSubmissionCount() const noexcept;
+
+		/// @brief  将读取请求加入提交队列
+		/// @remark 提交队列已满时将自动提交
+		///         单个请求的长度被限制为 0x7ffff000 字节，实际读取的字节数由完成结果给出
+		/// @param  fileHandle  文件句柄，若 flags 包含 FixedFile 则为已注册文件的索引
+		/// @param  offset      读取的偏移，可为 CurrentPosition
+		/// @param  buffer      读取的目标，在请求完成前必须保持有效
+		/// @param  userData    用户数据，将原样出现在完成结果中
+		/// @param  flags       请求的选项
+		/// @param  bufferIndex 若 flags 包含 RegisteredBuffer，则为 buffer 所在的已注册缓存的索引
+		void QueueRead(int fileHandle, std::uint64_t offset, std::span<std::byte> buffer,
+		               std::uint64_t userData,
+		               IoUringRequestFlags flags = IoUringRequestFlags::None,
+		               std::uint16_t bufferIndex = 0);
+
+		void QueueRead(FileInputStream const& stream, std::uint64_t offset,
+		               std::span<std::byte> buffer, std::uint64_t userData);
+
+		/// @brief  将写入请求加入提交队列
+		/// @see    QueueRead
+		void QueueWrite(int fileHandle, std::uint64_t offset, std::span<const std::byte> buffer,
+		                std::uint64_t userData,
+		                IoUringRequestFlags flags = IoUringRequestFlags::None,
+		                std::uint16_t bufferIndex = 0);
+
+		void QueueWrite(FileOutputStream const& stream, std::uint64_t offset,
+		                std::span<const std::byte> buffer, std::uint64_t userData);
+
+		/// @brief  将同步请求加入提交队列
+		/// @param  dataOnly    若为 true 则仅同步数据，等价于 fdatasync
+		/// @remark 同步请求不会等待之前提交的写入请求完成，需要时应等待写入完成后再提交
+		void QueueSync(int fileHandle, std::uint64_t userData, bool dataOnly = false,
+		               IoUringRequestFlags flags = IoUringRequestFlags::None);
+
+		/// @brief  提交所有尚未提交的请求
+		/// @remark 内核暂时无法接受请求时（例如完成队列已满）不提交任何请求，
+		///         请求仍保留在提交队列中，应在取出完成结果后再次提交
+		/// @return 提交的请求数
+		std::uint32_t Submit();
+
+		/// @brief  提交所有尚未提交的请求，并等待直到至少有 waitCount 个完成结果可用
+		/// @remark 仅进行一次系统调用，内核暂时无法接受请求时不等待而立即返回，同 Submit
+		/// @return 提交的请求数
+		std::uint32_t SubmitAndWait(std::uint32_t waitCount);
+
+		/// @brief  取出至多 completions.size() 个完成结果，不进行系统调用
+		/// @return 取出的完成结果数
+		std::size_t ReapCompletions(std::span<IoUringCompletion> completions) noexcept;
+
+		/// @brief  注册缓存，以便以 RegisteredBuffer 选项发起请求，省去每次请求时内核映射页面的开销
+		/// @remark 已有注册的缓存时需先调用 UnregisterBuffers
+		void RegisterBuffers(std::span<const std::span<std::byte>> buffers);
+		void UnregisterBuffers();
+
+		/// @brief  注册文件，以便以 FixedFile 选项发起请求，省去每次请求时内核查找文件的开销
+		/// @remark 已有注册的文件时需先调用 UnregisterFiles
+		void RegisterFiles(std::span<const int> fileHandles);
+		void UnregisterFiles();
+
+	private:
+		int m_RingHandle;
+		std::uint32_t m_QueueDepth;
+
+		// 提交队列与完成队列共享的映射
+		void* m_Ring;
+		std::size_t m_RingSize;
+		io_uring_sqe* m_SubmissionEntries;
+		std::size_t m_SubmissionEntriesSize;
+
+		std::uint32_t* m_SubmissionHead;
+		std::uint32_t* m_SubmissionTail;
+		std::uint32_t m_SubmissionMask;
+		std::uint32_t* m_SubmissionArray;
+		// 已加入但尚未对内核可见的尾部
+		std::uint32_t m_LocalSubmissionTail;
+		std::uint32_t m_PendingSubmissionCount;
+
+		std::uint32_t* m_CompletionHead;
+		std::uint32_t* m_CompletionTail;
+		std::uint32_t m_CompletionMask;
+		io_uring_cqe* m_CompletionEntries;
+
+		io_uring_sqe* AcquireSubmissionEntry();
+		std::uint32_t Enter(std::uint32_t waitCount, unsigned flags);
+	};
+} // namespace Cafe::Io
+
+#endif
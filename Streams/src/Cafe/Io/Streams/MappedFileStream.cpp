@@ -0,0 +1,591 @@
+#include <Cafe/Io/Streams/MappedFileStream.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING &&     \
+    !defined(_WIN32)
+
+#include <Cafe/Misc/Scope.h>
+#include <algorithm>
+#include <cerrno>
+#include <sys/mman.h>
+
+using namespace Cafe;
+using namespace Io;
+
+namespace
+{
+	std::size_t GetPageSize() noexcept
+	{
+		static const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		return pageSize;
+	}
+
+	/// @brief  将文件从 currentSize 扩大到 size
+	/// @remark Linux 上以 fallocate 预留空间，使之后写入映射时不会因空间不足而产生 SIGBUS
+	void ExtendFile(int fileHandle, std::size_t currentSize, std::size_t size)
+	{
+		if (size <= currentSize)
+		{
+			return;
+		}
+
+#if defined(__linux__)
+		if (fallocate(fileHandle, 0, static_cast<off_t>(currentSize),
+		              static_cast<off_t>(size - currentSize)) == 0)
+		{
+			return;
+		}
+
+		if (errno != EOPNOTSUPP)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot extend file."));
+		}
+#endif
+
+		if (ftruncate(fileHandle, static_cast<off_t>(size)) == -1)
+		{
+			CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot extend file."));
+		}
+	}
+} // namespace
+
+MappedFileInputStream::MappedFileInputStream(FileInputStream file, std::size_t windowSize,
+                                             bool populate)
+    : m_File{ std::move(file) }, m_FileSize{}, m_WindowSize{}, m_Populate{ populate }, m_View{},
+      m_ViewSize{}, m_ViewOffset{}
+{
+	if (!HasCapability(m_File.GetCapabilities(), StreamCapability::Seekable))
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("File is not seekable."));
+	}
+
+	const auto pageMask = GetPageSize() - 1;
+	m_WindowSize = (std::max(windowSize, std::size_t(1)) + pageMask) & ~pageMask;
+	m_FileSize = m_File.GetTotalSize();
+	// 首次读取时才映射
+	m_ViewOffset = m_File.GetPosition();
+}
+
+MappedFileInputStream::MappedFileInputStream(MappedFileInputStream&& other) noexcept
+    : m_File{ std::move(other.m_File) }, m_FileSize{ other.m_FileSize },
+      m_WindowSize{ other.m_WindowSize }, m_Populate{ other.m_Populate },
+      m_View{ std::exchange(other.m_View, nullptr) }, m_ViewSize{ std::exchange(other.m_ViewSize,
+	                                                                            0) },
+      m_ViewOffset{ other.m_ViewOffset }
+{
+	// 虚基类不由移动构造函数初始化，需单独转移读取窗口
+	m_ReadWindowCurrent = std::exchange(other.m_ReadWindowCurrent, nullptr);
+	m_ReadWindowEnd = std::exchange(other.m_ReadWindowEnd, nullptr);
+}
+
+MappedFileInputStream::~MappedFileInputStream()
+{
+	MappedFileInputStream::Close();
+}
+
+MappedFileInputStream& MappedFileInputStream::operator=(MappedFileInputStream&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		m_File = std::move(other.m_File);
+		m_FileSize = other.m_FileSize;
+		m_WindowSize = other.m_WindowSize;
+		m_Populate = other.m_Populate;
+		m_View = std::exchange(other.m_View, nullptr);
+		m_ViewSize = std::exchange(other.m_ViewSize, 0);
+		m_ViewOffset = other.m_ViewOffset;
+		m_ReadWindowCurrent = std::exchange(other.m_ReadWindowCurrent, nullptr);
+		m_ReadWindowEnd = std::exchange(other.m_ReadWindowEnd, nullptr);
+	}
+
+	return *this;
+}
+
+void MappedFileInputStream::Close()
+{
+	Unmap();
+	m_File.Close();
+}
+
+StreamCapability MappedFileInputStream::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize |
+	       StreamCapability::PositionalIo | StreamCapability::Borrow;
+}
+
+std::size_t MappedFileInputStream::GetAvailableBytes()
+{
+	const auto pos = GetPosition();
+	return pos < m_FileSize ? m_FileSize - pos : 0;
+}
+
+std::size_t MappedFileInputStream::ReadBytesSlow(std::span<std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	std::size_t readSize = 0;
+
+	while (true)
+	{
+		const auto readSizeFromView = std::min(
+		    static_cast<std::size_t>(m_ReadWindowEnd - m_ReadWindowCurrent), bufferSize - readSize);
+		if (readSizeFromView)
+		{
+			std::memcpy(buffer.data() + readSize, m_ReadWindowCurrent, readSizeFromView);
+			m_ReadWindowCurrent += readSizeFromView;
+			readSize += readSizeFromView;
+		}
+
+		if (readSize == bufferSize || !MapWindow(GetPosition()))
+		{
+			break;
+		}
+	}
+
+	return readSize;
+}
+
+std::size_t MappedFileInputStream::Skip(std::size_t n)
+{
+	n = std::min(n, GetAvailableBytes());
+	SeekFromBegin(GetPosition() + n);
+	return n;
+}
+
+std::span<const std::byte> MappedFileInputStream::BorrowBytes(std::size_t maxSize)
+{
+	if (m_ReadWindowCurrent == m_ReadWindowEnd)
+	{
+		MapWindow(GetPosition());
+	}
+
+	const auto availableSize = static_cast<std::size_t>(m_ReadWindowEnd - m_ReadWindowCurrent);
+	return std::span(m_ReadWindowCurrent, std::min(maxSize, availableSize));
+}
+
+void MappedFileInputStream::Consume(std::size_t n)
+{
+	if (n <= static_cast<std::size_t>(m_ReadWindowEnd - m_ReadWindowCurrent))
+	{
+		m_ReadWindowCurrent += n;
+	}
+	else
+	{
+		Skip(n);
+	}
+}
+
+std::size_t MappedFileInputStream::GetPosition() const
+{
+	return m_View ? m_ViewOffset + (m_ReadWindowCurrent - m_View) : m_ViewOffset;
+}
+
+void MappedFileInputStream::SeekFromBegin(std::size_t pos)
+{
+	// 仅在当前窗口内移动，进入预读窗口时同样需要滑动窗口
+	if (m_View && pos >= m_ViewOffset &&
+	    pos <= m_ViewOffset + static_cast<std::size_t>(m_ReadWindowEnd - m_View))
+	{
+		m_ReadWindowCurrent = m_View + (pos - m_ViewOffset);
+		return;
+	}
+
+	Unmap();
+	m_ViewOffset = pos;
+}
+
+void MappedFileInputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+	std::size_t base;
+	switch (origin)
+	{
+	default:
+		assert(!"Invalid origin.");
+		[[fallthrough]];
+	case SeekOrigin::Begin:
+		base = 0;
+		break;
+	case SeekOrigin::Current:
+		base = GetPosition();
+		break;
+	case SeekOrigin::End:
+		base = m_FileSize;
+		break;
+	}
+
+	if (diff < 0 && std::size_t(0) - static_cast<std::size_t>(diff) > base)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot set position."));
+	}
+
+	SeekFromBegin(base + static_cast<std::size_t>(diff));
+}
+
+std::size_t MappedFileInputStream::GetTotalSize()
+{
+	return m_FileSize;
+}
+
+std::size_t MappedFileInputStream::ReadAt(std::size_t offset, std::span<std::byte> const& buffer)
+{
+	return m_File.ReadAt(offset, buffer);
+}
+
+FileInputStream& MappedFileInputStream::GetUnderlyingStream() noexcept
+{
+	return m_File;
+}
+
+std::size_t MappedFileInputStream::GetWindowSize() const noexcept
+{
+	return m_WindowSize;
+}
+
+bool MappedFileInputStream::MapWindow(std::size_t pos)
+{
+	Unmap();
+	m_ViewOffset = pos;
+	if (pos >= m_FileSize)
+	{
+		return false;
+	}
+
+	const auto pageSize = GetPageSize();
+	const auto alignedOffset = pos & ~(pageSize - 1);
+	const auto viewSize = std::min(m_WindowSize * 2, m_FileSize - alignedOffset);
+
+	auto flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+	if (m_Populate)
+	{
+		flags |= MAP_POPULATE;
+	}
+#endif
+
+	const auto view = mmap(nullptr, viewSize, PROT_READ, flags, m_File.GetNativeHandle(),
+	                       static_cast<off_t>(alignedOffset));
+	if (view == MAP_FAILED)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("mmap failed."));
+	}
+
+	m_View = static_cast<std::byte*>(view);
+	m_ViewSize = viewSize;
+	m_ViewOffset = alignedOffset;
+	m_ReadWindowCurrent = m_View + (pos - alignedOffset);
+	// 映射未到达文件结尾时，读取到预读窗口的开头即滑动窗口，使预读窗口中的数据总是提前读入
+	m_ReadWindowEnd = m_View + (alignedOffset + viewSize == m_FileSize
+	                                ? viewSize
+	                                : std::min(viewSize, m_WindowSize));
+
+	if (m_Populate)
+	{
+#if !defined(MAP_POPULATE)
+		for (std::size_t offset = 0; offset < viewSize; offset += pageSize)
+		{
+			static_cast<void>(*static_cast<volatile const std::byte*>(m_View + offset));
+		}
+#endif
+	}
+	else if (viewSize > m_WindowSize)
+	{
+		madvise(m_View + m_WindowSize, viewSize - m_WindowSize, MADV_WILLNEED);
+	}
+
+	return m_ReadWindowCurrent != m_ReadWindowEnd;
+}
+
+void MappedFileInputStream::Unmap() noexcept
+{
+	if (m_View)
+	{
+		m_ViewOffset = GetPosition();
+		munmap(m_View, m_ViewSize);
+
+		m_View = nullptr;
+		m_ViewSize = 0;
+		m_ReadWindowCurrent = nullptr;
+		m_ReadWindowEnd = nullptr;
+	}
+}
+
+
+MappedFileOutputStream::MappedFileOutputStream(FileOutputStream file, std::size_t growthSize)
+    : m_File{ std::move(file) }, m_GrowthSize{}, m_View{}, m_Capacity{}, m_Current{}, m_End{},
+      m_Size{}, m_DirtyBegin{ std::size_t(-1) }, m_DirtyEnd{}
+{
+	if (!HasCapability(m_File.GetCapabilities(), StreamCapability::Seekable))
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("File is not seekable."));
+	}
+
+	// 内部缓存中的数据将在映射以外写出，无法与映射协调
+	if (m_File.GetCachePolicy() == FileCachePolicy::Direct)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Direct I/O file cannot be mapped."));
+	}
+
+	const auto pageMask = GetPageSize() - 1;
+	m_GrowthSize = (std::max(growthSize, std::size_t(1)) + pageMask) & ~pageMask;
+	m_Size = m_File.GetTotalSize();
+
+	const auto fileHandle = m_File.GetNativeHandle();
+	const auto flags = fcntl(fileHandle, F_GETFL);
+	const auto position = flags != -1 && (flags & O_APPEND) ? m_Size : m_File.GetPosition();
+
+	// 空的映射无法扩大，因此至少映射 1 个增长单位
+	const auto capacity =
+	    (std::max({ m_Size, position, std::size_t(1) }) + m_GrowthSize - 1) / m_GrowthSize *
+	    m_GrowthSize;
+	ExtendFile(fileHandle, m_Size, capacity);
+
+	const auto view = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fileHandle, 0);
+	if (view == MAP_FAILED)
+	{
+		ftruncate(fileHandle, static_cast<off_t>(m_Size));
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("mmap failed."));
+	}
+
+	m_View = static_cast<std::byte*>(view);
+	m_Capacity = capacity;
+	m_Current = m_View + position;
+	m_End = m_View + capacity;
+}
+
+MappedFileOutputStream::MappedFileOutputStream(MappedFileOutputStream&& other) noexcept
+    : m_File{ std::move(other.m_File) }, m_GrowthSize{ other.m_GrowthSize },
+      m_View{ std::exchange(other.m_View, nullptr) },
+      m_Capacity{ std::exchange(other.m_Capacity, 0) },
+      m_Current{ std::exchange(other.m_Current, nullptr) },
+      m_End{ std::exchange(other.m_End, nullptr) }, m_Size{ other.m_Size },
+      m_DirtyBegin{ std::exchange(other.m_DirtyBegin, std::size_t(-1)) },
+      m_DirtyEnd{ std::exchange(other.m_DirtyEnd, 0) }
+{
+}
+
+MappedFileOutputStream::~MappedFileOutputStream()
+{
+	MappedFileOutputStream::Close();
+}
+
+MappedFileOutputStream& MappedFileOutputStream::operator=(MappedFileOutputStream&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		m_File = std::move(other.m_File);
+		m_GrowthSize = other.m_GrowthSize;
+		m_View = std::exchange(other.m_View, nullptr);
+		m_Capacity = std::exchange(other.m_Capacity, 0);
+		m_Current = std::exchange(other.m_Current, nullptr);
+		m_End = std::exchange(other.m_End, nullptr);
+		m_Size = other.m_Size;
+		m_DirtyBegin = std::exchange(other.m_DirtyBegin, std::size_t(-1));
+		m_DirtyEnd = std::exchange(other.m_DirtyEnd, 0);
+	}
+
+	return *this;
+}
+
+void MappedFileOutputStream::Close()
+{
+	if (!m_View)
+	{
+		return;
+	}
+
+	CAFE_SCOPE_EXIT
+	{
+		m_File.Close();
+	};
+
+	munmap(m_View, m_Capacity);
+	m_View = nullptr;
+	m_Capacity = 0;
+	m_Current = nullptr;
+	m_End = nullptr;
+	m_DirtyBegin = std::size_t(-1);
+	m_DirtyEnd = 0;
+
+	if (ftruncate(m_File.GetNativeHandle(), static_cast<off_t>(m_Size)) == -1)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot truncate file."));
+	}
+}
+
+StreamCapability MappedFileOutputStream::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize | StreamCapability::Borrow;
+}
+
+std::size_t MappedFileOutputStream::WriteBytesSlow(std::span<const std::byte> const& buffer)
+{
+	Reserve(GetPosition() + buffer.size());
+	std::memcpy(m_Current, buffer.data(), buffer.size());
+	MarkWritten(m_Current, buffer.size());
+	m_Current += buffer.size();
+	return buffer.size();
+}
+
+void MappedFileOutputStream::Flush()
+{
+	SyncDirtyRange(true);
+}
+
+void MappedFileOutputStream::SyncDirtyRange(bool wait)
+{
+	if (m_DirtyBegin >= m_DirtyEnd)
+	{
+		return;
+	}
+
+	// msync 要求起始地址按页对齐
+	const auto alignedBegin = m_DirtyBegin & ~(GetPageSize() - 1);
+	if (msync(m_View + alignedBegin, m_DirtyEnd - alignedBegin, wait ? MS_SYNC : MS_ASYNC) == -1)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("msync failed."));
+	}
+
+	m_DirtyBegin = std::size_t(-1);
+	m_DirtyEnd = 0;
+}
+
+void MappedFileOutputStream::Sync(DurabilityLevel level)
+{
+	switch (level)
+	{
+	default:
+		assert(!"Invalid level.");
+		[[fallthrough]];
+	case DurabilityLevel::None:
+		break;
+	case DurabilityLevel::WriteBack:
+		SyncDirtyRange(false);
+		break;
+	case DurabilityLevel::Data:
+		SyncDirtyRange(true);
+		break;
+	case DurabilityLevel::Full:
+		SyncDirtyRange(true);
+		m_File.Sync(DurabilityLevel::Full);
+		break;
+	}
+}
+
+std::span<std::byte> MappedFileOutputStream::AcquireWriteBuffer(std::size_t size)
+{
+	if (size > static_cast<std::size_t>(m_End - m_Current))
+	{
+		Reserve(GetPosition() + size);
+	}
+
+	return std::span(m_Current, m_End);
+}
+
+void MappedFileOutputStream::Commit(std::size_t n)
+{
+	assert(n <= static_cast<std::size_t>(m_End - m_Current));
+	MarkWritten(m_Current, n);
+	m_Current += n;
+}
+
+std::size_t MappedFileOutputStream::GetPosition() const
+{
+	return m_Current - m_View;
+}
+
+void MappedFileOutputStream::SeekFromBegin(std::size_t pos)
+{
+	Reserve(pos);
+	m_Current = m_View + pos;
+}
+
+void MappedFileOutputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+	std::size_t base;
+	switch (origin)
+	{
+	default:
+		assert(!"Invalid origin.");
+		[[fallthrough]];
+	case SeekOrigin::Begin:
+		base = 0;
+		break;
+	case SeekOrigin::Current:
+		base = GetPosition();
+		break;
+	case SeekOrigin::End:
+		base = m_Size;
+		break;
+	}
+
+	if (diff < 0 && std::size_t(0) - static_cast<std::size_t>(diff) > base)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("Cannot set position."));
+	}
+
+	SeekFromBegin(base + static_cast<std::size_t>(diff));
+}
+
+std::size_t MappedFileOutputStream::GetTotalSize()
+{
+	return m_Size;
+}
+
+std::size_t MappedFileOutputStream::WriteAt(std::size_t offset,
+                                            std::span<const std::byte> const& buffer)
+{
+	Reserve(offset + buffer.size());
+	if (!buffer.empty())
+	{
+		std::memcpy(m_View + offset, buffer.data(), buffer.size());
+		MarkWritten(m_View + offset, buffer.size());
+	}
+	return buffer.size();
+}
+
+FileOutputStream& MappedFileOutputStream::GetUnderlyingStream() noexcept
+{
+	return m_File;
+}
+
+std::size_t MappedFileOutputStream::GetCapacity() const noexcept
+{
+	return m_Capacity;
+}
+
+void MappedFileOutputStream::Reserve(std::size_t size)
+{
+	if (size <= m_Capacity)
+	{
+		return;
+	}
+
+	const auto position = GetPosition();
+	const auto newCapacity = (size + m_GrowthSize - 1) / m_GrowthSize * m_GrowthSize;
+	const auto fileHandle = m_File.GetNativeHandle();
+	ExtendFile(fileHandle, m_Capacity, newCapacity);
+
+#if defined(__linux__)
+	// 可能移动映射，但不需要复制数据
+	const auto view = mremap(m_View, m_Capacity, newCapacity, MREMAP_MAYMOVE);
+	if (view == MAP_FAILED)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("mremap failed."));
+	}
+#else
+	const auto view =
+	    mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fileHandle, 0);
+	if (view == MAP_FAILED)
+	{
+		CAFE_THROW(FileIoException, CAFE_UTF8_SV("mmap failed."));
+	}
+	munmap(m_View, m_Capacity);
+#endif
+
+	m_View = static_cast<std::byte*>(view);
+	m_Capacity = newCapacity;
+	m_Current = m_View + position;
+	m_End = m_View + newCapacity;
+}
+
+#endif
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <Cafe/Io/Streams/Config/StreamConfig.h>
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING &&     \
+    !defined(_WIN32)
+
+#include "FileStream.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Cafe::Io
+{
+	/// @brief  以滑动窗口映射文件的输入流
+	/// @remark 与 FileInputStream::MapToMemory 不同，任意时刻仅映射文件中至多 2 个窗口大小的范围，
+	///         因此可以读取远大于可用地址空间的文件，且占用的地址空间有上限
+	///         映射分为当前窗口及其后的预读窗口，映射时对预读窗口 madvise(MADV_WILLNEED) 使系统提前读入，
+	///         读取位置进入预读窗口时重新映射，使预读窗口成为新的当前窗口
+	///         读取及借出均直接访问映射的内存，BorrowBytes 无需复制
+	///         文件长度在构造时确定，若之后文件被其他进程截断，访问映射可能导致 SIGBUS
+	///         Windows 上暂不支持
+	class CAFE_PUBLIC MappedFileInputStream final : public SeekableStream<InputStream>
+	{
+	public:
+		static constexpr std::size_t DefaultWindowSize = 64 * 1024 * 1024;
+
+		/// @param  file        映射的文件，必须是可寻位的，流的当前位置作为本流的初始位置
+		/// @param  windowSize  窗口大小，将向上取整为页大小的倍数
+		/// @param  populate    是否在映射时即读入并建立全部页表项（Linux 上为 MAP_POPULATE，
+		///                     其他平台上逐页访问），适用于不能容忍读取时发生缺页的场景，
+		///                     代价是映射时将阻塞直到 2 个窗口的数据均被读入
+		/// @throw  FileIoException 文件不可寻位
+		explicit MappedFileInputStream(FileInputStream file,
+		                               std::size_t windowSize = DefaultWindowSize,
+		                               bool populate = false);
+
+		MappedFileInputStream(MappedFileInputStream const&) = delete;
+		MappedFileInputStream(MappedFileInputStream&& other) noexcept;
+
+		~MappedFileInputStream();
+
+		MappedFileInputStream& operator=(MappedFileInputStream const&) = delete;
+		MappedFileInputStream& operator=(MappedFileInputStream&& other) noexcept;
+
+		/// @remark 解除映射并关闭文件
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Seekable、KnownSize、PositionalIo 及 Borrow
+		StreamCapability GetCapabilities() const override;
+
+		std::size_t GetAvailableBytes() override;
+
+		/// @remark 当前窗口中的数据足够时将内联完成，ReadByte 也将直接读取当前窗口
+		std::size_t ReadBytes(std::span<std::byte> const& buffer) override
+		{
+			if (buffer.size() <= static_cast<std::size_t>(m_ReadWindowEnd - m_ReadWindowCurrent))
+			    [[likely]]
+			{
+				// buffer 为空时 m_ReadWindowCurrent 可能为空指针，不可传给 memcpy
+				if (!buffer.empty())
+				{
+					std::memcpy(buffer.data(), m_ReadWindowCurrent, buffer.size());
+					m_ReadWindowCurrent += buffer.size();
+				}
+				return buffer.size();
+			}
+
+			return ReadBytesSlow(buffer);
+		}
+
+		std::size_t Skip(std::size_t n) override;
+
+		/// @remark 直接借出映射的内存，当前窗口已读完时将先滑动窗口
+		///         借出的内存在下一次滑动窗口前有效
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+		std::size_t GetPosition() const override;
+		/// @remark 目标位置在已映射的范围内时不会重新映射，否则将在下次读取时映射
+		void SeekFromBegin(std::size_t pos) override;
+		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
+		std::size_t GetTotalSize() override;
+
+		/// @remark 以 pread 实现，不经过映射，可由多个线程同时调用
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
+
+		FileInputStream& GetUnderlyingStream() noexcept;
+
+		std::size_t GetWindowSize() const noexcept;
+
+	private:
+		FileInputStream m_File;
+		std::size_t m_FileSize;
+		std::size_t m_WindowSize;
+		bool m_Populate;
+
+		// 映射的开头，未映射时为空
+		std::byte* m_View;
+		std::size_t m_ViewSize;
+		// 映射开头对应的文件偏移，未映射时为当前位置
+		std::size_t m_ViewOffset;
+		// 当前位置及当前窗口的结尾由读取窗口表示，读取到窗口结尾时将滑动窗口
+
+		std::size_t ReadBytesSlow(std::span<std::byte> const& buffer);
+
+		/// @brief  映射 pos 所在的窗口及其后的预读窗口
+		/// @return 是否有可读的数据，为 false 表示已到结尾
+		bool MapWindow(std::size_t pos);
+
+		void Unmap() noexcept;
+	};
+
+	/// @brief  以映射写入文件的输出流，映射随写入自动增长
+	/// @remark 文件及映射以 growthSize 为单位增长：Linux 上以 fallocate 预留空间并以 mremap 扩大映射，
+	///         其他平台上以 ftruncate 扩大文件并重新映射，因此写入通常不需要系统调用
+	///         写入的数据在映射中即对其他进程可见，但需 Flush 或 SyncDirtyRange 才能保证写入存储设备
+	///         Close 时文件被截断为实际写入的长度，若进程在此之前异常退出，文件结尾可能残留以 0 填充的部分
+	///         文件的当前位置作为本流的初始位置，以追加模式打开的文件则从结尾开始写入
+	///         Windows 上暂不支持
+	class CAFE_PUBLIC MappedFileOutputStream final : public SeekableStream<OutputStream>
+	{
+	public:
+		static constexpr std::size_t DefaultGrowthSize = 16 * 1024 * 1024;
+
+		/// @param  file        映射的文件，必须是可寻位的
+		/// @param  growthSize  文件及映射每次增长的大小，将向上取整为页大小的倍数
+		/// @throw  FileIoException 文件不可寻位，或无法扩大及映射文件
+		explicit MappedFileOutputStream(FileOutputStream file,
+		                                std::size_t growthSize = DefaultGrowthSize);
+
+		MappedFileOutputStream(MappedFileOutputStream const&) = delete;
+		MappedFileOutputStream(MappedFileOutputStream&& other) noexcept;
+
+		~MappedFileOutputStream();
+
+		MappedFileOutputStream& operator=(MappedFileOutputStream const&) = delete;
+		MappedFileOutputStream& operator=(MappedFileOutputStream&& other) noexcept;
+
+		/// @remark 解除映射，将文件截断为实际写入的长度并关闭文件，不会同步到存储设备
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Seekable、KnownSize 及 Borrow
+		StreamCapability GetCapabilities() const override;
+
+		/// @remark 映射中剩余的空间足够时将内联完成
+		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+		{
+			if (buffer.size() <= static_cast<std::size_t>(m_End - m_Current)) [[likely]]
+			{
+				if (!buffer.empty())
+				{
+					std::memcpy(m_Current, buffer.data(), buffer.size());
+					MarkWritten(m_Current, buffer.size());
+					m_Current += buffer.size();
+				}
+				return buffer.size();
+			}
+
+			return WriteBytesSlow(buffer);
+		}
+
+		/// @brief  同步已修改的范围，等价于 SyncDirtyRange(true)
+		void Flush() override;
+
+		/// @brief  将自上次同步以来修改的范围以 msync 同步到文件
+		/// @param  wait    为 true 时等待写入存储设备完成（MS_SYNC），否则仅发起写回（MS_ASYNC）
+		void SyncDirtyRange(bool wait = true);
+
+		/// @remark DurabilityLevel::None 无操作，因为写入的数据已在页缓存中
+		///         WriteBack 等价于 SyncDirtyRange(false)，Data 等价于 SyncDirtyRange(true)
+		///         Full 在 SyncDirtyRange(true) 后同步文件的元数据
+		void Sync(DurabilityLevel level = DurabilityLevel::Full) override;
+
+		/// @remark 直接提供映射的内存，必要时先扩大映射，返回的长度不小于 size
+		///         返回的内存在下一次扩大映射前有效
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
+
+		std::size_t GetPosition() const override;
+		/// @remark 可以寻位到实际写入的长度以后，必要时将扩大映射，但不改变实际写入的长度
+		void SeekFromBegin(std::size_t pos) override;
+		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
+
+		/// @brief  获得实际写入的长度
+		std::size_t GetTotalSize() override;
+
+		/// @remark 必要时将扩大映射，不可与其他操作并发
+		std::size_t WriteAt(std::size_t offset, std::span<const std::byte> const& buffer) override;
+
+		FileOutputStream& GetUnderlyingStream() noexcept;
+
+		/// @brief  获得当前文件及映射的大小
+		std::size_t GetCapacity() const noexcept;
+
+		/// @brief  确保映射至少为 size 字节
+		void Reserve(std::size_t size);
+
+	private:
+		FileOutputStream m_File;
+		std::size_t m_GrowthSize;
+
+		// 关闭后为空
+		std::byte* m_View;
+		std::size_t m_Capacity;
+		std::byte* m_Current;
+		std::byte* m_End;
+
+		// 实际写入的长度
+		std::size_t m_Size;
+		// 自上次同步以来修改的范围，无修改时 m_DirtyBegin 不小于 m_DirtyEnd
+		std::size_t m_DirtyBegin;
+		std::size_t m_DirtyEnd;
+
+		void MarkWritten(std::byte* begin, std::size_t size) noexcept
+		{
+			const auto offset = static_cast<std::size_t>(begin - m_View);
+			m_DirtyBegin = std::min(m_DirtyBegin, offset);
+			m_DirtyEnd = std::max(m_DirtyEnd, offset + size);
+			m_Size = std::max(m_Size, offset + size);
+		}
+
+		std::size_t WriteBytesSlow(std::span<const std::byte> const& buffer);
+
+		/// @remark 写入的范围需记录以便同步，因此不提供写入窗口，映射中剩余的空间足够时在此直接写入
+		bool Overflow(std::byte value) override
+		{
+			if (m_Current != m_End) [[likely]]
+			{
+				*m_Current = value;
+				MarkWritten(m_Current, 1);
+				++m_Current;
+				return true;
+			}
+
+			return OutputStream::Overflow(value);
+		}
+	};
+} // namespace Cafe::Io
+
+#endif
@@ -1,20 +1,30 @@
 #include <Cafe/Io/Streams/MemoryStream.h>
+#include <algorithm>
+#include <bit>
 #include <cstring>
+#include <limits>
 
 using namespace Cafe;
 using namespace Io;
 
-MemoryStream::MemoryStream() : m_CurrentPosition{}
+MemoryStream::MemoryStream() : m_CurrentPosition{}, m_SizeBeforeAcquire{}
 {
 }
 
-MemoryStream::MemoryStream(std::span<const std::byte> const& initialContent)
-    : m_Storage(initialContent.begin(), initialContent.end()), m_CurrentPosition{}
+MemoryStream::MemoryStream(std::pmr::memory_resource* resource)
+    : m_Storage(resource), m_CurrentPosition{}, m_SizeBeforeAcquire{}
 {
 }
 
-MemoryStream::MemoryStream(std::vector<std::byte>&& initialStorage)
-    : m_Storage(std::move(initialStorage))
+MemoryStream::MemoryStream(std::span<const std::byte> const& initialContent,
+                           std::pmr::memory_resource* resource)
+    : m_Storage(initialContent.begin(), initialContent.end(), resource), m_CurrentPosition{},
+      m_SizeBeforeAcquire{}
+{
+}
+
+MemoryStream::MemoryStream(StorageType&& initialStorage)
+    : m_Storage(std::move(initialStorage)), m_CurrentPosition{}, m_SizeBeforeAcquire{}
 {
 }
 
@@ -29,6 +39,19 @@ void MemoryStream::Close()
 	m_CurrentPosition = 0;
 }
 
+void MemoryStream::Reset() noexcept
+{
+	m_Storage.clear();
+	m_CurrentPosition = 0;
+	m_SizeBeforeAcquire = 0;
+}
+
+StreamCapability MemoryStream::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize |
+	       StreamCapability::PositionalIo | StreamCapability::Borrow;
+}
+
 std::size_t MemoryStream::GetAvailableBytes()
 {
 	return m_Storage.size() - m_CurrentPosition;
@@ -50,6 +73,17 @@ std::size_t MemoryStream::Skip(std::size_t n)
 	return skippedSize;
 }
 
+std::span<const std::byte> MemoryStream::BorrowBytes(std::size_t maxSize)
+{
+	return std::span(m_Storage.data() + m_CurrentPosition, std::min(maxSize, GetAvailableBytes()));
+}
+
+void MemoryStream::Consume(std::size_t n)
+{
+	assert(n <= GetAvailableBytes());
+	m_CurrentPosition += n;
+}
+
 std::size_t MemoryStream::GetPosition() const
 {
 	return m_CurrentPosition;
@@ -102,7 +136,11 @@ std::size_t MemoryStream::GetTotalSize()
 std::size_t MemoryStream::WriteBytes(std::span<const std::byte> const& buffer)
 {
 	const auto copySize = std::min(static_cast<std::size_t>(buffer.size()), GetAvailableBytes());
-	std::memcpy(m_Storage.data() + m_CurrentPosition, buffer.data(), copySize);
+	// 存储为空时 data() 可能为空指针，即使长度为 0 亦不可传给 memcpy
+	if (copySize)
+	{
+		std::memcpy(m_Storage.data() + m_CurrentPosition, buffer.data(), copySize);
+	}
 	if (copySize != buffer.size())
 	{
 		m_Storage.insert(m_Storage.end(), buffer.begin() + copySize, buffer.end());
@@ -113,6 +151,55 @@ std::size_t MemoryStream::WriteBytes(std::span<const std::byte> const& buffer)
 	return buffer.size();
 }
 
+std::span<std::byte> MemoryStream::AcquireWriteBuffer(std::size_t size)
+{
+	m_SizeBeforeAcquire = m_Storage.size();
+	if (size > GetAvailableBytes())
+	{
+		m_Storage.resize(m_CurrentPosition + size);
+	}
+
+	return std::span(m_Storage.data() + m_CurrentPosition, size);
+}
+
+void MemoryStream::Commit(std::size_t n)
+{
+	assert(n <= GetAvailableBytes());
+	m_CurrentPosition += n;
+	m_Storage.resize(std::max(m_SizeBeforeAcquire, m_CurrentPosition));
+}
+
+std::size_t MemoryStream::ReadAt(std::size_t offset, std::span<std::byte> const& buffer)
+{
+	if (offset >= m_Storage.size())
+	{
+		return 0;
+	}
+
+	const auto readSize =
+	    std::min(static_cast<std::size_t>(buffer.size()), m_Storage.size() - offset);
+	std::memcpy(buffer.data(), m_Storage.data() + offset, readSize);
+
+	return readSize;
+}
+
+std::size_t MemoryStream::WriteAt(std::size_t offset, std::span<const std::byte> const& buffer)
+{
+	if (offset > std::numeric_limits<std::size_t>::max() - buffer.size())
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+	}
+
+	if (offset + buffer.size() > m_Storage.size())
+	{
+		m_Storage.resize(offset + buffer.size());
+	}
+
+	std::memcpy(m_Storage.data() + offset, buffer.data(), buffer.size());
+
+	return buffer.size();
+}
+
 std::span<std::byte> MemoryStream::GetInternalStorage() noexcept
 {
 	return std::span(m_Storage.data(), m_Storage.size());
@@ -123,11 +210,264 @@ std::span<const std::byte> MemoryStream::GetInternalStorage() const noexcept
 	return std::span(m_Storage.data(), m_Storage.size());
 }
 
-std::vector<std::byte> MemoryStream::ReleaseStorage() noexcept
+MemoryStream::StorageType MemoryStream::ReleaseStorage() noexcept
 {
+	m_CurrentPosition = 0;
 	return std::move(m_Storage);
 }
 
+std::pmr::memory_resource* MemoryStream::GetMemoryResource() const noexcept
+{
+	return m_Storage.get_allocator().resource();
+}
+
+SegmentedMemoryStream::SegmentedMemoryStream(std::size_t chunkSize)
+    : m_ChunkShift{ static_cast<std::size_t>(
+	      std::countr_zero(std::bit_ceil(std::max(chunkSize, std::size_t(1))))) },
+      m_Size{}, m_CurrentPosition{}
+{
+}
+
+SegmentedMemoryStream::~SegmentedMemoryStream()
+{
+}
+
+void SegmentedMemoryStream::Close()
+{
+	m_Chunks.clear();
+	m_Chunks.shrink_to_fit();
+	m_Size = 0;
+	m_CurrentPosition = 0;
+}
+
+StreamCapability SegmentedMemoryStream::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize |
+	       StreamCapability::PositionalIo | StreamCapability::Borrow;
+}
+
+std::size_t SegmentedMemoryStream::GetAvailableBytes()
+{
+	return m_Size - m_CurrentPosition;
+}
+
+std::size_t SegmentedMemoryStream::ReadBytes(std::span<std::byte> const& buffer)
+{
+	const auto readSize = std::min(static_cast<std::size_t>(buffer.size()), GetAvailableBytes());
+	CopyOut(m_CurrentPosition, buffer.data(), readSize);
+	m_CurrentPosition += readSize;
+
+	return readSize;
+}
+
+std::size_t SegmentedMemoryStream::Skip(std::size_t n)
+{
+	const auto skippedSize = std::min(n, GetAvailableBytes());
+	m_CurrentPosition += skippedSize;
+	return skippedSize;
+}
+
+std::span<const std::byte> SegmentedMemoryStream::BorrowBytes(std::size_t maxSize)
+{
+	const auto chunkOffset = m_CurrentPosition & GetChunkMask();
+	const auto size = std::min({ maxSize, GetAvailableBytes(), GetChunkSize() - chunkOffset });
+	if (!size)
+	{
+		return {};
+	}
+
+	return std::span(m_Chunks[m_CurrentPosition >> m_ChunkShift].get() + chunkOffset, size);
+}
+
+void SegmentedMemoryStream::Consume(std::size_t n)
+{
+	assert(n <= GetAvailableBytes());
+	m_CurrentPosition += n;
+}
+
+std::size_t SegmentedMemoryStream::GetPosition() const
+{
+	return m_CurrentPosition;
+}
+
+void SegmentedMemoryStream::SeekFromBegin(std::size_t pos)
+{
+	assert(pos <= m_Size);
+	m_CurrentPosition = pos;
+}
+
+void SegmentedMemoryStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+	// 检查符号后转换为无符号数比较，负数以其绝对值比较，转换不会溢出
+	const auto absDiff = diff < 0 ? std::size_t(0) - static_cast<std::size_t>(diff)
+	                              : static_cast<std::size_t>(diff);
+	switch (origin)
+	{
+	default:
+		assert(!"Invalid origin");
+		[[fallthrough]];
+	case SeekOrigin::Begin:
+		if (diff < 0 || absDiff > m_Size)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+		}
+		m_CurrentPosition = absDiff;
+		break;
+	case SeekOrigin::Current:
+		if (diff < 0 ? absDiff > m_CurrentPosition : absDiff > GetAvailableBytes())
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+		}
+
+		m_CurrentPosition = diff < 0 ? m_CurrentPosition - absDiff : m_CurrentPosition + absDiff;
+		break;
+	case SeekOrigin::End:
+		if (diff > 0 || absDiff > m_Size)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+		}
+
+		m_CurrentPosition = m_Size - absDiff;
+		break;
+	}
+}
+
+std::size_t SegmentedMemoryStream::GetTotalSize()
+{
+	return m_Size;
+}
+
+std::size_t SegmentedMemoryStream::WriteBytes(std::span<const std::byte> const& buffer)
+{
+	EnsureChunks(m_CurrentPosition + buffer.size());
+	CopyIn(m_CurrentPosition, buffer.data(), buffer.size());
+	m_CurrentPosition += buffer.size();
+	m_Size = std::max(m_Size, m_CurrentPosition);
+
+	return buffer.size();
+}
+
+std::span<std::byte> SegmentedMemoryStream::AcquireWriteBuffer(std::size_t size)
+{
+	const auto chunkOffset = m_CurrentPosition & GetChunkMask();
+	size = std::min(size, GetChunkSize() - chunkOffset);
+	if (!size)
+	{
+		return {};
+	}
+
+	EnsureChunks(m_CurrentPosition + size);
+	return std::span(m_Chunks[m_CurrentPosition >> m_ChunkShift].get() + chunkOffset, size);
+}
+
+void SegmentedMemoryStream::Commit(std::size_t n)
+{
+	assert(m_CurrentPosition + n <= m_Chunks.size() << m_ChunkShift);
+	m_CurrentPosition += n;
+	m_Size = std::max(m_Size, m_CurrentPosition);
+}
+
+std::size_t SegmentedMemoryStream::ReadAt(std::size_t offset, std::span<std::byte> const& buffer)
+{
+	if (offset >= m_Size)
+	{
+		return 0;
+	}
+
+	const auto readSize = std::min(static_cast<std::size_t>(buffer.size()), m_Size - offset);
+	CopyOut(offset, buffer.data(), readSize);
+
+	return readSize;
+}
+
+std::size_t SegmentedMemoryStream::WriteAt(std::size_t offset,
+                                           std::span<const std::byte> const& buffer)
+{
+	if (offset > std::numeric_limits<std::size_t>::max() - buffer.size())
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+	}
+
+	const auto end = offset + buffer.size();
+	if (end > m_Size)
+	{
+		EnsureChunks(end);
+		// 分块未初始化，需以 0 填充跳过的部分
+		for (auto position = m_Size; position < offset;)
+		{
+			const auto chunkOffset = position & GetChunkMask();
+			const auto size = std::min(offset - position, GetChunkSize() - chunkOffset);
+			std::memset(m_Chunks[position >> m_ChunkShift].get() + chunkOffset, 0, size);
+			position += size;
+		}
+		m_Size = end;
+	}
+
+	CopyIn(offset, buffer.data(), buffer.size());
+
+	return buffer.size();
+}
+
+std::size_t SegmentedMemoryStream::GetChunkSize() const noexcept
+{
+	return std::size_t(1) << m_ChunkShift;
+}
+
+std::vector<std::span<const std::byte>> SegmentedMemoryStream::GetSegments() const
+{
+	std::vector<std::span<const std::byte>> segments;
+	segments.reserve((m_Size + GetChunkMask()) >> m_ChunkShift);
+	for (std::size_t position = 0; position < m_Size; position += GetChunkSize())
+	{
+		segments.emplace_back(m_Chunks[position >> m_ChunkShift].get(),
+		                      std::min(GetChunkSize(), m_Size - position));
+	}
+
+	return segments;
+}
+
+std::size_t SegmentedMemoryStream::GetChunkMask() const noexcept
+{
+	return GetChunkSize() - 1;
+}
+
+void SegmentedMemoryStream::EnsureChunks(std::size_t size)
+{
+	const auto chunkCount = (size + GetChunkMask()) >> m_ChunkShift;
+	while (m_Chunks.size() < chunkCount)
+	{
+		m_Chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(GetChunkSize()));
+	}
+}
+
+void SegmentedMemoryStream::CopyIn(std::size_t offset, const std::byte* data,
+                                   std::size_t size) noexcept
+{
+	while (size)
+	{
+		const auto chunkOffset = offset & GetChunkMask();
+		const auto copySize = std::min(size, GetChunkSize() - chunkOffset);
+		std::memcpy(m_Chunks[offset >> m_ChunkShift].get() + chunkOffset, data, copySize);
+		offset += copySize;
+		data += copySize;
+		size -= copySize;
+	}
+}
+
+void SegmentedMemoryStream::CopyOut(std::size_t offset, std::byte* data,
+                                    std::size_t size) const noexcept
+{
+	while (size)
+	{
+		const auto chunkOffset = offset & GetChunkMask();
+		const auto copySize = std::min(size, GetChunkSize() - chunkOffset);
+		std::memcpy(data, m_Chunks[offset >> m_ChunkShift].get() + chunkOffset, copySize);
+		offset += copySize;
+		data += copySize;
+		size -= copySize;
+	}
+}
+
 ExternalMemoryInputStream::ExternalMemoryInputStream(
     std::span<const std::byte> const& storage) noexcept
     : ExternalMemoryStreamCommonPart{ storage, false }
@@ -144,6 +484,12 @@ ExternalMemoryInputStream::~ExternalMemoryInputStream()
 {
 }
 
+StreamCapability ExternalMemoryInputStream::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize |
+	       StreamCapability::PositionalIo | StreamCapability::Borrow;
+}
+
 std::size_t ExternalMemoryInputStream::GetAvailableBytes()
 {
 	return m_Storage.size() - GetPosition();
@@ -169,8 +515,8 @@ std::size_t ExternalMemoryInputStream::ReadBytes(std::span<std::byte> const& buf
 		readSize = bufferSize;
 	}
 
-	std::memcpy(buffer.data(), m_CurrentPosition, readSize);
-	m_CurrentPosition += readSize;
+	std::memcpy(buffer.data(), CurrentPosition(), readSize);
+	CurrentPosition() += readSize;
 
 	return readSize;
 }
@@ -178,10 +524,44 @@ std::size_t ExternalMemoryInputStream::ReadBytes(std::span<std::byte> const& buf
 std::size_t ExternalMemoryInputStream::Skip(std::size_t n)
 {
 	const auto skippedSize = std::min(n, GetAvailableBytes());
-	m_CurrentPosition += skippedSize;
+	CurrentPosition() += skippedSize;
 	return skippedSize;
 }
 
+std::size_t ExternalMemoryInputStream::ReadAt(std::size_t offset,
+                                              std::span<std::byte> const& buffer)
+{
+	const auto availableSize = offset < m_Storage.size() ? m_Storage.size() - offset : 0;
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+
+	if (bufferSize > availableSize && m_ErrorOnOutOfRange)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+	}
+
+	// offset 超出范围时不可计算起始地址
+	if (offset >= m_Storage.size())
+	{
+		return 0;
+	}
+
+	const auto readSize = std::min(bufferSize, availableSize);
+	std::memcpy(buffer.data(), m_Storage.data() + offset, readSize);
+
+	return readSize;
+}
+
+std::span<const std::byte> ExternalMemoryInputStream::BorrowBytes(std::size_t maxSize)
+{
+	return std::span(CurrentPosition(), std::min(maxSize, GetAvailableBytes()));
+}
+
+void ExternalMemoryInputStream::Consume(std::size_t n)
+{
+	assert(n <= GetAvailableBytes());
+	CurrentPosition() += n;
+}
+
 ExternalMemoryOutputStream::ExternalMemoryOutputStream(std::span<std::byte> const& storage) noexcept
     : ExternalMemoryStreamCommonPart{ storage, false }
 {
@@ -197,6 +577,12 @@ ExternalMemoryOutputStream::~ExternalMemoryOutputStream()
 {
 }
 
+StreamCapability ExternalMemoryOutputStream::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize |
+	       StreamCapability::PositionalIo | StreamCapability::Borrow;
+}
+
 std::size_t ExternalMemoryOutputStream::WriteBytes(std::span<const std::byte> const& buffer)
 {
 	std::size_t writtenSize;
@@ -217,8 +603,36 @@ std::size_t ExternalMemoryOutputStream::WriteBytes(std::span<const std::byte> co
 		writtenSize = bufferSize;
 	}
 
-	std::memcpy(m_CurrentPosition, buffer.data(), writtenSize);
-	m_CurrentPosition += writtenSize;
+	std::memcpy(CurrentPosition(), buffer.data(), writtenSize);
+	CurrentPosition() += writtenSize;
+
+	return writtenSize;
+}
+
+std::span<std::byte> ExternalMemoryOutputStream::AcquireWriteBuffer(std::size_t size)
+{
+	return std::span(CurrentPosition(), std::min(size, m_Storage.size() - GetPosition()));
+}
+
+void ExternalMemoryOutputStream::Commit(std::size_t n)
+{
+	assert(n <= m_Storage.size() - GetPosition());
+	CurrentPosition() += n;
+}
+
+std::size_t ExternalMemoryOutputStream::WriteAt(std::size_t offset,
+                                                std::span<const std::byte> const& buffer)
+{
+	const auto availableSize = offset < m_Storage.size() ? m_Storage.size() - offset : 0;
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+
+	if (bufferSize > availableSize && m_ErrorOnOutOfRange)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+	}
+
+	const auto writtenSize = std::min(bufferSize, availableSize);
+	std::memcpy(m_Storage.data() + offset, buffer.data(), writtenSize);
 
 	return writtenSize;
 }
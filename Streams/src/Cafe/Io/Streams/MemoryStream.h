@@ -1,24 +1,47 @@
 #pragma once
 
 #include "StreamBase.h"
+#include <memory>
+#include <memory_resource>
 #include <vector>
 
 namespace Cafe::Io
 {
-	class CAFE_PUBLIC MemoryStream : public SeekableStream<InputOutputStream>
+	/// @brief  以连续的存储保存内容的内存流
+	/// @remark 存储由指定的 std::pmr::memory_resource 分配，可使用 std::pmr::monotonic_buffer_resource
+	///         等由请求所有的内存资源以避免频繁地向全局堆分配及释放
+	///         需重复使用时应调用 Reset 而非 Close，以保留已分配的存储
+	class CAFE_PUBLIC MemoryStream final : public SeekableStream<InputOutputStream>
 	{
 	public:
+		using StorageType = std::pmr::vector<std::byte>;
+
 		MemoryStream();
-		explicit MemoryStream(std::span<const std::byte> const& initialContent);
-		explicit MemoryStream(std::vector<std::byte>&& initialStorage);
+		/// @param  resource    分配存储使用的内存资源，需在本对象及释放出的存储之后析构
+		explicit MemoryStream(std::pmr::memory_resource* resource);
+		explicit MemoryStream(std::span<const std::byte> const& initialContent,
+		                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		explicit MemoryStream(StorageType&& initialStorage);
+		/// @remark std::vector<std::byte> 的存储无法移动到 StorageType 中，为避免经由 span 的构造函数
+		///         静默复制而禁用，需要复制时应显式传入 span
+		explicit MemoryStream(std::vector<std::byte>&& initialStorage) = delete;
 		~MemoryStream();
 
+		/// @remark 将会释放存储
 		void Close() override;
 
+		/// @brief  清空内容并回到开头，保留已分配的存储以供复用
+		void Reset() noexcept;
+
+		StreamCapability GetCapabilities() const override;
+
 		std::size_t GetAvailableBytes() override;
 		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
 		std::size_t Skip(std::size_t n) override;
 
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
 		std::size_t GetPosition() const override;
 		void SeekFromBegin(std::size_t pos) override;
 		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
@@ -26,14 +49,94 @@ namespace Cafe::Io
 
 		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override;
 
+		/// @remark 若当前位置之后的存储不足 size 将会扩展存储，返回的 span 长度总为 size
+		///         扩展的部分在 Commit 时将被截去未提交的部分
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
+
+		/// @remark 不改变存储大小的 ReadAt 及 WriteAt 可由多个线程同时调用
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
+		/// @remark 若写入范围超出当前存储则会扩展存储，此时不可与其他操作并发
+		///         offset 超出当前存储大小时，中间的部分将以 0 填充
+		std::size_t WriteAt(std::size_t offset, std::span<const std::byte> const& buffer) override;
+
 		std::span<std::byte> GetInternalStorage() noexcept;
 		std::span<const std::byte> GetInternalStorage() const noexcept;
 
-		std::vector<std::byte> ReleaseStorage() noexcept;
+		/// @remark 释放后本对象的存储为空，但仍使用原先的内存资源
+		StorageType ReleaseStorage() noexcept;
+
+		std::pmr::memory_resource* GetMemoryResource() const noexcept;
 
 	private:
-		std::vector<std::byte> m_Storage;
+		StorageType m_Storage;
 		std::size_t m_CurrentPosition;
+		std::size_t m_SizeBeforeAcquire;
+	};
+
+	/// @brief  以固定大小的分块存储内容的内存流
+	/// @remark 与 MemoryStream 不同，增长时仅分配新的分块，已写入的内容不会被重新分配及复制，
+	///         因此追加的开销为常数，且增长期间不会暂时占用两倍的内存，适用于构建较大的内容
+	///         内容在内存中不连续，BorrowBytes 及 AcquireWriteBuffer 不会跨越分块的边界，
+	///         可由 GetSegments 获得各分块中的内容
+	class CAFE_PUBLIC SegmentedMemoryStream final : public SeekableStream<InputOutputStream>
+	{
+	public:
+		static constexpr std::size_t DefaultChunkSize = 64 * 1024;
+
+		/// @param  chunkSize   分块的大小，将向上取整为 2 的幂
+		explicit SegmentedMemoryStream(std::size_t chunkSize = DefaultChunkSize);
+		~SegmentedMemoryStream();
+
+		void Close() override;
+
+		StreamCapability GetCapabilities() const override;
+
+		std::size_t GetAvailableBytes() override;
+		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
+		std::size_t Skip(std::size_t n) override;
+
+		/// @remark 借出的长度不超过当前分块的剩余部分
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+		std::size_t GetPosition() const override;
+		void SeekFromBegin(std::size_t pos) override;
+		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
+		std::size_t GetTotalSize() override;
+
+		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override;
+
+		/// @remark 必要时分配新的分块，返回的长度不超过当前分块的剩余部分
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
+
+		/// @remark 不分配分块的 ReadAt 及 WriteAt 可由多个线程同时调用
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
+		/// @remark 若写入范围超出当前内容则会分配分块，此时不可与其他操作并发
+		///         offset 超出当前内容的长度时，中间的部分将以 0 填充
+		std::size_t WriteAt(std::size_t offset, std::span<const std::byte> const& buffer) override;
+
+		std::size_t GetChunkSize() const noexcept;
+
+		/// @brief  获得各分块中的内容，依次连接即为全部内容
+		/// @remark 返回的 span 在流被关闭或析构前有效
+		std::vector<std::span<const std::byte>> GetSegments() const;
+
+	private:
+		// 分块数组增长时仅移动指针，分块本身不会被移动
+		std::vector<std::unique_ptr<std::byte[]>> m_Chunks;
+		std::size_t m_ChunkShift;
+		std::size_t m_Size;
+		std::size_t m_CurrentPosition;
+
+		std::size_t GetChunkMask() const noexcept;
+
+		/// @brief  确保已分配的分块足以容纳 size 个字节
+		void EnsureChunks(std::size_t size);
+
+		void CopyIn(std::size_t offset, const std::byte* data, std::size_t size) noexcept;
+		void CopyOut(std::size_t offset, std::byte* data, std::size_t size) const noexcept;
 	};
 
 	namespace Detail
@@ -47,21 +150,55 @@ namespace Cafe::Io
 		protected:
 			explicit ExternalMemoryStreamCommonPart(std::span<ElementType> const& storage,
 			                                        bool errorOnOutOfRange) noexcept
-			    : m_Storage{ storage }, m_CurrentPosition{ m_Storage.data() }, m_ErrorOnOutOfRange{
-				      errorOnOutOfRange
-			      }
+			    : m_Storage{ storage }, m_ErrorOnOutOfRange{ errorOnOutOfRange }
+			{
+				// 窗口的结尾总为存储的结尾，ReadByte 及 WriteByte 只在到达结尾时进行虚函数调用
+				if constexpr (std::is_same_v<BaseStream, InputStream>)
+				{
+					this->m_ReadWindowCurrent = m_Storage.data();
+					this->m_ReadWindowEnd = m_Storage.data() + m_Storage.size();
+				}
+				else
+				{
+					this->m_WriteWindowCurrent = m_Storage.data();
+					this->m_WriteWindowEnd = m_Storage.data() + m_Storage.size();
+				}
+			}
+
+			/// @brief  获得当前位置，即读取或写入窗口的起始
+			ElementType*& CurrentPosition() noexcept
+			{
+				if constexpr (std::is_same_v<BaseStream, InputStream>)
+				{
+					return this->m_ReadWindowCurrent;
+				}
+				else
+				{
+					return this->m_WriteWindowCurrent;
+				}
+			}
+
+			ElementType* CurrentPosition() const noexcept
 			{
+				if constexpr (std::is_same_v<BaseStream, InputStream>)
+				{
+					return this->m_ReadWindowCurrent;
+				}
+				else
+				{
+					return this->m_WriteWindowCurrent;
+				}
 			}
 
 		public:
 			std::size_t GetPosition() const override
 			{
-				return m_CurrentPosition - m_Storage.data();
+				return CurrentPosition() - m_Storage.data();
 			}
 
 			void SeekFromBegin(std::size_t pos) override
 			{
-				m_CurrentPosition = m_Storage.data() + pos;
+				CurrentPosition() = m_Storage.data() + pos;
 			}
 
 			void Seek(SeekOrigin origin, std::ptrdiff_t diff) override
@@ -73,16 +210,16 @@ namespace Cafe::Io
 					[[fallthrough]];
 				case SeekOrigin::Begin:
 					assert(0 <= diff && diff <= m_Storage.size());
-					m_CurrentPosition = m_Storage.data() + diff;
+					CurrentPosition() = m_Storage.data() + diff;
 					break;
 				case SeekOrigin::Current:
-					assert(m_CurrentPosition - m_Storage.data() <= diff &&
-					       diff <= m_Storage.data() + m_Storage.size() - m_CurrentPosition);
-					m_CurrentPosition += diff;
+					assert(CurrentPosition() - m_Storage.data() <= diff &&
+					       diff <= m_Storage.data() + m_Storage.size() - CurrentPosition());
+					CurrentPosition() += diff;
 					break;
 				case SeekOrigin::End:
 					assert(-m_Storage.size() <= diff && diff <= 0);
-					m_CurrentPosition = m_Storage.data() + m_Storage.size() + diff;
+					CurrentPosition() = m_Storage.data() + m_Storage.size() + diff;
 					break;
 				}
 			}
@@ -99,7 +236,6 @@ namespace Cafe::Io
 
 		protected:
 			std::span<ElementType> m_Storage;
-			ElementType* m_CurrentPosition;
 			bool m_ErrorOnOutOfRange;
 		};
 
@@ -110,7 +246,7 @@ namespace Cafe::Io
 
 	constexpr Detail::ErrorOnOutOfRangeTag ErrorOnOutOfRange{};
 
-	class CAFE_PUBLIC ExternalMemoryInputStream
+	class CAFE_PUBLIC ExternalMemoryInputStream final
 	    : public Detail::ExternalMemoryStreamCommonPart<InputStream>
 	{
 	public:
@@ -119,12 +255,21 @@ namespace Cafe::Io
 		                          Detail::ErrorOnOutOfRangeTag) noexcept;
 		~ExternalMemoryInputStream();
 
+		/// @remark 包含 StreamCapability::Seekable、KnownSize、PositionalIo 及 Borrow
+		StreamCapability GetCapabilities() const override;
+
 		std::size_t GetAvailableBytes() override;
 		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
 		std::size_t Skip(std::size_t n) override;
+
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+		/// @remark 可由多个线程同时调用
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
 	};
 
-	class CAFE_PUBLIC ExternalMemoryOutputStream
+	class CAFE_PUBLIC ExternalMemoryOutputStream final
 	    : public Detail::ExternalMemoryStreamCommonPart<OutputStream>
 	{
 	public:
@@ -133,6 +278,15 @@ namespace Cafe::Io
 		                           Detail::ErrorOnOutOfRangeTag) noexcept;
 		~ExternalMemoryOutputStream();
 
+		/// @remark 包含 StreamCapability::Seekable、KnownSize、PositionalIo 及 Borrow
+		StreamCapability GetCapabilities() const override;
+
 		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override;
+
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
+
+		/// @remark 可由多个线程同时调用，写入范围不重叠时结果是确定的
+		std::size_t WriteAt(std::size_t offset, std::span<const std::byte> const& buffer) override;
 	};
 } // namespace Cafe::Io
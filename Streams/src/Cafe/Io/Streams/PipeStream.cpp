@@ -0,0 +1,300 @@
+#include <Cafe/ErrorHandling/ErrorHandling.h>
+#include <Cafe/Io/Streams/PipeStream.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+using namespace Cafe;
+using namespace Io;
+
+namespace
+{
+	constexpr std::size_t CacheLineSize = 64;
+
+	// 位置的最高位表示修改该位置的一端已关闭，使等待对方位置变化的一端能被唤醒
+	constexpr std::size_t ClosedFlag = std::size_t(1)
+	                                   << (std::numeric_limits<std::size_t>::digits - 1);
+} // namespace
+
+namespace Cafe::Io::Detail
+{
+	struct PipeBuffer
+	{
+		explicit PipeBuffer(std::size_t capacity)
+		    : Storage{ std::make_unique_for_overwrite<std::byte[]>(capacity) }, Mask{ capacity - 1 },
+		      WritePosition{}, ReadPosition{}
+		{
+		}
+
+		std::unique_ptr<std::byte[]> Storage;
+		// 缓存大小减 1，缓存大小总是 2 的幂
+		std::size_t Mask;
+
+		// 两端各自修改的位置位于不同的缓存行，避免伪共享
+		alignas(CacheLineSize) std::atomic<std::size_t> WritePosition;
+		alignas(CacheLineSize) std::atomic<std::size_t> ReadPosition;
+	};
+} // namespace Cafe::Io::Detail
+
+std::pair<PipeInputStream, PipeOutputStream> Cafe::Io::CreatePipeStream(std::size_t capacity)
+{
+	const auto buffer =
+	    std::make_shared<Detail::PipeBuffer>(std::bit_ceil(std::max(capacity, std::size_t(1))));
+	return { PipeInputStream{ buffer }, PipeOutputStream{ buffer } };
+}
+
+PipeInputStream::PipeInputStream(std::shared_ptr<Detail::PipeBuffer> buffer) noexcept
+    : m_Buffer{ std::move(buffer) }, m_ReadPosition{}, m_CachedWritePosition{}
+{
+}
+
+PipeInputStream::PipeInputStream(PipeInputStream&& other) noexcept
+    : m_Buffer{ std::move(other.m_Buffer) }, m_ReadPosition{ other.m_ReadPosition },
+      m_CachedWritePosition{ other.m_CachedWritePosition }
+{
+}
+
+PipeInputStream::~PipeInputStream()
+{
+	PipeInputStream::Close();
+}
+
+PipeInputStream& PipeInputStream::operator=(PipeInputStream&& other) noexcept
+{
+	Close();
+
+	m_Buffer = std::move(other.m_Buffer);
+	m_ReadPosition = other.m_ReadPosition;
+	m_CachedWritePosition = other.m_CachedWritePosition;
+
+	return *this;
+}
+
+void PipeInputStream::Close()
+{
+	if (m_Buffer)
+	{
+		m_Buffer->ReadPosition.fetch_or(ClosedFlag, std::memory_order_release);
+		m_Buffer->ReadPosition.notify_one();
+		m_Buffer.reset();
+	}
+}
+
+StreamCapability PipeInputStream::GetCapabilities() const
+{
+	return StreamCapability::Borrow;
+}
+
+std::size_t PipeInputStream::GetAvailableBytes()
+{
+	m_CachedWritePosition =
+	    m_Buffer->WritePosition.load(std::memory_order_acquire) & ~ClosedFlag;
+	return m_CachedWritePosition - m_ReadPosition;
+}
+
+std::size_t PipeInputStream::ReadBytes(std::span<std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	const auto capacity = m_Buffer->Mask + 1;
+	std::size_t readSize = 0;
+
+	while (readSize < bufferSize)
+	{
+		const auto availableSize = WaitReadable();
+		if (!availableSize)
+		{
+			break;
+		}
+
+		const auto offset = m_ReadPosition & m_Buffer->Mask;
+		const auto size = std::min({ availableSize, bufferSize - readSize, capacity - offset });
+		std::memcpy(buffer.data() + readSize, m_Buffer->Storage.get() + offset, size);
+		readSize += size;
+		Advance(size);
+	}
+
+	return readSize;
+}
+
+std::size_t PipeInputStream::Skip(std::size_t n)
+{
+	std::size_t skippedSize = 0;
+	while (skippedSize < n)
+	{
+		const auto availableSize = WaitReadable();
+		if (!availableSize)
+		{
+			break;
+		}
+
+		const auto size = std::min(availableSize, n - skippedSize);
+		skippedSize += size;
+		Advance(size);
+	}
+
+	return skippedSize;
+}
+
+std::span<const std::byte> PipeInputStream::BorrowBytes(std::size_t maxSize)
+{
+	const auto availableSize = WaitReadable();
+	const auto offset = m_ReadPosition & m_Buffer->Mask;
+	return std::span(m_Buffer->Storage.get() + offset,
+	                 std::min({ availableSize, m_Buffer->Mask + 1 - offset, maxSize }));
+}
+
+void PipeInputStream::Consume(std::size_t n)
+{
+	assert(n <= m_CachedWritePosition - m_ReadPosition);
+	if (n)
+	{
+		Advance(n);
+	}
+}
+
+std::size_t PipeInputStream::WaitReadable()
+{
+	if (m_CachedWritePosition != m_ReadPosition)
+	{
+		return m_CachedWritePosition - m_ReadPosition;
+	}
+
+	auto writePosition = m_Buffer->WritePosition.load(std::memory_order_acquire);
+	while ((writePosition & ~ClosedFlag) == m_ReadPosition)
+	{
+		if (writePosition & ClosedFlag)
+		{
+			return 0;
+		}
+
+		m_Buffer->WritePosition.wait(writePosition, std::memory_order_acquire);
+		writePosition = m_Buffer->WritePosition.load(std::memory_order_acquire);
+	}
+
+	m_CachedWritePosition = writePosition & ~ClosedFlag;
+	return m_CachedWritePosition - m_ReadPosition;
+}
+
+void PipeInputStream::Advance(std::size_t n) noexcept
+{
+	m_ReadPosition += n;
+	m_Buffer->ReadPosition.store(m_ReadPosition, std::memory_order_release);
+	m_Buffer->ReadPosition.notify_one();
+}
+
+PipeOutputStream::PipeOutputStream(std::shared_ptr<Detail::PipeBuffer> buffer) noexcept
+    : m_Buffer{ std::move(buffer) }, m_WritePosition{}, m_CachedReadPosition{}
+{
+}
+
+PipeOutputStream::PipeOutputStream(PipeOutputStream&& other) noexcept
+    : m_Buffer{ std::move(other.m_Buffer) }, m_WritePosition{ other.m_WritePosition },
+      m_CachedReadPosition{ other.m_CachedReadPosition }
+{
+}
+
+PipeOutputStream::~PipeOutputStream()
+{
+	PipeOutputStream::Close();
+}
+
+PipeOutputStream& PipeOutputStream::operator=(PipeOutputStream&& other) noexcept
+{
+	Close();
+
+	m_Buffer = std::move(other.m_Buffer);
+	m_WritePosition = other.m_WritePosition;
+	m_CachedReadPosition = other.m_CachedReadPosition;
+
+	return *this;
+}
+
+void PipeOutputStream::Close()
+{
+	if (m_Buffer)
+	{
+		m_Buffer->WritePosition.fetch_or(ClosedFlag, std::memory_order_release);
+		m_Buffer->WritePosition.notify_one();
+		m_Buffer.reset();
+	}
+}
+
+StreamCapability PipeOutputStream::GetCapabilities() const
+{
+	return StreamCapability::Borrow;
+}
+
+std::size_t PipeOutputStream::WriteBytes(std::span<const std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	const auto capacity = m_Buffer->Mask + 1;
+	std::size_t writtenSize = 0;
+
+	while (writtenSize < bufferSize)
+	{
+		const auto freeSize = WaitWritable();
+		const auto offset = m_WritePosition & m_Buffer->Mask;
+		const auto size = std::min({ freeSize, bufferSize - writtenSize, capacity - offset });
+		std::memcpy(m_Buffer->Storage.get() + offset, buffer.data() + writtenSize, size);
+		writtenSize += size;
+		Publish(size);
+	}
+
+	return writtenSize;
+}
+
+std::span<std::byte> PipeOutputStream::AcquireWriteBuffer(std::size_t size)
+{
+	const auto freeSize = WaitWritable();
+	const auto offset = m_WritePosition & m_Buffer->Mask;
+	return std::span(m_Buffer->Storage.get() + offset,
+	                 std::min({ freeSize, m_Buffer->Mask + 1 - offset, size }));
+}
+
+void PipeOutputStream::Commit(std::size_t n)
+{
+	assert(n <= m_Buffer->Mask + 1 - (m_WritePosition - m_CachedReadPosition));
+	if (n)
+	{
+		Publish(n);
+	}
+}
+
+std::size_t PipeOutputStream::WaitWritable()
+{
+	const auto capacity = m_Buffer->Mask + 1;
+	if (const auto usedSize = m_WritePosition - m_CachedReadPosition; usedSize != capacity)
+	{
+		return capacity - usedSize;
+	}
+
+	auto readPosition = m_Buffer->ReadPosition.load(std::memory_order_acquire);
+	while (true)
+	{
+		if (readPosition & ClosedFlag)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Pipe has been closed."));
+		}
+
+		if (m_WritePosition - readPosition != capacity)
+		{
+			break;
+		}
+
+		m_Buffer->ReadPosition.wait(readPosition, std::memory_order_acquire);
+		readPosition = m_Buffer->ReadPosition.load(std::memory_order_acquire);
+	}
+
+	m_CachedReadPosition = readPosition;
+	return capacity - (m_WritePosition - m_CachedReadPosition);
+}
+
+void PipeOutputStream::Publish(std::size_t n) noexcept
+{
+	m_WritePosition += n;
+	m_Buffer->WritePosition.store(m_WritePosition, std::memory_order_release);
+	m_Buffer->WritePosition.notify_one();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "StreamBase.h"
+#include <memory>
+#include <utility>
+
+namespace Cafe::Io
+{
+	namespace Detail
+	{
+		struct PipeBuffer;
+	}
+
+	class PipeInputStream;
+	class PipeOutputStream;
+
+	constexpr std::size_t DefaultPipeCapacity = 64 * 1024;
+
+	/// @brief  创建一对以环形缓存连接的管道流，写入输出端的数据可从输入端按顺序读出
+	/// @param  capacity    环形缓存的大小，将向上取整为 2 的幂
+	/// @remark 两端各自只能由一个线程使用，但两端可位于不同的线程，缓存的读写不使用锁
+	///         两端共享缓存的所有权，可分别移动到使用它们的线程中
+	CAFE_PUBLIC std::pair<PipeInputStream, PipeOutputStream>
+	CreatePipeStream(std::size_t capacity = DefaultPipeCapacity);
+
+	/// @brief  管道流的输入端
+	/// @remark 缓存为空时 ReadBytes 及 BorrowBytes 将阻塞到有数据写入或输出端关闭
+	///         输出端关闭且缓存中的数据已读完后视为已到结尾
+	class CAFE_PUBLIC PipeInputStream final : public InputStream
+	{
+	public:
+		PipeInputStream(PipeInputStream const&) = delete;
+		PipeInputStream(PipeInputStream&& other) noexcept;
+
+		~PipeInputStream();
+
+		PipeInputStream& operator=(PipeInputStream const&) = delete;
+		PipeInputStream& operator=(PipeInputStream&& other) noexcept;
+
+		/// @remark 关闭后输出端的写入将会抛出异常
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Borrow
+		StreamCapability GetCapabilities() const override;
+
+		/// @remark 不会阻塞
+		std::size_t GetAvailableBytes() override;
+		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
+		std::size_t Skip(std::size_t n) override;
+
+		/// @remark 直接借出环形缓存中的数据，数据跨越缓存结尾时仅借出结尾之前的部分
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+	private:
+		friend std::pair<PipeInputStream, PipeOutputStream> CreatePipeStream(std::size_t capacity);
+
+		explicit PipeInputStream(std::shared_ptr<Detail::PipeBuffer> buffer) noexcept;
+
+		std::shared_ptr<Detail::PipeBuffer> m_Buffer;
+		// 已读取的总长度，仅由本端修改
+		std::size_t m_ReadPosition;
+		// 最近一次观察到的已写入的总长度，避免每次读取都访问输出端修改的缓存行
+		std::size_t m_CachedWritePosition;
+
+		/// @brief  等待到有数据可读或输出端关闭
+		/// @return 可读取的长度，为 0 表示已到结尾
+		std::size_t WaitReadable();
+		void Advance(std::size_t n) noexcept;
+	};
+
+	/// @brief  管道流的输出端
+	/// @remark 缓存已满时 WriteBytes 及 AcquireWriteBuffer 将阻塞到输入端读取
+	///         写入的数据立即可被输入端读取，因此 Flush 无操作
+	class CAFE_PUBLIC PipeOutputStream final : public OutputStream
+	{
+	public:
+		PipeOutputStream(PipeOutputStream const&) = delete;
+		PipeOutputStream(PipeOutputStream&& other) noexcept;
+
+		~PipeOutputStream();
+
+		PipeOutputStream& operator=(PipeOutputStream const&) = delete;
+		PipeOutputStream& operator=(PipeOutputStream&& other) noexcept;
+
+		/// @remark 关闭后输入端读完缓存中的数据即到结尾
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Borrow
+		StreamCapability GetCapabilities() const override;
+
+		/// @throw  IoException 输入端已关闭，缓存仍有空闲时可能在之后的写入中才能发现
+		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override;
+
+		/// @remark 直接提供环形缓存中的空闲部分，空闲部分跨越缓存结尾时仅提供结尾之前的部分
+		/// @throw  IoException 输入端已关闭
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
+
+	private:
+		friend std::pair<PipeInputStream, PipeOutputStream> CreatePipeStream(std::size_t capacity);
+
+		explicit PipeOutputStream(std::shared_ptr<Detail::PipeBuffer> buffer) noexcept;
+
+		std::shared_ptr<Detail::PipeBuffer> m_Buffer;
+		// 已写入的总长度，仅由本端修改
+		std::size_t m_WritePosition;
+		// 最近一次观察到的已读取的总长度，避免每次写入都访问输入端修改的缓存行
+		std::size_t m_CachedReadPosition;
+
+		/// @brief  等待到缓存有空闲
+		/// @return 空闲的长度，总是大于 0
+		/// @throw  IoException 输入端已关闭
+		std::size_t WaitWritable();
+		void Publish(std::size_t n) noexcept;
+	};
+} // namespace Cafe::Io
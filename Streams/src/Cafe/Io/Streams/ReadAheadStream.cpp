@@ -0,0 +1,473 @@
+#include <Cafe/ErrorHandling/ErrorHandling.h>
+#include <Cafe/Io/Streams/ReadAheadStream.h>
+#include <algorithm>
+
+using namespace Cafe;
+using namespace Io;
+
+ReadAheadInputStream::ReadAheadInputStream(InputStream* stream, std::size_t initialWindowSize,
+                                           std::size_t minWindowSize, std::size_t maxWindowSize)
+    : m_UnderlyingStream{ stream }, m_SeekableUnderlyingStream{},
+      m_UnderlyingCapabilities{ stream->GetCapabilities() }, m_MinWindowSize{ minWindowSize },
+      m_MaxWindowSize{ maxWindowSize },
+      m_WindowSize{ std::clamp(initialWindowSize, minWindowSize, maxWindowSize) },
+      // 流的开头通常被顺序读取，因此首次填充后即开始预读
+      m_SequentialCount{ 1 },
+      m_Storage{ std::make_unique_for_overwrite<std::byte[]>(maxWindowSize * 2) },
+      m_Buffer{ m_Storage.get() }, m_ReadSize{}, m_BufferBeginPosition{},
+      m_PrefetchBuffer{ m_Storage.get() + maxWindowSize }, m_Prefetching{ false },
+      m_PrefetchState{ PrefetchState::Idle }, m_PrefetchRequestSize{}, m_PrefetchReadSize{},
+      m_Stopping{ false }
+{
+	assert(minWindowSize && minWindowSize <= maxWindowSize);
+	UpdateReadWindow(0);
+
+	if (HasCapability(m_UnderlyingCapabilities, StreamCapability::Seekable))
+	{
+		m_SeekableUnderlyingStream = dynamic_cast<SeekableStream<InputStream>*>(stream);
+		if (m_SeekableUnderlyingStream)
+		{
+			m_BufferBeginPosition = m_SeekableUnderlyingStream->GetPosition();
+		}
+	}
+
+	m_Worker = std::thread{ &ReadAheadInputStream::WorkerMain, this };
+}
+
+ReadAheadInputStream::~ReadAheadInputStream()
+{
+	ReadAheadInputStream::Close();
+}
+
+void ReadAheadInputStream::Close()
+{
+	if (!m_UnderlyingStream)
+	{
+		return;
+	}
+
+	// 后台线程在完成进行中的预读后才会检查 m_Stopping
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+	m_Worker.join();
+
+	if (m_SeekableUnderlyingStream && (m_Prefetching || GetCurrentOffset() != m_ReadSize))
+	{
+		m_SeekableUnderlyingStream->SeekFromBegin(GetPosition());
+	}
+
+	m_UnderlyingStream = nullptr;
+	m_SeekableUnderlyingStream = nullptr;
+	m_Prefetching = false;
+	m_Storage.reset();
+	m_Buffer = nullptr;
+	m_PrefetchBuffer = nullptr;
+	m_ReadSize = 0;
+	UpdateReadWindow(0);
+}
+
+StreamCapability ReadAheadInputStream::GetCapabilities() const
+{
+	auto capabilities = StreamCapability::Borrow;
+	if (m_SeekableUnderlyingStream)
+	{
+		capabilities |= m_UnderlyingCapabilities &
+		                (StreamCapability::Seekable | StreamCapability::KnownSize |
+		                 StreamCapability::PositionalIo);
+	}
+
+	return capabilities;
+}
+
+std::size_t ReadAheadInputStream::GetAvailableBytes()
+{
+	const auto bufferedSize = m_ReadSize - GetCurrentOffset();
+	if (!m_Prefetching)
+	{
+		return bufferedSize + m_UnderlyingStream->GetAvailableBytes();
+	}
+
+	// 预读进行中时不可访问包装流，仅计入已完成的预读
+	const std::lock_guard lock{ m_Mutex };
+	return bufferedSize + (m_PrefetchState == PrefetchState::Completed ? m_PrefetchReadSize : 0);
+}
+
+std::size_t ReadAheadInputStream::ReadBytesSlow(std::span<std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	std::size_t readSize = 0;
+
+	while (true)
+	{
+		const auto readSizeFromBuffer =
+		    std::min(m_ReadSize - GetCurrentOffset(), bufferSize - readSize);
+		std::memcpy(buffer.data() + readSize, m_ReadWindowCurrent, readSizeFromBuffer);
+		m_ReadWindowCurrent += readSizeFromBuffer;
+		readSize += readSizeFromBuffer;
+
+		const auto remainedSize = bufferSize - readSize;
+		if (!remainedSize)
+		{
+			break;
+		}
+
+		if (!m_Prefetching && remainedSize >= m_MaxWindowSize)
+		{
+			// 剩余部分不小于缓存大小且没有可利用的预读，直接读取到用户的缓存中以避免额外的复制
+			const auto readSizeFromStream = m_UnderlyingStream->ReadBytes(buffer.subspan(readSize));
+			m_BufferBeginPosition += m_ReadSize + readSizeFromStream;
+			m_ReadSize = 0;
+			UpdateReadWindow(0);
+			readSize += readSizeFromStream;
+			break;
+		}
+
+		if (!Refill())
+		{
+			break;
+		}
+	}
+
+	return readSize;
+}
+
+std::size_t ReadAheadInputStream::Skip(std::size_t n)
+{
+	const auto bufferedSize = m_ReadSize - GetCurrentOffset();
+	if (n <= bufferedSize)
+	{
+		m_ReadWindowCurrent += n;
+		return n;
+	}
+
+	auto skippedSize = bufferedSize;
+	m_BufferBeginPosition += m_ReadSize;
+	m_ReadSize = 0;
+	UpdateReadWindow(0);
+
+	// 已预读的数据仍可利用
+	if (m_Prefetching)
+	{
+		std::exception_ptr exception;
+		const auto prefetchedSize = TakePrefetch(exception);
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+
+		std::swap(m_Buffer, m_PrefetchBuffer);
+		m_ReadSize = prefetchedSize;
+		if (n - skippedSize <= prefetchedSize)
+		{
+			UpdateReadWindow(n - skippedSize);
+			return n;
+		}
+
+		skippedSize += prefetchedSize;
+		m_BufferBeginPosition += prefetchedSize;
+		m_ReadSize = 0;
+		UpdateReadWindow(0);
+
+		// 流已到结尾
+		if (prefetchedSize != m_PrefetchRequestSize)
+		{
+			return skippedSize;
+		}
+	}
+
+	// 跳过的数据不会被读取，视为随机访问
+	OnRandomAccess();
+	const auto skippedSizeFromStream = m_UnderlyingStream->Skip(n - skippedSize);
+	m_BufferBeginPosition += skippedSizeFromStream;
+	return skippedSize + skippedSizeFromStream;
+}
+
+std::span<const std::byte> ReadAheadInputStream::BorrowBytes(std::size_t maxSize)
+{
+	if (GetCurrentOffset() == m_ReadSize)
+	{
+		Refill();
+	}
+
+	return std::span(m_ReadWindowCurrent, std::min(maxSize, m_ReadSize - GetCurrentOffset()));
+}
+
+void ReadAheadInputStream::Consume(std::size_t n)
+{
+	if (n <= m_ReadSize - GetCurrentOffset())
+	{
+		m_ReadWindowCurrent += n;
+	}
+	else
+	{
+		Skip(n);
+	}
+}
+
+std::size_t ReadAheadInputStream::GetPosition() const
+{
+	CheckSeekable();
+	return m_BufferBeginPosition + GetCurrentOffset();
+}
+
+void ReadAheadInputStream::SeekFromBegin(std::size_t pos)
+{
+	CheckSeekable();
+
+	if (m_BufferBeginPosition <= pos && pos <= m_BufferBeginPosition + m_ReadSize)
+	{
+		UpdateReadWindow(pos - m_BufferBeginPosition);
+		return;
+	}
+
+	if (m_Prefetching)
+	{
+		std::exception_ptr exception;
+		const auto prefetchedSize = TakePrefetch(exception);
+		const auto prefetchBeginPosition = m_BufferBeginPosition + m_ReadSize;
+		if (!exception && prefetchBeginPosition <= pos &&
+		    pos < prefetchBeginPosition + prefetchedSize)
+		{
+			// 向后跳转到已预读的缓存中，仍视为顺序访问
+			std::swap(m_Buffer, m_PrefetchBuffer);
+			m_BufferBeginPosition = prefetchBeginPosition;
+			m_ReadSize = prefetchedSize;
+			UpdateReadWindow(pos - prefetchBeginPosition);
+			return;
+		}
+	}
+
+	m_SeekableUnderlyingStream->SeekFromBegin(pos);
+	m_BufferBeginPosition = pos;
+	m_ReadSize = 0;
+	UpdateReadWindow(0);
+	OnRandomAccess();
+}
+
+void ReadAheadInputStream::Seek(SeekOrigin origin, std::ptrdiff_t diff)
+{
+	CheckSeekable();
+
+	switch (origin)
+	{
+	default:
+		assert(!"Invalid origin.");
+		[[fallthrough]];
+	case SeekOrigin::Begin:
+		if (diff < 0)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+		}
+		SeekFromBegin(static_cast<std::size_t>(diff));
+		break;
+	case SeekOrigin::Current:
+	{
+		const auto position = GetPosition();
+		if (diff < 0 && static_cast<std::size_t>(-diff) > position)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+		}
+		SeekFromBegin(position + diff);
+		break;
+	}
+	case SeekOrigin::End:
+		if (HasCapability(m_UnderlyingCapabilities, StreamCapability::KnownSize))
+		{
+			const auto totalSize = GetTotalSize();
+			if (diff > 0 || static_cast<std::size_t>(-diff) > totalSize)
+			{
+				CAFE_THROW(IoException, CAFE_UTF8_SV("Out of range."));
+			}
+			SeekFromBegin(totalSize + diff);
+		}
+		else
+		{
+			if (m_Prefetching)
+			{
+				std::exception_ptr exception;
+				TakePrefetch(exception);
+			}
+
+			m_SeekableUnderlyingStream->Seek(origin, diff);
+			m_BufferBeginPosition = m_SeekableUnderlyingStream->GetPosition();
+			m_ReadSize = 0;
+			UpdateReadWindow(0);
+			OnRandomAccess();
+		}
+		break;
+	}
+}
+
+std::size_t ReadAheadInputStream::GetTotalSize()
+{
+	CheckSeekable();
+	WaitPrefetchCompleted();
+	return m_SeekableUnderlyingStream->GetTotalSize();
+}
+
+std::size_t ReadAheadInputStream::ReadAt(std::size_t offset, std::span<std::byte> const& buffer)
+{
+	CheckSeekable();
+	WaitPrefetchCompleted();
+	return m_SeekableUnderlyingStream->ReadAt(offset, buffer);
+}
+
+InputStream* ReadAheadInputStream::GetUnderlyingStream() const noexcept
+{
+	return m_UnderlyingStream;
+}
+
+std::size_t ReadAheadInputStream::GetWindowSize() const noexcept
+{
+	return m_WindowSize;
+}
+
+std::optional<std::byte> ReadAheadInputStream::Underflow()
+{
+	std::byte value;
+	if (!ReadBytesSlow(std::span(&value, 1)))
+	{
+		return {};
+	}
+
+	return value;
+}
+
+void ReadAheadInputStream::UpdateReadWindow(std::size_t currentOffset) noexcept
+{
+	assert(currentOffset <= m_ReadSize);
+	m_ReadWindowCurrent = m_Buffer + currentOffset;
+	m_ReadWindowEnd = m_Buffer + m_ReadSize;
+}
+
+void ReadAheadInputStream::CheckSeekable() const
+{
+	if (!m_SeekableUnderlyingStream)
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Underlying stream is not seekable."));
+	}
+}
+
+bool ReadAheadInputStream::Refill()
+{
+	// 用户读完了一块非空的缓存，视为一次顺序访问
+	if (m_ReadSize)
+	{
+		++m_SequentialCount;
+		m_WindowSize = std::min(m_WindowSize * 2, m_MaxWindowSize);
+	}
+
+	m_BufferBeginPosition += m_ReadSize;
+	m_ReadSize = 0;
+	UpdateReadWindow(0);
+
+	std::size_t requestSize;
+	if (m_Prefetching)
+	{
+		std::exception_ptr exception;
+		const auto prefetchedSize = TakePrefetch(exception);
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+
+		std::swap(m_Buffer, m_PrefetchBuffer);
+		m_ReadSize = prefetchedSize;
+		requestSize = m_PrefetchRequestSize;
+	}
+	else
+	{
+		requestSize = m_WindowSize;
+		m_ReadSize = m_UnderlyingStream->ReadBytes(std::span(m_Buffer, requestSize));
+	}
+	UpdateReadWindow(0);
+
+	// 仅在顺序访问且流未到结尾时预读
+	if (m_SequentialCount && m_ReadSize == requestSize)
+	{
+		StartPrefetch();
+	}
+
+	return m_ReadSize != 0;
+}
+
+void ReadAheadInputStream::StartPrefetch()
+{
+	assert(!m_Prefetching);
+
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_PrefetchRequestSize = m_WindowSize;
+		m_PrefetchState = PrefetchState::Requested;
+	}
+	m_Condition.notify_all();
+	m_Prefetching = true;
+}
+
+void ReadAheadInputStream::WaitPrefetchCompleted()
+{
+	if (!m_Prefetching)
+	{
+		return;
+	}
+
+	std::unique_lock lock{ m_Mutex };
+	m_Condition.wait(lock, [this] { return m_PrefetchState == PrefetchState::Completed; });
+}
+
+std::size_t ReadAheadInputStream::TakePrefetch(std::exception_ptr& exception)
+{
+	assert(m_Prefetching);
+
+	std::unique_lock lock{ m_Mutex };
+	m_Condition.wait(lock, [this] { return m_PrefetchState == PrefetchState::Completed; });
+	m_PrefetchState = PrefetchState::Idle;
+	m_Prefetching = false;
+	exception = std::exchange(m_PrefetchException, nullptr);
+	return m_PrefetchReadSize;
+}
+
+void ReadAheadInputStream::OnRandomAccess() noexcept
+{
+	m_SequentialCount = 0;
+	m_WindowSize = std::max(m_WindowSize / 2, m_MinWindowSize);
+}
+
+void ReadAheadInputStream::WorkerMain()
+{
+	std::unique_lock lock{ m_Mutex };
+	while (true)
+	{
+		m_Condition.wait(lock, [this] {
+			return m_Stopping || m_PrefetchState == PrefetchState::Requested;
+		});
+
+		if (m_Stopping)
+		{
+			return;
+		}
+
+		const auto buffer = std::span(m_PrefetchBuffer, m_PrefetchRequestSize);
+		lock.unlock();
+
+		std::size_t readSize = 0;
+		std::exception_ptr exception;
+		try
+		{
+			readSize = m_UnderlyingStream->ReadBytes(buffer);
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		lock.lock();
+		m_PrefetchReadSize = readSize;
+		m_PrefetchException = exception;
+		m_PrefetchState = PrefetchState::Completed;
+		m_Condition.notify_all();
+	}
+}
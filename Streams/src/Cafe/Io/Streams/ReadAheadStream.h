@@ -0,0 +1,162 @@
+#pragma once
+
+#include "StreamBase.h"
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Cafe::Io
+{
+	/// @brief  预读输入流
+	/// @remark 与 BufferedInputStream 类似，但使用两块缓存：用户读取其中一块时，后台线程从包装流读取下一块，
+	///         使计算与 IO 重叠，适用于顺序扫描网络挂载或冷数据文件等单次读取延迟较高的场景
+	///         根据访问模式调整预读窗口：每读完一块缓存视为一次顺序访问，窗口加倍直到最大值；
+	///         跳转到缓存以外的位置视为随机访问，窗口减半直到最小值，且在下一次顺序访问前不再预读
+	///         预读时后台线程以 ReadBytes 读满窗口，对管道等不可寻位的流可能长时间阻塞后台线程
+	///         本类不会取得包装流的所有权，在本类管理期间不应在外部操作包装流，否则可能导致错误
+	///         后台线程引用本对象，因此本类不可移动
+	class CAFE_PUBLIC ReadAheadInputStream final : public SeekableStream<InputStream>
+	{
+	public:
+		static constexpr std::size_t DefaultMinWindowSize = 4 * 1024;
+		static constexpr std::size_t DefaultInitialWindowSize = 64 * 1024;
+		static constexpr std::size_t DefaultMaxWindowSize = 1024 * 1024;
+
+		/// @param  stream              包装流
+		/// @param  initialWindowSize   初始的预读窗口大小
+		/// @param  minWindowSize       预读窗口的最小值
+		/// @param  maxWindowSize       预读窗口的最大值，同时也是每块缓存的大小
+		explicit ReadAheadInputStream(InputStream* stream,
+		                              std::size_t initialWindowSize = DefaultInitialWindowSize,
+		                              std::size_t minWindowSize = DefaultMinWindowSize,
+		                              std::size_t maxWindowSize = DefaultMaxWindowSize);
+
+		ReadAheadInputStream(ReadAheadInputStream const&) = delete;
+		ReadAheadInputStream& operator=(ReadAheadInputStream const&) = delete;
+
+		~ReadAheadInputStream();
+
+		/// @remark 将等待进行中的预读完成并结束后台线程
+		///         若包装流是可寻位的将会设为用户当前读取的位置，并释放缓存
+		///         之后流处于无效状态，不可进行除析构以外的任何操作
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Borrow 及包装流的寻位相关能力
+		StreamCapability GetCapabilities() const override;
+
+		/// @remark 预读进行中时不访问包装流，仅包含当前缓存中剩余的字节数及已完成的预读
+		std::size_t GetAvailableBytes() override;
+
+		/// @remark 缓存中的数据足够时将内联完成
+		std::size_t ReadBytes(std::span<std::byte> const& buffer) override
+		{
+			if (buffer.size() < static_cast<std::size_t>(m_ReadWindowEnd - m_ReadWindowCurrent))
+			    [[likely]]
+			{
+				std::memcpy(buffer.data(), m_ReadWindowCurrent, buffer.size());
+				m_ReadWindowCurrent += buffer.size();
+				return buffer.size();
+			}
+
+			return ReadBytesSlow(buffer);
+		}
+
+		std::size_t Skip(std::size_t n) override;
+
+		/// @remark 借出缓存中的数据，缓存为空时将先切换到下一块缓存
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+		std::size_t GetPosition() const override;
+		/// @remark 目标位置位于当前缓存或已预读的缓存中时不会操作包装流
+		void SeekFromBegin(std::size_t pos) override;
+		void Seek(SeekOrigin origin, std::ptrdiff_t diff) override;
+		std::size_t GetTotalSize() override;
+
+		/// @remark 等待进行中的预读完成后转发到包装流，不经过也不影响缓存
+		std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer) override;
+
+		InputStream* GetUnderlyingStream() const noexcept;
+
+		/// @brief  获得当前的预读窗口大小
+		std::size_t GetWindowSize() const noexcept;
+
+	private:
+		enum class PrefetchState
+		{
+			Idle,
+			Requested,
+			Completed
+		};
+
+		InputStream* m_UnderlyingStream;
+		// 仅在包装流具有 StreamCapability::Seekable 时非空
+		SeekableStream<InputStream>* m_SeekableUnderlyingStream;
+		StreamCapability m_UnderlyingCapabilities;
+
+		std::size_t m_MinWindowSize;
+		std::size_t m_MaxWindowSize;
+		std::size_t m_WindowSize;
+		// 自上次随机访问以来连续顺序读完的缓存块数
+		std::size_t m_SequentialCount;
+
+		std::unique_ptr<std::byte[]> m_Storage;
+		// 用户当前读取的缓存
+		// 其中 [0, m_ReadSize) 为有效的数据，当前位置由读取窗口的起始 m_ReadWindowCurrent 表示
+		std::byte* m_Buffer;
+		std::size_t m_ReadSize;
+		// m_Buffer 开头对应的位置，仅在包装流可寻位时有意义
+		std::size_t m_BufferBeginPosition;
+
+		// 后台线程读取的缓存，在预读进行中时仅由后台线程访问
+		std::byte* m_PrefetchBuffer;
+		// 是否已发起尚未取回结果的预读，仅由用户线程访问
+		bool m_Prefetching;
+		// 以下成员由 m_Mutex 保护
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		PrefetchState m_PrefetchState;
+		std::size_t m_PrefetchRequestSize;
+		std::size_t m_PrefetchReadSize;
+		std::exception_ptr m_PrefetchException;
+		bool m_Stopping;
+
+		std::thread m_Worker;
+
+		/// @remark 经过 ReadBytesSlow 读取，以便在缓存读完时切换到下一块缓存
+		std::optional<std::byte> Underflow() override;
+
+		std::size_t ReadBytesSlow(std::span<std::byte> const& buffer);
+
+		/// @brief  获得当前位置在 m_Buffer 中的偏移
+		std::size_t GetCurrentOffset() const noexcept
+		{
+			return static_cast<std::size_t>(m_ReadWindowCurrent - m_Buffer);
+		}
+
+		/// @brief  将当前位置设为 m_Buffer 中的 currentOffset，并按 m_ReadSize 更新读取窗口
+		/// @remark 切换缓存或改变 m_ReadSize 后均需调用
+		void UpdateReadWindow(std::size_t currentOffset) noexcept;
+
+		void CheckSeekable() const;
+
+		/// @brief  切换到下一块缓存，若无进行中的预读则同步读取
+		/// @return 是否读取到了数据，为 false 表示流已到结尾
+		bool Refill();
+
+		void StartPrefetch();
+
+		/// @brief  若有进行中的预读则等待其完成，但不取回结果，用于访问包装流之前
+		void WaitPrefetchCompleted();
+
+		/// @brief  等待进行中的预读完成并取回结果
+		/// @return 读取的字节数，若预读失败则返回 0 且 exception 被设置
+		std::size_t TakePrefetch(std::exception_ptr& exception);
+
+		void OnRandomAccess() noexcept;
+		void WorkerMain();
+	};
+} // namespace Cafe::Io
@@ -5,7 +5,7 @@
 
 namespace Cafe::Io
 {
-	class CAFE_PUBLIC StlInputStream : public SeekableStream<InputStream>
+	class CAFE_PUBLIC StlInputStream final : public SeekableStream<InputStream>
 	{
 	public:
 		explicit StlInputStream(std::istream& stream) noexcept;
@@ -26,7 +26,7 @@ namespace Cafe::Io
 		std::istream& m_Stream;
 	};
 
-	class CAFE_PUBLIC StlOutputStream : public SeekableStream<OutputStream>
+	class CAFE_PUBLIC StlOutputStream final : public SeekableStream<OutputStream>
 	{
 	public:
 		explicit StlOutputStream(std::ostream& stream) noexcept;
@@ -45,7 +45,7 @@ namespace Cafe::Io
 		std::ostream& m_Stream;
 	};
 
-	class CAFE_PUBLIC StlInputOutputStream : public SeekableStream<InputOutputStream>
+	class CAFE_PUBLIC StlInputOutputStream final : public SeekableStream<InputOutputStream>
 	{
 	public:
 		explicit StlInputOutputStream(std::iostream& stream) noexcept;
@@ -1,10 +1,13 @@
 #include <Cafe/Io/Streams/StreamBase.h>
+#include <memory>
 
 using namespace Cafe::Io;
 
 namespace
 {
 	constexpr std::size_t DefaultSkipBufferSize = 1024;
+	// 直接读取到目标流存储或经过中间缓存复制时单次请求的长度
+	constexpr std::size_t DefaultCopyChunkSize = 64 * 1024;
 }
 
 Stream::~Stream()
@@ -15,11 +18,16 @@ void Stream::Close()
 {
 }
 
+StreamCapability Stream::GetCapabilities() const
+{
+	return StreamCapability::None;
+}
+
 InputStream::~InputStream()
 {
 }
 
-std::optional<std::byte> InputStream::ReadByte()
+std::optional<std::byte> InputStream::Underflow()
 {
 	std::byte value;
 	if (!ReadBytes(std::span(&value, 1)))
@@ -30,6 +38,22 @@ std::optional<std::byte> InputStream::ReadByte()
 	return value;
 }
 
+std::size_t InputStream::ReadBytesVectored(std::span<const std::span<std::byte>> const& buffers)
+{
+	std::size_t totalReadSize = 0;
+	for (const auto& buffer : buffers)
+	{
+		const auto readSize = ReadBytes(buffer);
+		totalReadSize += readSize;
+		if (readSize != buffer.size())
+		{
+			break;
+		}
+	}
+
+	return totalReadSize;
+}
+
 std::size_t InputStream::ReadAvailableBytes(std::span<std::byte> const& buffer)
 {
 	const auto availableSize = GetAvailableBytes();
@@ -61,19 +85,136 @@ std::size_t InputStream::Skip(std::size_t n)
 	return n - remainedBytes;
 }
 
+std::span<const std::byte> InputStream::BorrowBytes(std::size_t /*maxSize*/)
+{
+	return {};
+}
+
+void InputStream::Consume(std::size_t n)
+{
+	Skip(n);
+}
+
+std::size_t InputStream::CopyTo(OutputStream& stream, std::size_t size)
+{
+	// 中间缓存仅在两个流都不支持直接访问存储时才需要，因此延迟分配
+	std::unique_ptr<std::byte[]> buffer;
+	std::size_t copiedSize = 0;
+	while (copiedSize < size)
+	{
+		const auto remainedSize = size - copiedSize;
+
+		if (const auto borrowedBytes = BorrowBytes(remainedSize); !borrowedBytes.empty())
+		{
+			// 仅消费已写出的部分，未写出的部分仍保留在本流中
+			const auto writtenSize = stream.WriteBytes(borrowedBytes);
+			Consume(writtenSize);
+			copiedSize += writtenSize;
+			if (writtenSize < borrowedBytes.size())
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		if (const auto acquiredBuffer =
+		        stream.AcquireWriteBuffer(std::min(remainedSize, DefaultCopyChunkSize));
+		    !acquiredBuffer.empty())
+		{
+			const auto readSize = ReadBytes(acquiredBuffer);
+			stream.Commit(readSize);
+			if (!readSize)
+			{
+				break;
+			}
+
+			copiedSize += readSize;
+			continue;
+		}
+
+		const auto bufferSize = std::min(size, DefaultCopyChunkSize);
+		if (!buffer)
+		{
+			buffer = std::make_unique_for_overwrite<std::byte[]>(bufferSize);
+		}
+
+		const auto readSize =
+		    ReadBytes(std::span(buffer.get(), std::min(bufferSize, remainedSize)));
+		if (!readSize)
+		{
+			break;
+		}
+
+		// 数据已从本流读出，需要全部写出，stream 无法继续写入时剩余的数据将丢失
+		std::size_t writtenSize = 0;
+		while (writtenSize < readSize)
+		{
+			const auto currentWrittenSize =
+			    stream.WriteBytes(std::span(buffer.get() + writtenSize, readSize - writtenSize));
+			if (!currentWrittenSize)
+			{
+				break;
+			}
+
+			writtenSize += currentWrittenSize;
+		}
+
+		copiedSize += writtenSize;
+		if (writtenSize < readSize)
+		{
+			break;
+		}
+	}
+
+	return copiedSize;
+}
+
 OutputStream::~OutputStream()
 {
 }
 
-bool OutputStream::WriteByte(std::byte value)
+bool OutputStream::Overflow(std::byte value)
 {
 	return WriteBytes(std::span(&value, 1));
 }
 
+std::size_t
+OutputStream::WriteBytesVectored(std::span<const std::span<const std::byte>> const& buffers)
+{
+	std::size_t totalWrittenSize = 0;
+	for (const auto& buffer : buffers)
+	{
+		const auto writtenSize = WriteBytes(buffer);
+		totalWrittenSize += writtenSize;
+		if (writtenSize != buffer.size())
+		{
+			break;
+		}
+	}
+
+	return totalWrittenSize;
+}
+
+std::span<std::byte> OutputStream::AcquireWriteBuffer(std::size_t /*size*/)
+{
+	return {};
+}
+
+void OutputStream::Commit([[maybe_unused]] std::size_t n)
+{
+	assert(!n && "No buffer has been acquired.");
+}
+
 void OutputStream::Flush()
 {
 }
 
+void OutputStream::Sync(DurabilityLevel /*level*/)
+{
+	Flush();
+}
+
 InputOutputStream::~InputOutputStream()
 {
 }
@@ -112,6 +253,11 @@ SeekableStream<InputStream>::~SeekableStream()
 {
 }
 
+StreamCapability SeekableStream<InputStream>::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize;
+}
+
 std::size_t SeekableStream<InputStream>::Skip(std::size_t n)
 {
 	const auto skippingBytes = std::min(n, GetAvailableBytes());
@@ -133,10 +279,46 @@ std::size_t SeekableStream<InputStream>::Skip(std::size_t n)
 	return skippingBytes;
 }
 
+std::size_t SeekableStream<InputStream>::ReadAt(std::size_t offset,
+                                                std::span<std::byte> const& buffer)
+{
+	const auto curPos = GetPosition();
+	CAFE_SCOPE_EXIT
+	{
+		SeekFromBegin(curPos);
+	};
+
+	SeekFromBegin(offset);
+	return ReadBytes(buffer);
+}
+
 SeekableStream<OutputStream>::~SeekableStream()
 {
 }
 
+StreamCapability SeekableStream<OutputStream>::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize;
+}
+
+std::size_t SeekableStream<OutputStream>::WriteAt(std::size_t offset,
+                                                  std::span<const std::byte> const& buffer)
+{
+	const auto curPos = GetPosition();
+	CAFE_SCOPE_EXIT
+	{
+		SeekFromBegin(curPos);
+	};
+
+	SeekFromBegin(offset);
+	return WriteBytes(buffer);
+}
+
 SeekableStream<InputOutputStream>::~SeekableStream()
 {
 }
+
+StreamCapability SeekableStream<InputOutputStream>::GetCapabilities() const
+{
+	return StreamCapability::Seekable | StreamCapability::KnownSize;
+}
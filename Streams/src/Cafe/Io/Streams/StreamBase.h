@@ -3,7 +3,9 @@
 #include <Cafe/ErrorHandling/CommonExceptions.h>
 #include <Cafe/ErrorHandling/ErrorHandling.h>
 #include <Cafe/Misc/Scope.h>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <span>
 
@@ -11,6 +13,69 @@ namespace Cafe::Io
 {
 	CAFE_DEFINE_GENERAL_EXCEPTION(IoException, ErrorHandling::SystemException);
 
+	struct OutputStream;
+
+	/// @brief  流的能力，可按位组合
+	/// @remark 用于在运行时查询流实际支持的操作，例如以管道构造的 FileInputStream 在类型上是
+	///         可寻位流，但实际并不支持寻位
+	enum class StreamCapability : std::uint32_t
+	{
+		None = 0,
+
+		/// @brief  支持 SeekableStream 的寻位及获取位置操作
+		Seekable = 1 << 0,
+		/// @brief  支持 SeekableStream::GetTotalSize
+		KnownSize = 1 << 1,
+		/// @brief  ReadAt 及 WriteAt 不依赖当前位置，可由多个线程同时调用
+		PositionalIo = 1 << 2,
+		/// @brief  BorrowBytes 或 AcquireWriteBuffer 可直接提供流内部的存储
+		Borrow = 1 << 3,
+		/// @brief  流基于非阻塞的文件描述符
+		NonBlocking = 1 << 4,
+	};
+
+	constexpr StreamCapability operator|(StreamCapability a, StreamCapability b) noexcept
+	{
+		return static_cast<StreamCapability>(static_cast<std::uint32_t>(a) |
+		                                     static_cast<std::uint32_t>(b));
+	}
+
+	constexpr StreamCapability operator&(StreamCapability a, StreamCapability b) noexcept
+	{
+		return static_cast<StreamCapability>(static_cast<std::uint32_t>(a) &
+		                                     static_cast<std::uint32_t>(b));
+	}
+
+	constexpr StreamCapability operator~(StreamCapability a) noexcept
+	{
+		return static_cast<StreamCapability>(~static_cast<std::uint32_t>(a));
+	}
+
+	constexpr StreamCapability& operator|=(StreamCapability& a, StreamCapability b) noexcept
+	{
+		return a = a | b;
+	}
+
+	/// @brief  判断 capabilities 是否包含 capability 中的全部能力
+	constexpr bool HasCapability(StreamCapability capabilities,
+	                             StreamCapability capability) noexcept
+	{
+		return (capabilities & capability) == capability;
+	}
+
+	/// @brief  写入的数据的持久化程度，程度依次增强
+	enum class DurabilityLevel
+	{
+		/// @brief  仅将数据交给系统（如写入页缓存），不保证写入存储设备
+		None,
+		/// @brief  发起数据的异步写回但不等待完成，不保证写入存储设备
+		WriteBack,
+		/// @brief  等待数据及读取数据必需的元数据（如文件长度）写入存储设备
+		Data,
+		/// @brief  等待数据及全部元数据写入存储设备
+		Full
+	};
+
 	/// @brief  流
 	struct CAFE_PUBLIC Stream
 	{
@@ -20,6 +85,11 @@ namespace Cafe::Io
 		/// @note   流可能不需要或难以实现关闭操作等，此时本方法可能为空操作
 		/// @remark 流关闭后可能处于任何状态，除非另有说明否则不可再进行除析构以外的操作
 		virtual void Close();
+
+		/// @brief  获得流实际支持的能力
+		/// @remark 结果在流的生存期内不应改变，包装流可在构造时查询一次并缓存
+		///         默认实现返回 StreamCapability::None
+		virtual StreamCapability GetCapabilities() const;
 	};
 
 	/// @brief  输入流
@@ -33,13 +103,29 @@ namespace Cafe::Io
 		virtual std::size_t GetAvailableBytes() = 0;
 
 		/// @brief  从流中读取一个字节
-		virtual std::optional<std::byte> ReadByte();
+		/// @remark 读取窗口非空时直接从中读取，不进行虚函数调用，否则调用 Underflow
+		std::optional<std::byte> ReadByte()
+		{
+			if (m_ReadWindowCurrent != m_ReadWindowEnd) [[likely]]
+			{
+				return *m_ReadWindowCurrent++;
+			}
+
+			return Underflow();
+		}
 
 		/// @brief  从流中读取多个字节，读取的个数为 buffer 的大小
 		/// @remark 若读取长度大于可用字节数，则阻塞到读取到足够字节数再返回
 		/// @return 读取的长度，若为 0 则表示流已到结尾或 buffer 大小为 0，其他异常情况将会抛出
 		virtual std::size_t ReadBytes(std::span<std::byte> const& buffer) = 0;
 
+		/// @brief  从流中分散读取多个字节，依次填充 buffers 中的每个缓存
+		/// @remark 与 ReadBytes 名称不同的原因同 SeekableStream<Stream>::SeekFromBegin
+		///         默认实现对每个缓存依次调用 ReadBytes，某次读取长度不足时停止
+		/// @return 读取的总长度
+		virtual std::size_t
+		ReadBytesVectored(std::span<const std::span<std::byte>> const& buffers);
+
 		/// @brief  从流中读取有效字节，读取的个数最多不超过 buffer 的大小
 		/// @remark 本方法不会阻塞，若有效字节数不足够填充整个 buffer 则只会填充已有的部分
 		///         当 InputStream::GetAvailableBytes() 无效时，本方法立即返回且不读取任何内容
@@ -48,6 +134,38 @@ namespace Cafe::Io
 		/// @brief  跳过 n 个字节
 		/// @remark 可能阻塞并消费字节，若可能则推荐使用 SeekableStream::Seek
 		virtual std::size_t Skip(std::size_t n);
+
+		/// @brief  借出流内部存储中可直接读取的数据，不进行复制也不消费
+		/// @param  maxSize 借出的最大长度
+		/// @remark 返回的 span 仅在下一次对流进行除 Consume 以外的操作前有效
+		///         返回空 span 表示流不支持借出或已到结尾，此时应使用 ReadBytes 读取
+		///         默认实现不支持借出
+		virtual std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1));
+
+		/// @brief  消费 n 个字节，通常用于消费 BorrowBytes 借出的数据
+		/// @remark 若之前调用过 BorrowBytes，n 不应超过借出的长度
+		///         默认实现调用 Skip
+		virtual void Consume(std::size_t n);
+
+		/// @brief  从本流读取至多 size 个字节并写入到 stream
+		/// @remark 默认实现在本流支持 BorrowBytes 时直接从本流存储写出，否则在 stream 支持
+		///         AcquireWriteBuffer 时直接读取到 stream 的存储，都不支持时经过中间缓存复制
+		///         子类可根据 stream 的具体类型覆盖本方法以使用更快的方式
+		///         stream 无法写入全部数据时停止复制，经过中间缓存复制时已读出但未写出的数据将丢失
+		/// @return 写入到 stream 的字节数，若小于 size 则表示本流已到结尾或 stream 无法继续写入
+		virtual std::size_t CopyTo(OutputStream& stream, std::size_t size = std::size_t(-1));
+
+	protected:
+		/// @brief  读取窗口，为流内部存储中紧接当前位置的可读数据 [m_ReadWindowCurrent, m_ReadWindowEnd)
+		/// @remark ReadByte 从窗口中读取时仅前移 m_ReadWindowCurrent，因此提供窗口的子类应以
+		///         m_ReadWindowCurrent 作为自身的当前位置，并在存储或可读范围改变时更新窗口
+		///         默认为空窗口，此时每次 ReadByte 都将调用 Underflow
+		const std::byte* m_ReadWindowCurrent = nullptr;
+		const std::byte* m_ReadWindowEnd = nullptr;
+
+		/// @brief  读取窗口为空时由 ReadByte 调用，读取一个字节
+		/// @remark 默认实现以长度为 1 的缓存调用 ReadBytes，子类可覆盖以在填充存储后更新窗口
+		virtual std::optional<std::byte> Underflow();
 	};
 
 	/// @brief  输出流
@@ -56,14 +174,59 @@ namespace Cafe::Io
 		virtual ~OutputStream();
 
 		/// @brief  写入一个字节到流内
-		virtual bool WriteByte(std::byte value);
+		/// @remark 写入窗口非空时直接写入其中，不进行虚函数调用，否则调用 Overflow
+		bool WriteByte(std::byte value)
+		{
+			if (m_WriteWindowCurrent != m_WriteWindowEnd) [[likely]]
+			{
+				*m_WriteWindowCurrent++ = value;
+				return true;
+			}
+
+			return Overflow(value);
+		}
 
 		/// @brief  写入多个字节到流内，buffer 内全部数据都将写出，并阻塞到写入完成为止
 		/// @return 写入的字节数，仅供参考，对于特殊的流可能无意义或有其他特殊含义
 		virtual std::size_t WriteBytes(std::span<const std::byte> const& buffer) = 0;
 
+		/// @brief  将 buffers 中的每个缓存依次写入到流内，全部数据都将写出
+		/// @remark 与 WriteBytes 名称不同的原因同 SeekableStream<Stream>::SeekFromBegin
+		///         默认实现对每个缓存依次调用 WriteBytes，某次写入未写满时即停止
+		/// @return 写入的总字节数，意义同 WriteBytes，小于总长度时表示仅写出了前面的部分
+		virtual std::size_t
+		WriteBytesVectored(std::span<const std::span<const std::byte>> const& buffers);
+
+		/// @brief  获得流内部可直接写入的存储，写入后需调用 Commit 提交
+		/// @param  size    期望的长度
+		/// @remark 返回的 span 可能短于 size，仅在下一次对流进行除 Commit 以外的操作前有效
+		///         返回空 span 表示流不支持或无可用存储，此时应使用 WriteBytes 写入
+		///         默认实现不支持获得存储
+		virtual std::span<std::byte> AcquireWriteBuffer(std::size_t size);
+
+		/// @brief  提交由 AcquireWriteBuffer 获得的存储的前 n 个字节
+		/// @remark 每次成功的 AcquireWriteBuffer 后必须调用一次本方法，n 可为 0
+		virtual void Commit(std::size_t n);
+
 		/// @brief  刷新流，确保数据成功刷新，对于无缓存的流可能无操作
+		/// @remark 是否同时持久化数据由具体的流决定，需要确定的持久化程度时应使用 Sync
 		virtual void Flush();
+
+		/// @brief  刷新流并使已写入的数据达到 level 指定的持久化程度
+		/// @remark 默认实现调用 Flush，包装流应在写出自身的缓存后将 level 转发给包装流
+		virtual void Sync(DurabilityLevel level = DurabilityLevel::Full);
+
+	protected:
+		/// @brief  写入窗口，为流内部存储中紧接当前位置的可写空间 [m_WriteWindowCurrent, m_WriteWindowEnd)
+		/// @remark WriteByte 写入窗口时仅前移 m_WriteWindowCurrent，因此提供窗口的子类应以
+		///         m_WriteWindowCurrent 作为自身的当前位置，并在存储或可写范围改变时更新窗口
+		///         默认为空窗口，此时每次 WriteByte 都将调用 Overflow
+		std::byte* m_WriteWindowCurrent = nullptr;
+		std::byte* m_WriteWindowEnd = nullptr;
+
+		/// @brief  写入窗口为空时由 WriteByte 调用，写入一个字节
+		/// @remark 默认实现以长度为 1 的缓存调用 WriteBytes，子类可覆盖以在写出存储后更新窗口
+		virtual bool Overflow(std::byte value);
 	};
 
 	struct CAFE_PUBLIC InputOutputStream : virtual InputStream, virtual OutputStream
@@ -110,7 +273,17 @@ namespace Cafe::Io
 	{
 		virtual ~SeekableStream();
 
+		/// @remark 默认实现返回 StreamCapability::Seekable | StreamCapability::KnownSize
+		StreamCapability GetCapabilities() const override;
+
 		std::size_t Skip(std::size_t n) override;
+
+		/// @brief  从 offset 处读取多个字节，读取的个数最多为 buffer 的大小
+		/// @remark 不依赖也不改变流的当前位置
+		///         默认实现借助 Seek 完成，会暂时改变当前位置，因此不可与其他操作并发
+		///         子类若能以无游标的方式实现则可由多个线程同时调用，具体见子类说明
+		/// @return 读取的长度，若小于 buffer 的大小则表示已到结尾
+		virtual std::size_t ReadAt(std::size_t offset, std::span<std::byte> const& buffer);
 	};
 
 	template <>
@@ -118,6 +291,16 @@ namespace Cafe::Io
 	                                                  virtual SeekableStream<Stream>
 	{
 		virtual ~SeekableStream();
+
+		/// @remark 默认实现返回 StreamCapability::Seekable | StreamCapability::KnownSize
+		StreamCapability GetCapabilities() const override;
+
+		/// @brief  向 offset 处写入 buffer 内的全部数据
+		/// @remark 不依赖也不改变流的当前位置
+		///         默认实现借助 Seek 完成，会暂时改变当前位置，因此不可与其他操作并发
+		///         子类若能以无游标的方式实现则可由多个线程同时调用，具体见子类说明
+		/// @return 写入的字节数，意义同 OutputStream::WriteBytes
+		virtual std::size_t WriteAt(std::size_t offset, std::span<const std::byte> const& buffer);
 	};
 
 	template <>
@@ -125,6 +308,8 @@ namespace Cafe::Io
 	    : SeekableStream<InputStream>, SeekableStream<OutputStream>, InputOutputStream
 	{
 		virtual ~SeekableStream();
+
+		StreamCapability GetCapabilities() const override;
 	};
 
 	template <typename T>
@@ -138,4 +323,23 @@ namespace Cafe::Io
 
 	template <typename T>
 	concept SeekableStreamConcept = std::is_base_of_v<SeekableStream<Stream>, T>;
+
+	/// @brief  静态输入流接口，仅要求具有与 InputStream 相同签名的读取方法，不要求继承
+	/// @remark 用于以模板参数接受流的场合，搭配 final 的具体流类型使用时调用可被去虚化并内联
+	template <typename T>
+	concept StaticInputStreamConcept = requires(T& stream, std::span<std::byte> const& buffer)
+	{
+		{ stream.ReadByte() } -> std::same_as<std::optional<std::byte>>;
+		{ stream.ReadBytes(buffer) } -> std::same_as<std::size_t>;
+	};
+
+	/// @brief  静态输出流接口，仅要求具有与 OutputStream 相同签名的写入方法，不要求继承
+	/// @see    StaticInputStreamConcept
+	template <typename T>
+	concept StaticOutputStreamConcept =
+	    requires(T& stream, std::byte value, std::span<const std::byte> const& buffer)
+	{
+		{ stream.WriteByte(value) } -> std::same_as<bool>;
+		{ stream.WriteBytes(buffer) } -> std::same_as<std::size_t>;
+	};
 } // namespace Cafe::Io
@@ -0,0 +1,356 @@
+#include <Cafe/ErrorHandling/ErrorHandling.h>
+#include <Cafe/Io/Streams/StreamQueue.h>
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+using namespace Cafe;
+using namespace Io;
+
+namespace
+{
+	constexpr std::size_t ClosedFlag = std::size_t(1)
+	                                   << (std::numeric_limits<std::size_t>::digits - 1);
+
+	// 每条记录以记录长度开头，并填充到其对齐，因此长度总不会跨越环形缓存的结尾
+	using RecordHeader = std::uint32_t;
+	constexpr std::size_t RecordAlignment = sizeof(RecordHeader);
+
+	constexpr std::size_t GetRecordSpaceSize(std::size_t payloadSize) noexcept
+	{
+		return sizeof(RecordHeader) +
+		       ((payloadSize + RecordAlignment - 1) & ~(RecordAlignment - 1));
+	}
+
+	/// @brief  等待 position 不含标志的部分变为 expected
+	void WaitPosition(std::atomic<std::size_t>& position, std::size_t expected) noexcept
+	{
+		auto current = position.load(std::memory_order_acquire);
+		while ((current & ~ClosedFlag) != expected)
+		{
+			position.wait(current, std::memory_order_acquire);
+			current = position.load(std::memory_order_acquire);
+		}
+	}
+} // namespace
+
+StreamQueue::StreamQueue(std::size_t capacity)
+    : m_Mask{ std::bit_ceil(std::max(capacity, RecordAlignment * 2)) - 1 },
+      m_ReservePosition{}, m_PublishPosition{}, m_ClaimPosition{}, m_FreePosition{}
+{
+	m_Storage = std::make_unique_for_overwrite<std::byte[]>(m_Mask + 1);
+}
+
+StreamQueue::~StreamQueue()
+{
+}
+
+void StreamQueue::Append(std::span<const std::byte> const& record)
+{
+	AppendVectored(std::span(&record, 1));
+}
+
+void StreamQueue::AppendVectored(std::span<const std::span<const std::byte>> const& parts)
+{
+	std::size_t payloadSize = 0;
+	for (const auto& part : parts)
+	{
+		payloadSize += part.size();
+	}
+
+	if (payloadSize > GetMaxRecordSize())
+	{
+		CAFE_THROW(IoException, CAFE_UTF8_SV("Record is too large."));
+	}
+
+	const auto spaceSize = GetRecordSpaceSize(payloadSize);
+	const auto capacity = m_Mask + 1;
+
+	// 预留空间
+	auto begin = m_ReservePosition.load(std::memory_order_relaxed);
+	while (true)
+	{
+		if (begin & ClosedFlag)
+		{
+			CAFE_THROW(IoException, CAFE_UTF8_SV("Queue has been closed."));
+		}
+
+		const auto freePosition = m_FreePosition.load(std::memory_order_acquire);
+		if (begin + spaceSize - (freePosition & ~ClosedFlag) > capacity)
+		{
+			// begin 可能已过时，此时释放位置可能已超过 begin，需重新获取后再判断是否已满
+			if (const auto current = m_ReservePosition.load(std::memory_order_relaxed);
+			    current != begin)
+			{
+				begin = current;
+				continue;
+			}
+
+			// 关闭时释放位置亦被改变以唤醒等待者，此时重新获取的预留位置必然带有关闭标志
+			m_FreePosition.wait(freePosition, std::memory_order_acquire);
+			begin = m_ReservePosition.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		if (m_ReservePosition.compare_exchange_weak(begin, begin + spaceSize,
+		                                            std::memory_order_relaxed))
+		{
+			break;
+		}
+	}
+
+	// 长度可能被读取器在认领前预读，因此以原子操作写入
+	std::atomic_ref{ GetRecordHeader(begin) }.store(static_cast<RecordHeader>(payloadSize),
+	                                                std::memory_order_relaxed);
+	CopyIn(begin + sizeof(RecordHeader), parts);
+
+	// 按预留的顺序发布，保持最高位的关闭标志不变
+	WaitPosition(m_PublishPosition, begin);
+	m_PublishPosition.fetch_add(spaceSize, std::memory_order_release);
+	m_PublishPosition.notify_all();
+}
+
+void StreamQueue::Close() noexcept
+{
+	m_ReservePosition.fetch_or(ClosedFlag, std::memory_order_relaxed);
+	// 改变发布位置的值以唤醒等待中的读取器，此后仍可能有已预留空间的生产者发布
+	m_PublishPosition.fetch_or(ClosedFlag, std::memory_order_release);
+	m_PublishPosition.notify_all();
+	// 改变释放位置的值以唤醒因缓存已满而等待的生产者
+	m_FreePosition.fetch_or(ClosedFlag, std::memory_order_release);
+	m_FreePosition.notify_all();
+}
+
+StreamQueueReader StreamQueue::CreateReader() noexcept
+{
+	return StreamQueueReader{ this };
+}
+
+std::size_t StreamQueue::GetMaxRecordSize() const noexcept
+{
+	return std::min(m_Mask + 1 - sizeof(RecordHeader),
+	                static_cast<std::size_t>(std::numeric_limits<RecordHeader>::max()));
+}
+
+std::uint32_t& StreamQueue::GetRecordHeader(std::size_t position) const noexcept
+{
+	assert(position % RecordAlignment == 0);
+	return *reinterpret_cast<RecordHeader*>(m_Storage.get() + (position & m_Mask));
+}
+
+void StreamQueue::CopyIn(std::size_t position,
+                         std::span<const std::span<const std::byte>> const& parts) noexcept
+{
+	// 过时的读取器可能将任意对齐的位置当作长度以原子操作读取，因此同样以原子操作逐个长度写入
+	RecordHeader word = 0;
+	std::size_t wordSize = 0;
+	for (const auto& part : parts)
+	{
+		auto data = part.data();
+		auto size = part.size();
+		while (size)
+		{
+			const auto copySize = std::min(size, sizeof(RecordHeader) - wordSize);
+			std::memcpy(reinterpret_cast<std::byte*>(&word) + wordSize, data, copySize);
+			wordSize += copySize;
+			data += copySize;
+			size -= copySize;
+
+			if (wordSize == sizeof(RecordHeader))
+			{
+				std::atomic_ref{ GetRecordHeader(position) }.store(word, std::memory_order_relaxed);
+				position += sizeof(RecordHeader);
+				word = 0;
+				wordSize = 0;
+			}
+		}
+	}
+
+	if (wordSize)
+	{
+		std::atomic_ref{ GetRecordHeader(position) }.store(word, std::memory_order_relaxed);
+	}
+}
+
+void StreamQueue::CopyOut(std::size_t position, std::byte* data, std::size_t size) const noexcept
+{
+	if (!size)
+	{
+		return;
+	}
+
+	const auto offset = position & m_Mask;
+	const auto firstSize = std::min(size, m_Mask + 1 - offset);
+	std::memcpy(data, m_Storage.get() + offset, firstSize);
+	std::memcpy(data + firstSize, m_Storage.get(), size - firstSize);
+}
+
+StreamQueueReader::StreamQueueReader(StreamQueue* queue) noexcept
+    : m_Queue{ queue }, m_RecordBegin{}, m_RecordEnd{}, m_Current{}, m_PayloadEnd{}
+{
+}
+
+StreamQueueReader::StreamQueueReader(StreamQueueReader&& other) noexcept
+    : m_Queue{ std::exchange(other.m_Queue, nullptr) }, m_RecordBegin{ other.m_RecordBegin },
+      m_RecordEnd{ std::exchange(other.m_RecordEnd, other.m_RecordBegin) },
+      m_Current{ other.m_Current }, m_PayloadEnd{ other.m_PayloadEnd }
+{
+}
+
+StreamQueueReader::~StreamQueueReader()
+{
+	StreamQueueReader::Close();
+}
+
+StreamQueueReader& StreamQueueReader::operator=(StreamQueueReader&& other) noexcept
+{
+	Close();
+
+	m_Queue = std::exchange(other.m_Queue, nullptr);
+	m_RecordBegin = other.m_RecordBegin;
+	m_RecordEnd = std::exchange(other.m_RecordEnd, other.m_RecordBegin);
+	m_Current = other.m_Current;
+	m_PayloadEnd = other.m_PayloadEnd;
+
+	return *this;
+}
+
+void StreamQueueReader::Close()
+{
+	if (m_Queue)
+	{
+		ReleaseRecord();
+		m_Queue = nullptr;
+	}
+}
+
+StreamCapability StreamQueueReader::GetCapabilities() const
+{
+	return StreamCapability::Borrow;
+}
+
+std::size_t StreamQueueReader::GetAvailableBytes()
+{
+	return GetRemainingRecordSize();
+}
+
+std::size_t StreamQueueReader::ReadBytes(std::span<std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	std::size_t readSize = 0;
+
+	while (readSize < bufferSize)
+	{
+		if (m_Current == m_PayloadEnd && !NextRecord())
+		{
+			break;
+		}
+
+		const auto size = std::min(m_PayloadEnd - m_Current, bufferSize - readSize);
+		m_Queue->CopyOut(m_Current, buffer.data() + readSize, size);
+		m_Current += size;
+		readSize += size;
+	}
+
+	// 读完时立即释放，避免阻塞之后的记录释放空间
+	if (m_Current == m_PayloadEnd)
+	{
+		ReleaseRecord();
+	}
+
+	return readSize;
+}
+
+std::span<const std::byte> StreamQueueReader::BorrowBytes(std::size_t maxSize)
+{
+	if (m_Current == m_PayloadEnd && !NextRecord())
+	{
+		return {};
+	}
+
+	const auto& queue = *m_Queue;
+	const auto offset = m_Current & queue.m_Mask;
+	return std::span(queue.m_Storage.get() + offset,
+	                 std::min({ m_PayloadEnd - m_Current, queue.m_Mask + 1 - offset, maxSize }));
+}
+
+void StreamQueueReader::Consume(std::size_t n)
+{
+	assert(n <= m_PayloadEnd - m_Current);
+	m_Current += n;
+	if (m_Current == m_PayloadEnd)
+	{
+		ReleaseRecord();
+	}
+}
+
+std::size_t StreamQueueReader::GetRemainingRecordSize() const noexcept
+{
+	return m_PayloadEnd - m_Current;
+}
+
+bool StreamQueueReader::NextRecord()
+{
+	auto& queue = *m_Queue;
+	while (true)
+	{
+		ReleaseRecord();
+
+		auto begin = queue.m_ClaimPosition.load(std::memory_order_relaxed);
+		while (true)
+		{
+			const auto publishPosition = queue.m_PublishPosition.load(std::memory_order_acquire);
+			if (begin == (publishPosition & ~ClosedFlag))
+			{
+				// 队列已关闭时仍需等待已预留空间的生产者发布
+				if ((publishPosition & ClosedFlag) &&
+				    (queue.m_ReservePosition.load(std::memory_order_relaxed) & ~ClosedFlag) == begin)
+				{
+					return false;
+				}
+
+				queue.m_PublishPosition.wait(publishPosition, std::memory_order_acquire);
+				begin = queue.m_ClaimPosition.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			// 读取的长度可能已被其他读取器认领后改写，此时认领将失败并重试
+			const auto header = std::atomic_ref{ queue.GetRecordHeader(begin) }.load(
+			    std::memory_order_relaxed);
+			const auto end = begin + GetRecordSpaceSize(header);
+			if (queue.m_ClaimPosition.compare_exchange_weak(begin, end, std::memory_order_relaxed))
+			{
+				m_RecordBegin = begin;
+				m_RecordEnd = end;
+				m_Current = begin + sizeof(RecordHeader);
+				m_PayloadEnd = m_Current + header;
+				break;
+			}
+		}
+
+		if (m_Current != m_PayloadEnd)
+		{
+			return true;
+		}
+	}
+}
+
+void StreamQueueReader::ReleaseRecord() noexcept
+{
+	if (m_RecordBegin == m_RecordEnd)
+	{
+		return;
+	}
+
+	// 按认领的顺序释放，保持最高位的关闭标志不变
+	auto& freePosition = m_Queue->m_FreePosition;
+	WaitPosition(freePosition, m_RecordBegin);
+	freePosition.fetch_add(m_RecordEnd - m_RecordBegin, std::memory_order_release);
+	freePosition.notify_all();
+
+	m_RecordBegin = m_RecordEnd;
+	m_Current = m_PayloadEnd;
+}
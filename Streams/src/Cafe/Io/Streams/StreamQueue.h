@@ -0,0 +1,131 @@
+#pragma once
+
+#include "StreamBase.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Cafe::Io
+{
+	class StreamQueueReader;
+
+	/// @brief  有界的多生产者多消费者记录队列
+	/// @remark 多个线程可同时以 Append 追加完整的记录，每条记录在队列中连续且不与其他记录交错，
+	///         由一个或多个 StreamQueueReader 以输入流的形式读出，每条记录只会被一个读取器读出
+	///         记录存放在固定大小的环形缓存中，缓存已满时追加的线程将等待读取器释放空间，缓存不会增长
+	///         追加及读取以原子操作预留空间及认领记录，不使用锁；为使空间按顺序发布及释放，
+	///         复制完成的线程可能短暂等待先于它预留或认领的线程完成复制
+	///         读取器引用本对象，因此本类不可移动，且需在所有读取器之后析构
+	class CAFE_PUBLIC StreamQueue
+	{
+	public:
+		static constexpr std::size_t DefaultCapacity = 1024 * 1024;
+
+		/// @param  capacity    环形缓存的大小，将向上取整为 2 的幂，每条记录额外占用至多 7 字节
+		explicit StreamQueue(std::size_t capacity = DefaultCapacity);
+
+		StreamQueue(StreamQueue const&) = delete;
+		StreamQueue& operator=(StreamQueue const&) = delete;
+
+		~StreamQueue();
+
+		/// @brief  追加一条记录，可由多个线程同时调用
+		/// @remark 缓存空间不足时阻塞到读取器释放空间
+		/// @throw  IoException 队列已关闭，或记录无法放入缓存
+		void Append(std::span<const std::byte> const& record);
+
+		/// @brief  追加由多个部分组成的一条记录，各部分在记录中连续存放
+		/// @see    Append
+		void AppendVectored(std::span<const std::span<const std::byte>> const& parts);
+
+		/// @brief  关闭队列，之后追加将抛出异常，读取器读完已追加的记录后即到结尾
+		/// @remark 因缓存已满而等待的追加将被唤醒并抛出异常
+		void Close() noexcept;
+
+		/// @brief  创建读取器，可在不同的线程中各自使用
+		StreamQueueReader CreateReader() noexcept;
+
+		/// @brief  获得单条记录的最大长度
+		std::size_t GetMaxRecordSize() const noexcept;
+
+	private:
+		friend class StreamQueueReader;
+
+		static constexpr std::size_t CacheLineSize = 64;
+
+		std::unique_ptr<std::byte[]> m_Storage;
+		// 缓存大小减 1，缓存大小总是 2 的幂
+		std::size_t m_Mask;
+
+		// 以下位置均为自创建以来的总长度，单调增加
+		// 生产者已预留到的位置，最高位表示已关闭
+		alignas(CacheLineSize) std::atomic<std::size_t> m_ReservePosition;
+		// 生产者已按顺序完成复制的位置，最高位表示已关闭
+		alignas(CacheLineSize) std::atomic<std::size_t> m_PublishPosition;
+		// 消费者已认领到的位置
+		alignas(CacheLineSize) std::atomic<std::size_t> m_ClaimPosition;
+		// 消费者已按顺序释放的位置，最高位表示已关闭
+		alignas(CacheLineSize) std::atomic<std::size_t> m_FreePosition;
+
+		/// @brief  获得位于 position 的记录开头的长度，亦用于以长度为单位写入记录的内容
+		std::uint32_t& GetRecordHeader(std::size_t position) const noexcept;
+		/// @brief  将 parts 依次连接后复制到自 position 开始的空间，末尾不足一个长度的部分以 0 填充
+		void CopyIn(std::size_t position,
+		            std::span<const std::span<const std::byte>> const& parts) noexcept;
+		void CopyOut(std::size_t position, std::byte* data, std::size_t size) const noexcept;
+	};
+
+	/// @brief  StreamQueue 的读取器
+	/// @remark 读出的内容为记录依次连接而成的字节流，不含记录的分隔，可由 GetRemainingRecordSize 得知记录的边界
+	///         读取器每次认领一条完整的记录，读完后释放其空间；持有未读完的记录时将阻止之后的记录释放空间，
+	///         因此不应长时间持有未读完的记录
+	///         每个读取器只能由一个线程使用
+	class CAFE_PUBLIC StreamQueueReader final : public InputStream
+	{
+	public:
+		StreamQueueReader(StreamQueueReader const&) = delete;
+		StreamQueueReader(StreamQueueReader&& other) noexcept;
+
+		~StreamQueueReader();
+
+		StreamQueueReader& operator=(StreamQueueReader const&) = delete;
+		StreamQueueReader& operator=(StreamQueueReader&& other) noexcept;
+
+		/// @remark 跳过并释放当前记录未读的部分
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Borrow
+		StreamCapability GetCapabilities() const override;
+
+		/// @remark 仅包含当前记录中未读的长度，不会阻塞，因为之后的记录可能被其他读取器认领
+		std::size_t GetAvailableBytes() override;
+
+		/// @remark 当前记录读完后将认领下一条记录，队列为空时阻塞到有记录追加或队列关闭
+		std::size_t ReadBytes(std::span<std::byte> const& buffer) override;
+
+		/// @remark 借出当前记录中的数据，不会跨越记录的边界及环形缓存的结尾
+		std::span<const std::byte> BorrowBytes(std::size_t maxSize = std::size_t(-1)) override;
+		void Consume(std::size_t n) override;
+
+		/// @brief  获得当前记录中未读的长度，为 0 表示下一次读取将从新的记录开始
+		std::size_t GetRemainingRecordSize() const noexcept;
+
+	private:
+		friend class StreamQueue;
+
+		explicit StreamQueueReader(StreamQueue* queue) noexcept;
+
+		StreamQueue* m_Queue;
+		// 当前认领的记录在队列中的范围，未认领时 m_RecordBegin 等于 m_RecordEnd
+		std::size_t m_RecordBegin;
+		std::size_t m_RecordEnd;
+		// 当前读取的位置及记录内容的结束位置
+		std::size_t m_Current;
+		std::size_t m_PayloadEnd;
+
+		/// @brief  释放已读完的记录并认领下一条非空的记录，必要时阻塞
+		/// @return 是否认领到了记录，为 false 表示队列已关闭且已读完
+		bool NextRecord();
+		void ReleaseRecord() noexcept;
+	};
+} // namespace Cafe::Io
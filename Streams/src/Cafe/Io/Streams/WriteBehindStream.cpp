@@ -0,0 +1,247 @@
+#include <Cafe/ErrorHandling/ErrorHandling.h>
+#include <Cafe/Io/Streams/WriteBehindStream.h>
+#include <algorithm>
+#include <cassert>
+
+using namespace Cafe;
+using namespace Io;
+
+WriteBehindOutputStream::WriteBehindOutputStream(OutputStream* stream, std::size_t bufferSize,
+                                                 std::size_t queueDepth, BufferPool* pool)
+    : m_UnderlyingStream{ stream }, m_BufferSize{ bufferSize }, m_QueueDepth{ queueDepth },
+      m_Buffer{ BufferPool::Acquire(pool, bufferSize) }, m_Stopping{ false }
+{
+	assert(stream && bufferSize && queueDepth);
+
+	m_FreeBuffers.reserve(queueDepth);
+	for (std::size_t i = 0; i < queueDepth; ++i)
+	{
+		m_FreeBuffers.push_back(BufferPool::Acquire(pool, bufferSize));
+	}
+
+	m_WriteWindowCurrent = m_Buffer.get();
+	m_WriteWindowEnd = m_Buffer.get() + bufferSize;
+
+	m_Worker = std::thread{ &WriteBehindOutputStream::WorkerMain, this };
+}
+
+WriteBehindOutputStream::~WriteBehindOutputStream()
+{
+	try
+	{
+		WriteBehindOutputStream::Close();
+	}
+	catch (...)
+	{
+	}
+}
+
+void WriteBehindOutputStream::Close()
+{
+	if (!m_Worker.joinable())
+	{
+		return;
+	}
+
+	std::exception_ptr exception;
+	try
+	{
+		Flush();
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+	}
+
+	// 写出失败时队列中可能仍有缓存，后台线程将在丢弃全部缓存后才会退出
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_WorkerCondition.notify_all();
+	m_Worker.join();
+
+	m_UnderlyingStream = nullptr;
+	m_Buffer.reset();
+	m_FreeBuffers.clear();
+	m_WriteWindowCurrent = nullptr;
+	m_WriteWindowEnd = nullptr;
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+StreamCapability WriteBehindOutputStream::GetCapabilities() const
+{
+	return StreamCapability::Borrow;
+}
+
+void WriteBehindOutputStream::Flush()
+{
+	SubmitBuffer();
+	WaitWritten();
+	m_UnderlyingStream->Flush();
+}
+
+void WriteBehindOutputStream::Sync(DurabilityLevel level)
+{
+	SubmitBuffer();
+	WaitWritten();
+	m_UnderlyingStream->Sync(level);
+}
+
+std::span<std::byte> WriteBehindOutputStream::AcquireWriteBuffer(std::size_t size)
+{
+	if (size > GetFreeSize())
+	{
+		SubmitBuffer();
+	}
+
+	return std::span(m_WriteWindowCurrent, std::min(size, GetFreeSize()));
+}
+
+void WriteBehindOutputStream::Commit(std::size_t n)
+{
+	assert(n <= GetFreeSize());
+	m_WriteWindowCurrent += n;
+	if (m_WriteWindowCurrent == m_WriteWindowEnd)
+	{
+		SubmitBuffer();
+	}
+}
+
+OutputStream* WriteBehindOutputStream::GetUnderlyingStream() const noexcept
+{
+	return m_UnderlyingStream;
+}
+
+std::size_t WriteBehindOutputStream::GetBufferSize() const noexcept
+{
+	return m_BufferSize;
+}
+
+std::size_t WriteBehindOutputStream::GetQueueDepth() const noexcept
+{
+	return m_QueueDepth;
+}
+
+bool WriteBehindOutputStream::Overflow(std::byte value)
+{
+	SubmitBuffer();
+	*m_WriteWindowCurrent++ = value;
+	return true;
+}
+
+std::size_t WriteBehindOutputStream::WriteBytesSlow(std::span<const std::byte> const& buffer)
+{
+	const auto bufferSize = static_cast<std::size_t>(buffer.size());
+	std::size_t writtenSize = 0;
+
+	while (true)
+	{
+		const auto size = std::min(bufferSize - writtenSize, GetFreeSize());
+		std::memcpy(m_WriteWindowCurrent, buffer.data() + writtenSize, size);
+		m_WriteWindowCurrent += size;
+		writtenSize += size;
+
+		// 写满时立即提交，使后台线程尽早开始写出
+		if (m_WriteWindowCurrent == m_WriteWindowEnd)
+		{
+			SubmitBuffer();
+		}
+
+		if (writtenSize == bufferSize)
+		{
+			break;
+		}
+	}
+
+	return writtenSize;
+}
+
+void WriteBehindOutputStream::SubmitBuffer()
+{
+	const auto bufferedSize = GetBufferedSize();
+
+	std::unique_lock lock{ m_Mutex };
+	if (m_Exception)
+	{
+		std::rethrow_exception(m_Exception);
+	}
+
+	if (!bufferedSize)
+	{
+		return;
+	}
+
+	m_ProducerCondition.wait(lock, [this] { return m_Exception || !m_FreeBuffers.empty(); });
+	if (m_Exception)
+	{
+		std::rethrow_exception(m_Exception);
+	}
+
+	m_PendingBuffers.push_back({ std::move(m_Buffer), bufferedSize });
+	m_Buffer = std::move(m_FreeBuffers.back());
+	m_FreeBuffers.pop_back();
+
+	// 仅在队列由空变为非空时唤醒，后台线程写出期间提交的缓存将在写出完成后依次取走
+	const auto shouldNotify = m_PendingBuffers.size() == 1;
+	lock.unlock();
+	if (shouldNotify)
+	{
+		m_WorkerCondition.notify_one();
+	}
+
+	m_WriteWindowCurrent = m_Buffer.get();
+	m_WriteWindowEnd = m_Buffer.get() + m_BufferSize;
+}
+
+void WriteBehindOutputStream::WaitWritten()
+{
+	std::unique_lock lock{ m_Mutex };
+	m_ProducerCondition.wait(lock, [this] { return m_PendingBuffers.empty(); });
+	if (m_Exception)
+	{
+		std::rethrow_exception(m_Exception);
+	}
+}
+
+void WriteBehindOutputStream::WorkerMain()
+{
+	std::unique_lock lock{ m_Mutex };
+	while (true)
+	{
+		m_WorkerCondition.wait(lock, [this] { return m_Stopping || !m_PendingBuffers.empty(); });
+
+		if (m_PendingBuffers.empty())
+		{
+			return;
+		}
+
+		// 队首在写出期间保留在队列中，用户线程仅在队尾追加，因此引用保持有效
+		auto& pending = m_PendingBuffers.front();
+		auto exception = m_Exception;
+		lock.unlock();
+
+		// 已失败时丢弃之后的缓存
+		if (!exception)
+		{
+			try
+			{
+				m_UnderlyingStream->WriteBytes(std::span(pending.Buffer.get(), pending.Size));
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+		}
+
+		lock.lock();
+		m_Exception = exception;
+		m_FreeBuffers.push_back(std::move(pending.Buffer));
+		m_PendingBuffers.pop_front();
+		m_ProducerCondition.notify_all();
+	}
+}
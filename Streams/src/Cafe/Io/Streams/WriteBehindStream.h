@@ -0,0 +1,135 @@
+#pragma once
+
+#include "BufferPool.h"
+#include "StreamBase.h"
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Cafe::Io
+{
+	/// @brief  后写输出流
+	/// @remark 与 BufferedOutputStream 类似，但写满的缓存交由后台线程写出到包装流，用户线程继续写入另一块空闲的缓存，
+	///         使包装流的写入延迟不阻塞用户线程，适用于请求日志等不希望写入线程受存储设备延迟波动影响的场景
+	///         共使用 queueDepth + 1 块缓存，至多 queueDepth 块写满的缓存等待写出，均未写出时用户线程将等待
+	///         后台线程写入失败后包装流的状态未知，之后的缓存不再写出，并在下一次提交缓存、Flush、Sync 或
+	///         Close 时抛出该异常
+	///         本类不会取得包装流的所有权，在本类管理期间不应在外部操作包装流，否则可能导致错误
+	///         缓存不会被初始化，可指定缓存池以在频繁创建及销毁时复用缓存
+	///         后台线程引用本对象，因此本类不可移动
+	class CAFE_PUBLIC WriteBehindOutputStream final : public OutputStream
+	{
+	public:
+		static constexpr std::size_t DefaultBufferSize = 64 * 1024;
+		static constexpr std::size_t DefaultQueueDepth = 2;
+
+		/// @param  stream      包装流
+		/// @param  bufferSize  每块缓存的大小，不可为 0
+		/// @param  queueDepth  等待写出的缓存块数的上限，不可为 0
+		/// @param  pool        从中取得缓存的缓存池，关闭时归还，为空时直接分配缓存
+		explicit WriteBehindOutputStream(OutputStream* stream,
+		                                 std::size_t bufferSize = DefaultBufferSize,
+		                                 std::size_t queueDepth = DefaultQueueDepth,
+		                                 BufferPool* pool = nullptr);
+
+		WriteBehindOutputStream(WriteBehindOutputStream const&) = delete;
+		WriteBehindOutputStream& operator=(WriteBehindOutputStream const&) = delete;
+
+		/// @remark 析构时无法报告写出失败，需要得知时应在析构前调用 Close
+		~WriteBehindOutputStream();
+
+		/// @remark 等待全部缓存写出并刷新包装流后结束后台线程，之后释放或归还缓存
+		///         写出失败时仍会结束后台线程，之后抛出该异常
+		///         之后流处于无效状态，不可进行除析构以外的任何操作
+		void Close() override;
+
+		/// @remark 包含 StreamCapability::Borrow
+		StreamCapability GetCapabilities() const override;
+
+		/// @remark 缓存空间足够时将内联完成
+		std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+		{
+			if (buffer.size() < GetFreeSize()) [[likely]]
+			{
+				std::memcpy(m_WriteWindowCurrent, buffer.data(), buffer.size());
+				m_WriteWindowCurrent += buffer.size();
+				return buffer.size();
+			}
+
+			return WriteBytesSlow(buffer);
+		}
+
+		/// @remark 等待当前缓存及之前的缓存全部写出后刷新包装流
+		void Flush() override;
+		/// @remark 等待当前缓存及之前的缓存全部写出后将 level 转发给包装流
+		void Sync(DurabilityLevel level = DurabilityLevel::Full) override;
+
+		/// @remark 返回当前缓存中的空闲部分，若空闲部分不足 size 则先提交当前缓存
+		///         返回的长度不超过缓存大小
+		std::span<std::byte> AcquireWriteBuffer(std::size_t size) override;
+		void Commit(std::size_t n) override;
+
+		OutputStream* GetUnderlyingStream() const noexcept;
+
+		std::size_t GetBufferSize() const noexcept;
+		std::size_t GetQueueDepth() const noexcept;
+
+	private:
+		struct PendingBuffer
+		{
+			BufferPool::Buffer Buffer;
+			std::size_t Size;
+		};
+
+		OutputStream* m_UnderlyingStream;
+		std::size_t m_BufferSize;
+		std::size_t m_QueueDepth;
+
+		// 用户当前写入的缓存，已写入的部分为 [m_Buffer, m_WriteWindowCurrent)，写入窗口为其余的空闲部分
+		BufferPool::Buffer m_Buffer;
+
+		// 以下成员由 m_Mutex 保护
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkerCondition;
+		std::condition_variable m_ProducerCondition;
+		// 等待写出的缓存，按提交的顺序排列，队首在后台线程写出期间仍保留在队列中
+		std::deque<PendingBuffer> m_PendingBuffers;
+		std::vector<BufferPool::Buffer> m_FreeBuffers;
+		std::exception_ptr m_Exception;
+		bool m_Stopping;
+
+		std::thread m_Worker;
+
+		/// @remark 写入窗口为空即当前缓存已满，提交后写入新的缓存
+		bool Overflow(std::byte value) override;
+
+		std::size_t WriteBytesSlow(std::span<const std::byte> const& buffer);
+
+		/// @brief  获得当前缓存中已写入的长度
+		std::size_t GetBufferedSize() const noexcept
+		{
+			return static_cast<std::size_t>(m_WriteWindowCurrent - m_Buffer.get());
+		}
+
+		/// @brief  获得当前缓存中空闲的长度
+		std::size_t GetFreeSize() const noexcept
+		{
+			return static_cast<std::size_t>(m_WriteWindowEnd - m_WriteWindowCurrent);
+		}
+
+		/// @brief  将当前缓存交由后台线程写出，并换为一块空闲的缓存，当前缓存为空时无操作
+		/// @remark 没有空闲的缓存时阻塞到后台线程写出一块缓存
+		/// @throw  后台线程写入时抛出的异常
+		void SubmitBuffer();
+
+		/// @brief  阻塞到已提交的缓存全部写出
+		/// @throw  后台线程写入时抛出的异常
+		void WaitWritten();
+
+		void WorkerMain();
+	};
+} // namespace Cafe::Io
@@ -1,5 +1,6 @@
 #include <Cafe/Io/StreamHelpers/BinaryReader.h>
 #include <Cafe/Io/StreamHelpers/BinaryWriter.h>
+#include <Cafe/Io/Streams/BufferedStream.h>
 #include <Cafe/Io/Streams/MemoryStream.h>
 #include <catch2/catch_all.hpp>
 
@@ -10,7 +11,32 @@ namespace
 {
 	constexpr std::uint8_t Data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
 		                              0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
-}
+
+	// 不继承自 InputStream 的流，仅满足静态接口
+	struct CountingInputStream
+	{
+		std::size_t ReadCount = 0;
+
+		std::optional<std::byte> ReadByte()
+		{
+			return std::byte(++ReadCount);
+		}
+
+		std::size_t ReadBytes(std::span<std::byte> const& buffer)
+		{
+			for (auto& byte : buffer)
+			{
+				byte = std::byte(++ReadCount);
+			}
+			return buffer.size();
+		}
+	};
+
+	static_assert(StaticInputStreamConcept<CountingInputStream>);
+	static_assert(!StaticOutputStreamConcept<CountingInputStream>);
+	static_assert(StaticInputStreamConcept<InputStream>);
+	static_assert(StaticOutputStreamConcept<OutputStream>);
+} // namespace
 
 TEST_CASE("Cafe.Io.StreamHelpers", "[Io][StreamHelpers]")
 {
@@ -41,6 +67,32 @@ TEST_CASE("Cafe.Io.StreamHelpers", "[Io][StreamHelpers]")
 		// 未测试大小不为 1 2 4 8 的标量类型及所有浮点类型
 	}
 
+	SECTION("Test BinaryReader with static dispatch")
+	{
+		ExternalMemoryInputStream stream{ std::as_bytes(std::span(Data)) };
+		BufferedInputStream bufferedStream{ &stream, 8 };
+		BinaryReader<BufferedInputStream> reader{ &bufferedStream, std::endian::little };
+
+		const auto u8 = reader.Read<std::uint8_t>();
+		REQUIRE(u8);
+		REQUIRE(*u8 == 0x01);
+
+		const auto u32 = reader.Read<std::uint32_t>();
+		REQUIRE(u32);
+		REQUIRE(*u32 == (std::endian::native == std::endian::little ? 0x05040302 : 0x02030405));
+
+		const auto u64 = reader.Read<std::uint64_t>();
+		REQUIRE(u64);
+		REQUIRE(*u64 == (std::endian::native == std::endian::little ? 0x0d0c0b0a09080706
+		                                                            : 0x060708090a0b0c0d));
+
+		CountingInputStream countingStream;
+		BinaryReader<CountingInputStream> countingReader{ &countingStream, std::endian::big };
+		const auto u16 = countingReader.Read<std::uint16_t>();
+		REQUIRE(u16);
+		REQUIRE(*u16 == 0x0102);
+	}
+
 	SECTION("Test BinaryWriter")
 	{
 		std::byte buffer[15];
@@ -1,8 +1,23 @@
+#include <Cafe/Io/Streams/AsyncStream.h>
+#include <Cafe/Io/Streams/BufferPool.h>
 #include <Cafe/Io/Streams/BufferedStream.h>
 #include <Cafe/Io/Streams/FileStream.h>
+#include <Cafe/Io/Streams/GroupCommitAppender.h>
+#include <Cafe/Io/Streams/IoUring.h>
+#include <Cafe/Io/Streams/MappedFileStream.h>
 #include <Cafe/Io/Streams/MemoryStream.h>
+#include <Cafe/Io/Streams/PipeStream.h>
+#include <Cafe/Io/Streams/ReadAheadStream.h>
+#include <Cafe/Io/Streams/StreamQueue.h>
+#include <Cafe/Io/Streams/WriteBehindStream.h>
 #include <catch2/catch_all.hpp>
+#include <algorithm>
 #include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <thread>
+#include <type_traits>
 
 using namespace Cafe;
 using namespace Io;
@@ -10,6 +25,53 @@ using namespace Encoding::StringLiterals;
 
 constexpr const char Data[] = "Some Text";
 
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && defined(__linux__) && defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+#define CAFE_IO_TEST_COUNT_SYSCALLS 1
+#include <dlfcn.h>
+
+namespace
+{
+	// 替换 libc 中读取、查询位置及长度的函数以统计调用次数，仅统计开启计数的线程
+	thread_local bool SyscallCountEnabled = false;
+	thread_local std::size_t SyscallCount = 0;
+
+	template <typename Func>
+	std::size_t CountSyscalls(Func&& func)
+	{
+		SyscallCount = 0;
+		SyscallCountEnabled = true;
+		std::forward<Func>(func)();
+		SyscallCountEnabled = false;
+		return SyscallCount;
+	}
+} // namespace
+
+extern "C" off_t lseek(int fd, off_t offset, int whence) noexcept
+{
+	static const auto next = reinterpret_cast<off_t (*)(int, off_t, int)>(dlsym(RTLD_NEXT, "lseek"));
+	SyscallCount += SyscallCountEnabled;
+	return next(fd, offset, whence);
+}
+
+extern "C" int fstat(int fd, struct stat* buf) noexcept
+{
+	static const auto next =
+	    reinterpret_cast<int (*)(int, struct stat*)>(dlsym(RTLD_NEXT, "fstat"));
+	SyscallCount += SyscallCountEnabled;
+	return next(fd, buf);
+}
+
+extern "C" ssize_t read(int fd, void* buf, std::size_t count)
+{
+	static const auto next =
+	    reinterpret_cast<ssize_t (*)(int, void*, std::size_t)>(dlsym(RTLD_NEXT, "read"));
+	SyscallCount += SyscallCountEnabled;
+	return next(fd, buf, count);
+}
+#endif
+#endif
+
 TEST_CASE("Cafe.Io.Streams", "[Io][Streams]")
 {
 #if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
@@ -43,6 +105,10 @@ TEST_CASE("Cafe.Io.Streams", "[Io][Streams]")
 #endif
 	SECTION("MemoryStreams")
 	{
+		// 非 pmr 的存储无法被接管，不应静默复制
+		static_assert(!std::is_constructible_v<MemoryStream, std::vector<std::byte>&&>);
+		static_assert(std::is_constructible_v<MemoryStream, MemoryStream::StorageType&&>);
+
 		{
 			MemoryStream stream;
 			const auto writtenSize = stream.WriteBytes(std::as_bytes(std::span(Data)));
@@ -75,6 +141,32 @@ TEST_CASE("Cafe.Io.Streams", "[Io][Streams]")
 			REQUIRE(std::memcmp(Data, buffer, 10) == 0);
 		}
 
+		{
+			// 复用时不再向内存资源分配
+			std::byte arena[256];
+			std::pmr::monotonic_buffer_resource resource{ arena, sizeof(arena),
+				                                          std::pmr::null_memory_resource() };
+			MemoryStream stream{ &resource };
+			REQUIRE(stream.GetMemoryResource() == &resource);
+
+			for (std::size_t i = 0; i < 100; ++i)
+			{
+				stream.Reset();
+				REQUIRE(stream.GetPosition() == 0);
+				REQUIRE(stream.GetTotalSize() == 0);
+
+				stream.WriteBytes(std::as_bytes(std::span(Data)));
+				REQUIRE(stream.GetTotalSize() == sizeof(Data));
+				REQUIRE(stream.GetInternalStorage().data() >= arena);
+				REQUIRE(stream.GetInternalStorage().data() < arena + sizeof(arena));
+			}
+
+			const auto storage = stream.ReleaseStorage();
+			REQUIRE(storage.get_allocator().resource() == &resource);
+			REQUIRE(std::memcmp(Data, storage.data(), sizeof(Data)) == 0);
+			REQUIRE(stream.GetTotalSize() == 0);
+		}
+
 		{
 			ExternalMemoryInputStream stream{ std::as_bytes(std::span(Data)) };
 
@@ -99,6 +191,80 @@ TEST_CASE("Cafe.Io.Streams", "[Io][Streams]")
 		}
 	}
 
+	SECTION("SegmentedMemoryStreams")
+	{
+		std::vector<std::byte> content(1000);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 7);
+		}
+
+		SegmentedMemoryStream stream{ 100 };
+		REQUIRE(stream.GetChunkSize() == 128);
+
+		// 跨越分块的写入
+		REQUIRE(stream.WriteBytes(std::span(content).first(300)) == 300);
+		const auto writeBuffer = stream.AcquireWriteBuffer(1000);
+		REQUIRE(writeBuffer.size() == 384 - 300);
+		std::memcpy(writeBuffer.data(), content.data() + 300, 50);
+		stream.Commit(50);
+		REQUIRE(stream.WriteBytes(std::span(content).subspan(350)) == 650);
+		REQUIRE(stream.GetTotalSize() == 1000);
+		REQUIRE(stream.GetPosition() == 1000);
+
+		const auto segments = stream.GetSegments();
+		REQUIRE(segments.size() == 8);
+		std::size_t position = 0;
+		for (const auto& segment : segments)
+		{
+			REQUIRE(std::memcmp(segment.data(), content.data() + position, segment.size()) == 0);
+			position += segment.size();
+		}
+		REQUIRE(position == 1000);
+
+		// 跨越分块的读取及寻位
+		stream.Seek(SeekOrigin::End, -900);
+		std::vector<std::byte> buffer(500);
+		REQUIRE(stream.ReadBytes(std::span(buffer)) == 500);
+		REQUIRE(std::memcmp(buffer.data(), content.data() + 100, 500) == 0);
+		REQUIRE(stream.BorrowBytes().size() == 640 - 600);
+		stream.Consume(10);
+		REQUIRE(stream.Skip(1000) == 390);
+		REQUIRE(stream.ReadBytes(std::span(buffer)) == 0);
+		REQUIRE_THROWS_AS(stream.Seek(SeekOrigin::Current, 1), IoException);
+
+		// 各起点的越界检查
+		stream.Seek(SeekOrigin::Current, -1000);
+		REQUIRE(stream.GetPosition() == 0);
+		REQUIRE_THROWS_AS(stream.Seek(SeekOrigin::Current, -1), IoException);
+		REQUIRE_THROWS_AS(stream.Seek(SeekOrigin::Begin, -1), IoException);
+		REQUIRE_THROWS_AS(stream.Seek(SeekOrigin::Begin, 1001), IoException);
+		REQUIRE_THROWS_AS(stream.Seek(SeekOrigin::End, -1001), IoException);
+		REQUIRE_THROWS_AS(stream.Seek(SeekOrigin::End, 1), IoException);
+		REQUIRE_THROWS_AS(
+		    stream.Seek(SeekOrigin::End, std::numeric_limits<std::ptrdiff_t>::min()),
+		    IoException);
+		stream.Seek(SeekOrigin::End, 0);
+		REQUIRE(stream.GetPosition() == 1000);
+
+		REQUIRE(stream.ReadAt(990, std::span(buffer)) == 10);
+		REQUIRE(std::memcmp(buffer.data(), content.data() + 990, 10) == 0);
+
+		// 跳过的部分以 0 填充
+		const std::byte value[] = { std::byte{ 1 } };
+		REQUIRE(stream.WriteAt(1200, value) == 1);
+		REQUIRE(stream.GetTotalSize() == 1201);
+		REQUIRE(stream.ReadAt(995, std::span(buffer)) == 206);
+		REQUIRE(std::memcmp(buffer.data(), content.data() + 995, 5) == 0);
+		REQUIRE(std::all_of(buffer.begin() + 5, buffer.begin() + 205,
+		                    [](std::byte b) { return b == std::byte{}; }));
+		REQUIRE(buffer[205] == std::byte{ 1 });
+
+		REQUIRE_THROWS_AS(stream.WriteAt(std::numeric_limits<std::size_t>::max(), value),
+		                  IoException);
+		REQUIRE(stream.GetTotalSize() == 1201);
+	}
+
 	SECTION("BufferedStreams")
 	{
 		constexpr const std::uint8_t Data[]{ 0x00, 0x01, 0x02, 0x03 };
@@ -141,5 +307,1512 @@ TEST_CASE("Cafe.Io.Streams", "[Io][Streams]")
 
 			REQUIRE(std::memcmp(Data, buffer, 4) == 0);
 		}
+
+		{
+			// 缓存回绕时不移动已缓存的数据
+			MemoryStream textStream{ std::as_bytes(std::span(::Data)) };
+			BufferedInputStream bufferedStream{ &textStream, 8 };
+
+			std::byte buffer[10];
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer, 6)) == 6);
+
+			const auto segments = bufferedStream.PeekSegments(4);
+			REQUIRE(segments[0].size() == 2);
+			REQUIRE(segments[1].size() == 2);
+			REQUIRE(segments[1].data() == segments[0].data() - 6);
+			REQUIRE(std::memcmp(::Data + 6, segments[0].data(), 2) == 0);
+			REQUIRE(std::memcmp(::Data + 8, segments[1].data(), 2) == 0);
+
+			REQUIRE(bufferedStream.PeekBytes(std::span(buffer, 4)) == 4);
+			REQUIRE(std::memcmp(::Data + 6, buffer, 4) == 0);
+			REQUIRE(bufferedStream.GetPosition() == 6);
+
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer, 4)) == 4);
+			REQUIRE(std::memcmp(::Data + 6, buffer, 4) == 0);
+			REQUIRE(bufferedStream.GetPosition() == 10);
+
+			bufferedStream.SeekFromBegin(8);
+			REQUIRE(bufferedStream.ReadByte() == std::byte{ 't' });
+		}
+
+		{
+			// 逐字节读写经过基类的读写窗口，窗口用尽时才调用虚函数填充或写出缓存
+			MemoryStream textStream{ std::as_bytes(std::span(::Data)) };
+			MemoryStream resultStream;
+			{
+				BufferedInputStream bufferedInputStream{ &textStream, 3 };
+				BufferedOutputStream bufferedOutputStream{ &resultStream, 3 };
+				InputStream& input = bufferedInputStream;
+				OutputStream& output = bufferedOutputStream;
+
+				while (const auto value = input.ReadByte())
+				{
+					REQUIRE(output.WriteByte(*value));
+				}
+
+				REQUIRE(bufferedInputStream.GetPosition() == sizeof ::Data);
+				REQUIRE(resultStream.GetTotalSize() == sizeof ::Data - sizeof ::Data % 3);
+			}
+			REQUIRE(resultStream.GetTotalSize() == sizeof ::Data);
+			REQUIRE(std::memcmp(::Data, resultStream.GetInternalStorage().data(), sizeof ::Data) ==
+			        0);
+
+			std::byte storage[4];
+			ExternalMemoryOutputStream externalOutputStream{ std::span(storage) };
+			for (std::size_t i = 0; i < std::size(storage); ++i)
+			{
+				REQUIRE(externalOutputStream.WriteByte(std::byte(::Data[i])));
+			}
+			REQUIRE(!externalOutputStream.WriteByte(std::byte{}));
+			REQUIRE(externalOutputStream.GetPosition() == 4);
+
+			ExternalMemoryInputStream externalInputStream{ std::span<const std::byte>(storage) };
+			externalInputStream.SeekFromBegin(3);
+			REQUIRE(externalInputStream.ReadByte() == std::byte(::Data[3]));
+			REQUIRE(!externalInputStream.ReadByte().has_value());
+		}
+	}
+
+	SECTION("BufferPool")
+	{
+		BufferPool pool{ 64 };
+		MemoryStream stream;
+
+		std::byte* bufferData;
+		{
+			BufferedOutputStream bufferedStream{ &stream, 32, &pool };
+			bufferData = bufferedStream.AcquireWriteBuffer(4).data();
+			bufferedStream.WriteBytes(std::as_bytes(std::span(Data)));
+		}
+		REQUIRE(stream.GetTotalSize() == 10);
+		REQUIRE(pool.GetCachedSize() == 32);
+
+		{
+			// 相同大小的缓存将被复用，不同大小的缓存将被分配
+			BufferedInputStream bufferedStream{ &stream, 32, &pool };
+			REQUIRE(pool.GetCachedSize() == 0);
+			stream.SeekFromBegin(0);
+			REQUIRE(bufferedStream.BorrowBytes().data() == bufferData);
+
+			BufferedOutputStream otherStream{ &stream, 16, &pool };
+			REQUIRE(otherStream.AcquireWriteBuffer(4).data() != bufferData);
+		}
+		REQUIRE(pool.GetCachedSize() == 48);
+
+		{
+			// 超出上限的缓存将被直接释放
+			BufferedOutputStream bufferedStream{ &stream, 64, &pool };
+		}
+		REQUIRE(pool.GetCachedSize() == 48);
+
+		pool.Trim();
+		REQUIRE(pool.GetCachedSize() == 0);
+	}
+
+	SECTION("VectoredIo")
+	{
+		const auto bytes = std::as_bytes(std::span(Data));
+		const std::span<const std::byte> segments[]{ bytes.subspan(0, 3), bytes.subspan(3, 0),
+			                                         bytes.subspan(3) };
+
+		{
+			MemoryStream stream;
+			REQUIRE(stream.WriteBytesVectored(segments) == 10);
+			REQUIRE(stream.GetPosition() == 10);
+
+			{
+				// 缓存可容纳时不写出，不可容纳时缓存内容与数据一并写出
+				BufferedOutputStream bufferedStream{ &stream, 16 };
+				REQUIRE(bufferedStream.WriteBytesVectored(segments) == 10);
+				REQUIRE(stream.GetPosition() == 10);
+				REQUIRE(bufferedStream.WriteBytesVectored(segments) == 10);
+				REQUIRE(stream.GetPosition() == 30);
+			}
+
+			stream.SeekFromBegin(0);
+
+			std::byte buffer[30];
+			const std::span<std::byte> readSegments[]{ std::span(buffer, 7),
+				                                       std::span(buffer + 7, 23) };
+			REQUIRE(stream.ReadBytesVectored(readSegments) == 30);
+			for (std::size_t i = 0; i < 3; ++i)
+			{
+				REQUIRE(std::memcmp(Data, buffer + i * 10, 10) == 0);
+			}
+		}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+		{
+#ifdef _WIN32
+			const auto fileName = u"TempVectored.txt"_sv;
+#else
+			const auto fileName = u8"TempVectored.txt"_sv;
+#endif
+			{
+				FileOutputStream file{ fileName };
+				REQUIRE(file.WriteBytesVectored(segments) == 10);
+			}
+
+			FileInputStream file{ fileName };
+			std::byte buffer[12];
+			const std::span<std::byte> readSegments[]{ std::span(buffer, 5),
+				                                       std::span(buffer + 5, 7) };
+			REQUIRE(file.ReadBytesVectored(readSegments) == 10);
+			REQUIRE(std::memcmp(Data, buffer, 10) == 0);
+		}
+#endif
+	}
+
+	SECTION("PositionalIo")
+	{
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		{
+			MemoryStream stream;
+			REQUIRE(stream.WriteAt(2, bytes) == 10);
+			REQUIRE(stream.GetPosition() == 0);
+			REQUIRE(stream.GetTotalSize() == 12);
+
+			std::byte buffer[16];
+			REQUIRE(stream.ReadAt(2, std::span(buffer)) == 10);
+			REQUIRE(std::memcmp(Data, buffer, 10) == 0);
+			REQUIRE(stream.ReadAt(12, std::span(buffer)) == 0);
+			REQUIRE(stream.GetPosition() == 0);
+
+			// 写入范围的末尾溢出时拒绝写入
+			REQUIRE_THROWS_AS(stream.WriteAt(std::numeric_limits<std::size_t>::max() - 1, bytes),
+			                  IoException);
+			REQUIRE(stream.GetTotalSize() == 12);
+		}
+
+		{
+			ExternalMemoryInputStream stream{ bytes };
+			stream.SeekFromBegin(3);
+
+			std::byte buffer[4];
+			REQUIRE(stream.ReadAt(5, std::span(buffer)) == 4);
+			REQUIRE(std::memcmp(Data + 5, buffer, 4) == 0);
+			REQUIRE(stream.ReadAt(std::numeric_limits<std::size_t>::max(), std::span(buffer)) == 0);
+			REQUIRE(stream.GetPosition() == 3);
+		}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+		{
+#ifdef _WIN32
+			const auto fileName = u"TempPositional.txt"_sv;
+#else
+			const auto fileName = u8"TempPositional.txt"_sv;
+#endif
+			{
+				FileOutputStream file{ fileName };
+				REQUIRE(file.WriteAt(4, bytes.subspan(4)) == 6);
+				REQUIRE(file.WriteAt(0, bytes.subspan(0, 4)) == 4);
+			}
+
+			FileInputStream file{ fileName };
+			std::byte buffer[16];
+			REQUIRE(file.ReadAt(1, std::span(buffer)) == 9);
+			REQUIRE(std::memcmp(Data + 1, buffer, 9) == 0);
+#ifndef _WIN32
+			REQUIRE(file.GetPosition() == 0);
+#endif
+		}
+#endif
+	}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && !defined(_WIN32)
+	SECTION("DirectIo")
+	{
+		const auto fileName = u8"TempDirect.txt"_sv;
+		std::vector<std::byte> content(3 * 4096 + 123);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 13);
+		}
+
+		{
+			std::optional<FileOutputStream> file;
+			try
+			{
+				file.emplace(fileName, FileOutputStream::FileOpenMode::Truncate,
+				             FileCachePolicy::Direct);
+			}
+			catch (FileIoException const&)
+			{
+				// 文件系统不支持直接读写
+				return;
+			}
+			REQUIRE(file->GetCachePolicy() == FileCachePolicy::Direct);
+			REQUIRE(!HasCapability(file->GetCapabilities(), StreamCapability::PositionalIo));
+
+			// 不对齐的写入经由内部缓存，结尾不足一个块的部分在关闭时写出
+			const auto bytes = std::span(content);
+			REQUIRE(file->WriteBytes(bytes.first(100)) == 100);
+			REQUIRE(file->WriteBytes(bytes.subspan(100, 8192)) == 8192);
+			REQUIRE(file->GetPosition() == 8292);
+			REQUIRE(file->WriteBytes(bytes.subspan(8292)) == content.size() - 8292);
+			REQUIRE(file->GetTotalSize() == content.size());
+		}
+
+		{
+			FileInputStream file{ fileName };
+			REQUIRE(file.GetTotalSize() == content.size());
+			std::vector<std::byte> buffer(content.size());
+			REQUIRE(file.ReadBytes(std::span(buffer)) == content.size());
+			REQUIRE(buffer == content);
+		}
+
+		// 在已有文件的中间改写不对齐的范围，不影响其余数据
+		{
+			FileOutputStream file{ fileName, FileOutputStream::FileOpenMode::Overwrite,
+				                   FileCachePolicy::Direct };
+			file.SeekFromBegin(5000);
+			const std::byte patch[]{ std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 } };
+			REQUIRE(file.WriteBytes(std::span(patch)) == 3);
+			std::copy(std::begin(patch), std::end(patch), content.begin() + 5000);
+		}
+
+		{
+			FileOutputStream file{ fileName, FileOutputStream::FileOpenMode::Append,
+				                   FileCachePolicy::Direct };
+			REQUIRE(file.GetPosition() == content.size());
+			const std::byte tail[]{ std::byte{ 4 }, std::byte{ 5 } };
+			REQUIRE(file.WriteBytes(std::span(tail)) == 2);
+			content.insert(content.end(), std::begin(tail), std::end(tail));
+		}
+
+		{
+			FileInputStream file{ fileName, FileCachePolicy::Direct };
+			REQUIRE(file.GetTotalSize() == content.size());
+
+			std::byte buffer[16];
+			file.SeekFromBegin(4998);
+			REQUIRE(file.ReadBytes(std::span(buffer).first(8)) == 8);
+			REQUIRE(std::memcmp(buffer, content.data() + 4998, 8) == 0);
+			REQUIRE(file.GetPosition() == 5006);
+
+			REQUIRE(file.ReadAt(4095, std::span(buffer).first(2)) == 2);
+			REQUIRE(std::memcmp(buffer, content.data() + 4095, 2) == 0);
+			REQUIRE(file.GetPosition() == 5006);
+
+			file.Seek(SeekOrigin::End, -5);
+			REQUIRE(file.ReadBytes(std::span(buffer)) == 5);
+			REQUIRE(std::memcmp(buffer, content.data() + content.size() - 5, 5) == 0);
+			REQUIRE(file.ReadBytes(std::span(buffer)) == 0);
+		}
+	}
+#endif
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && defined(__linux__)
+	SECTION("AccessHints")
+	{
+		const auto fileName = u8"TempHint.txt"_sv;
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		{
+			FileOutputStream file{ fileName };
+			REQUIRE(file.SetDropCacheAfterWrite(true, 16));
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				REQUIRE(file.WriteBytes(bytes) == bytes.size());
+			}
+			file.SeekFromBegin(0);
+			REQUIRE(file.WriteBytes(bytes.first(2)) == 2);
+			REQUIRE(file.Advise(AccessHint::DontNeed));
+		}
+
+		FileInputStream file{ fileName };
+		REQUIRE(file.GetTotalSize() == bytes.size() * 4);
+		REQUIRE(file.Advise(AccessHint::Sequential));
+		REQUIRE(file.Advise(AccessHint::WillNeed, 4, 8));
+
+		std::byte buffer[sizeof(Data) * 4];
+		REQUIRE(file.ReadBytes(std::span(buffer)) == sizeof(buffer));
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			REQUIRE(std::memcmp(buffer + i * sizeof(Data), Data, sizeof(Data)) == 0);
+		}
+
+#if CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING
+		REQUIRE(!file.AdviseMapping(AccessHint::WillNeed));
+		auto mapped = file.MapToMemory();
+		REQUIRE(file.AdviseMapping(AccessHint::Random));
+		REQUIRE(file.AdviseMapping(AccessHint::WillNeed, 13, 7));
+		REQUIRE(!file.AdviseMapping(AccessHint::WillNeed, sizeof(buffer)));
+		REQUIRE(mapped.ReadByte() == bytes[0]);
+#endif
+	}
+#endif
+
+	SECTION("Durability")
+	{
+		// 记录收到的刷新及同步请求
+		struct RecordingStream : OutputStream
+		{
+			std::size_t WrittenSize = 0;
+			std::size_t FlushCount = 0;
+			std::optional<DurabilityLevel> LastSyncLevel;
+
+			std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+			{
+				WrittenSize += buffer.size();
+				return buffer.size();
+			}
+
+			void Flush() override
+			{
+				++FlushCount;
+			}
+
+			void Sync(DurabilityLevel level) override
+			{
+				LastSyncLevel = level;
+			}
+		};
+
+		RecordingStream stream;
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		{
+			BufferedOutputStream bufferedStream{ &stream, 4 };
+			REQUIRE(bufferedStream.WriteBytes(bytes.first(2)) == 2);
+			bufferedStream.Sync(DurabilityLevel::Data);
+			REQUIRE(stream.WrittenSize == 2);
+			REQUIRE(stream.LastSyncLevel == DurabilityLevel::Data);
+			REQUIRE(stream.FlushCount == 0);
+
+			// 缓存写满时仅写出，不刷新包装流
+			REQUIRE(bufferedStream.WriteBytes(bytes.first(4)) == 4);
+			REQUIRE(stream.WrittenSize == 6);
+			REQUIRE(stream.FlushCount == 0);
+
+			bufferedStream.Flush();
+			REQUIRE(stream.FlushCount == 1);
+		}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+		const auto fileName = u8"TempDurability.txt"_sv;
+
+		{
+			FileOutputStream file{ fileName };
+			REQUIRE(file.GetFlushDurability() == DurabilityLevel::Full);
+			file.SetFlushDurability(DurabilityLevel::None);
+
+			BufferedOutputStream bufferedStream{ &file };
+			for (const auto level : { DurabilityLevel::None, DurabilityLevel::WriteBack,
+			                          DurabilityLevel::Data, DurabilityLevel::Full })
+			{
+				REQUIRE(bufferedStream.WriteBytes(bytes) == bytes.size());
+				bufferedStream.Sync(level);
+			}
+			bufferedStream.Flush();
+		}
+
+		FileInputStream file{ fileName };
+		REQUIRE(file.GetTotalSize() == bytes.size() * 4);
+#endif
+	}
+
+#if defined(CAFE_IO_TEST_COUNT_SYSCALLS)
+	SECTION("FileStreamSyscallBudget")
+	{
+		const auto fileName = u8"TempSyscall.txt"_sv;
+		const auto bytes = std::as_bytes(std::span(Data));
+		FileOutputStream{ fileName }.WriteBytes(bytes);
+
+		FileInputStream file{ fileName };
+		std::byte buffer[4];
+
+		// 长度仅在首次获取时查询，位置在用户空间中跟踪
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.GetTotalSize() == bytes.size()); }) == 1);
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.GetTotalSize() == bytes.size()); }) == 0);
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.GetPosition() == 0); }) == 0);
+		// 读取本身仅进行一次系统调用，不附带查询
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.ReadBytes(std::span(buffer)) == 4); }) == 1);
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.GetAvailableBytes() == bytes.size() - 4); }) ==
+		        0);
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.Skip(2) == 2); }) == 1);
+		REQUIRE(CountSyscalls([&] { file.Seek(SeekOrigin::Current, 0); }) == 0);
+		REQUIRE(CountSyscalls([&] { file.Seek(SeekOrigin::End, -1); }) == 1);
+		REQUIRE(file.GetPosition() == bytes.size() - 1);
+		REQUIRE(file.ReadByte() == bytes.back());
+
+		// 文件在外部增长后需刷新长度
+		FileOutputStream{ fileName, FileOutputStream::FileOpenMode::Append }.WriteBytes(bytes);
+		REQUIRE(file.GetAvailableBytes() == 0);
+		REQUIRE(CountSyscalls([&] { REQUIRE(file.RefreshSize() == bytes.size() * 2); }) == 1);
+		REQUIRE(file.GetAvailableBytes() == bytes.size());
+		REQUIRE(file.ReadBytes(std::span(buffer)) == 4);
+		REQUIRE(std::memcmp(buffer, bytes.data(), 4) == 0);
+		REQUIRE(file.GetPosition() == bytes.size() + 4);
+
+		// 以句柄构造时以句柄当前的位置作为初始位置
+		FileInputStream handleFile{ SpecifyNativeHandle, file.GetNativeHandle(), false };
+		REQUIRE(handleFile.GetPosition() == bytes.size() + 4);
+	}
+#endif
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING &&     \
+    !defined(_WIN32)
+	SECTION("MappedFileStreams")
+	{
+		const auto fileName = u8"TempMapped.txt"_sv;
+		const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		std::vector<std::byte> content(pageSize * 5 + 100);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 11);
+		}
+		FileOutputStream{ fileName }.WriteBytes(std::span(content));
+
+		for (const auto populate : { false, true })
+		{
+			// 窗口向上取整为 1 页，读取时多次滑动窗口
+			MappedFileInputStream stream{ FileInputStream{ fileName }, 1, populate };
+			REQUIRE(stream.GetWindowSize() == pageSize);
+			REQUIRE(stream.GetTotalSize() == content.size());
+
+			std::vector<std::byte> buffer(content.size());
+			for (std::size_t position = 0; position < buffer.size(); position += 1000)
+			{
+				const auto size = std::min<std::size_t>(1000, buffer.size() - position);
+				REQUIRE(stream.ReadBytes(std::span(buffer).subspan(position, size)) == size);
+			}
+			REQUIRE(buffer == content);
+			REQUIRE(!stream.ReadByte().has_value());
+
+			// 借出的内存不超过当前窗口
+			stream.SeekFromBegin(pageSize * 2 + 10);
+			const auto borrowed = stream.BorrowBytes();
+			REQUIRE(borrowed.size() == pageSize - 10);
+			REQUIRE(std::memcmp(borrowed.data(), content.data() + pageSize * 2 + 10,
+			                    borrowed.size()) == 0);
+			stream.Consume(borrowed.size());
+			REQUIRE(stream.GetPosition() == pageSize * 3);
+			REQUIRE(stream.ReadByte() == content[pageSize * 3]);
+
+			stream.Seek(SeekOrigin::Current, -2);
+			REQUIRE(stream.ReadByte() == content[pageSize * 3 - 1]);
+			REQUIRE(stream.Skip(pageSize * 10) == content.size() - pageSize * 3);
+			REQUIRE(stream.GetAvailableBytes() == 0);
+
+			std::byte positional[4];
+			REQUIRE(stream.ReadAt(pageSize - 2, std::span(positional)) == 4);
+			REQUIRE(std::memcmp(positional, content.data() + pageSize - 2, 4) == 0);
+		}
+	}
+
+	SECTION("MappedFileOutputStreams")
+	{
+		const auto fileName = u8"TempMapped.txt"_sv;
+		const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		std::vector<std::byte> content(pageSize * 3 + 100);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 7);
+		}
+
+		{
+			// 增长大小向上取整为 1 页，写入时多次扩大映射
+			MappedFileOutputStream stream{ FileOutputStream{ fileName }, 1 };
+			REQUIRE(stream.GetCapacity() == pageSize);
+			for (std::size_t position = 0; position < pageSize * 3; position += 1000)
+			{
+				const auto size = std::min<std::size_t>(1000, pageSize * 3 - position);
+				REQUIRE(stream.WriteBytes(std::span(content).subspan(position, size)) == size);
+			}
+			REQUIRE(stream.GetTotalSize() == pageSize * 3);
+
+			auto acquired = stream.AcquireWriteBuffer(100);
+			REQUIRE(acquired.size() >= 100);
+			std::memcpy(acquired.data(), content.data() + pageSize * 3, 100);
+			stream.Commit(100);
+			REQUIRE(stream.GetTotalSize() == content.size());
+			REQUIRE(stream.GetCapacity() == pageSize * 4);
+			stream.SyncDirtyRange(false);
+
+			// 寻位回去覆盖已写入的数据不改变长度
+			content[10] = std::byte{ 0xAB };
+			stream.Seek(SeekOrigin::Begin, 10);
+			REQUIRE(stream.WriteByte(content[10]));
+			REQUIRE(stream.GetTotalSize() == content.size());
+			stream.Flush();
+		}
+
+		{
+			FileInputStream stream{ fileName };
+			REQUIRE(stream.GetTotalSize() == content.size());
+			std::vector<std::byte> buffer(content.size());
+			REQUIRE(stream.ReadBytes(std::span(buffer)) == buffer.size());
+			REQUIRE(buffer == content);
+		}
+
+		{
+			// 以追加模式打开时从结尾继续写入
+			MappedFileOutputStream stream{
+				FileOutputStream{ fileName, FileOutputStream::FileOpenMode::Append }
+			};
+			REQUIRE(stream.GetPosition() == content.size());
+			REQUIRE(stream.WriteByte(std::byte{ 1 }));
+		}
+		REQUIRE(FileInputStream{ fileName }.GetTotalSize() == content.size() + 1);
+	}
+#endif
+
+	SECTION("BorrowAndCommit")
+	{
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		{
+			ExternalMemoryInputStream stream{ bytes };
+			const auto borrowed = stream.BorrowBytes(4);
+			REQUIRE(borrowed.size() == 4);
+			REQUIRE(borrowed.data() == bytes.data());
+			stream.Consume(4);
+			REQUIRE(stream.GetPosition() == 4);
+			REQUIRE(stream.BorrowBytes().size() == 6);
+		}
+
+		{
+			MemoryStream stream;
+			auto acquired = stream.AcquireWriteBuffer(16);
+			REQUIRE(acquired.size() == 16);
+			std::memcpy(acquired.data(), Data, 10);
+			stream.Commit(10);
+			REQUIRE(stream.GetTotalSize() == 10);
+			REQUIRE(stream.GetPosition() == 10);
+
+			stream.SeekFromBegin(0);
+			const auto borrowed = stream.BorrowBytes();
+			REQUIRE(borrowed.size() == 10);
+			REQUIRE(std::memcmp(Data, borrowed.data(), 10) == 0);
+			stream.Consume(10);
+			REQUIRE(stream.BorrowBytes().empty());
+		}
+
+		{
+			MemoryStream stream;
+
+			{
+				BufferedOutputStream bufferedStream{ &stream, 8 };
+				auto acquired = bufferedStream.AcquireWriteBuffer(4);
+				REQUIRE(acquired.size() == 4);
+				std::memcpy(acquired.data(), Data, 4);
+				bufferedStream.Commit(4);
+				REQUIRE(stream.GetPosition() == 0);
+
+				acquired = bufferedStream.AcquireWriteBuffer(6);
+				REQUIRE(stream.GetPosition() == 4);
+				std::memcpy(acquired.data(), Data + 4, 6);
+				bufferedStream.Commit(6);
+			}
+
+			REQUIRE(stream.GetTotalSize() == 10);
+			stream.SeekFromBegin(0);
+
+			BufferedInputStream bufferedStream{ &stream, 8 };
+			auto borrowed = bufferedStream.BorrowBytes();
+			REQUIRE(borrowed.size() == 8);
+			REQUIRE(std::memcmp(Data, borrowed.data(), 8) == 0);
+			bufferedStream.Consume(8);
+			borrowed = bufferedStream.BorrowBytes();
+			REQUIRE(borrowed.size() == 2);
+			REQUIRE(std::memcmp(Data + 8, borrowed.data(), 2) == 0);
+		}
+	}
+
+	SECTION("CopyTo")
+	{
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		{
+			ExternalMemoryInputStream source{ bytes };
+			MemoryStream destination;
+			REQUIRE(source.CopyTo(destination, 4) == 4);
+			REQUIRE(source.CopyTo(destination) == 6);
+			REQUIRE(std::memcmp(Data, destination.GetInternalStorage().data(), 10) == 0);
+		}
+
+		// 目标流无法写入全部数据时仅消费已写出的部分
+		{
+			ExternalMemoryInputStream source{ bytes };
+			std::byte storage[4];
+			ExternalMemoryOutputStream destination{ std::span(storage) };
+			REQUIRE(source.CopyTo(destination) == 4);
+			REQUIRE(source.GetPosition() == 4);
+			REQUIRE(std::memcmp(Data, storage, 4) == 0);
+
+			BufferedInputStream bufferedSource{ &source, 4 };
+			REQUIRE(bufferedSource.ReadByte() == std::byte(Data[4]));
+			ExternalMemoryOutputStream bufferedDestination{ std::span(storage, 2) };
+			REQUIRE(bufferedSource.CopyTo(bufferedDestination) == 2);
+			REQUIRE(bufferedSource.GetPosition() == 7);
+			REQUIRE(std::memcmp(Data + 5, storage, 2) == 0);
+		}
+
+		// 经过中间缓存复制时，目标流单次写入不完整也应写出全部数据
+		{
+			struct ReadOnlyStream : InputStream
+			{
+				ExternalMemoryInputStream Stream;
+
+				explicit ReadOnlyStream(std::span<const std::byte> const& storage) : Stream{ storage }
+				{
+				}
+
+				std::size_t GetAvailableBytes() override
+				{
+					return Stream.GetAvailableBytes();
+				}
+
+				std::size_t ReadBytes(std::span<std::byte> const& buffer) override
+				{
+					return Stream.ReadBytes(buffer);
+				}
+			};
+
+			struct ShortWriteStream : OutputStream
+			{
+				MemoryStream Stream;
+
+				std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+				{
+					return Stream.WriteBytes(buffer.first(std::min<std::size_t>(buffer.size(), 3)));
+				}
+			};
+
+			ReadOnlyStream source{ bytes };
+			ShortWriteStream destination;
+			REQUIRE(source.CopyTo(destination) == 10);
+			REQUIRE(std::memcmp(Data, destination.Stream.GetInternalStorage().data(), 10) == 0);
+		}
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM
+		{
+#ifdef _WIN32
+			const auto sourceFileName = u"TempCopySource.txt"_sv;
+			const auto destinationFileName = u"TempCopyDestination.txt"_sv;
+#else
+			const auto sourceFileName = u8"TempCopySource.txt"_sv;
+			const auto destinationFileName = u8"TempCopyDestination.txt"_sv;
+#endif
+			{
+				ExternalMemoryInputStream source{ bytes };
+				FileOutputStream destination{ sourceFileName };
+				REQUIRE(source.CopyTo(destination) == 10);
+			}
+
+			{
+				FileInputStream source{ sourceFileName };
+				FileOutputStream destination{ destinationFileName };
+				REQUIRE(source.CopyTo(destination, 3) == 3);
+				REQUIRE(source.CopyTo(destination) == 7);
+			}
+
+			// 追加模式的输出不适用内核复制，应回退到用户空间复制
+			{
+				FileInputStream source{ sourceFileName };
+				FileOutputStream destination{ sourceFileName, FileOutputStream::FileOpenMode::Append };
+				REQUIRE(source.CopyTo(destination, 10) == 10);
+			}
+
+			{
+				FileInputStream source{ sourceFileName };
+				REQUIRE(source.GetTotalSize() == 20);
+				std::byte content[20];
+				REQUIRE(source.ReadBytes(std::span(content)) == 20);
+				REQUIRE(std::memcmp(content, Data, 10) == 0);
+				REQUIRE(std::memcmp(content + 10, Data, 10) == 0);
+			}
+
+			FileInputStream source{ destinationFileName };
+			MemoryStream destination;
+			BufferedInputStream bufferedSource{ &source, 4 };
+			std::byte buffer[2];
+			REQUIRE(bufferedSource.ReadBytes(std::span(buffer)) == 2);
+			REQUIRE(bufferedSource.CopyTo(destination) == 8);
+			REQUIRE(std::memcmp(Data + 2, destination.GetInternalStorage().data(), 8) == 0);
+		}
+
+#ifdef __linux__
+		{
+			int pipeHandles[2];
+			REQUIRE(pipe(pipeHandles) == 0);
+			FileInputStream pipeInput{ SpecifyNativeHandle, pipeHandles[0] };
+			FileOutputStream pipeOutput{ SpecifyNativeHandle, pipeHandles[1] };
+
+			ExternalMemoryInputStream source{ bytes };
+			MemoryStream destination;
+			REQUIRE(source.CopyTo(pipeOutput) == 10);
+			pipeOutput.Close();
+			REQUIRE(pipeInput.CopyTo(destination) == 10);
+			REQUIRE(std::memcmp(Data, destination.GetInternalStorage().data(), 10) == 0);
+		}
+#endif
+#endif
+	}
+
+	SECTION("Capabilities")
+	{
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		MemoryStream stream{ bytes };
+		REQUIRE(HasCapability(stream.GetCapabilities(),
+		                      StreamCapability::Seekable | StreamCapability::Borrow));
+		REQUIRE(!HasCapability(stream.GetCapabilities(), StreamCapability::NonBlocking));
+
+		{
+			constexpr auto ExternalMemoryCapabilities =
+			    StreamCapability::Seekable | StreamCapability::KnownSize |
+			    StreamCapability::PositionalIo | StreamCapability::Borrow;
+
+			ExternalMemoryInputStream externalInputStream{ bytes };
+			REQUIRE(HasCapability(externalInputStream.GetCapabilities(), ExternalMemoryCapabilities));
+			REQUIRE(!HasCapability(externalInputStream.GetCapabilities(),
+			                       StreamCapability::NonBlocking));
+
+			std::byte storage[4];
+			ExternalMemoryOutputStream externalOutputStream{ std::span(storage) };
+			REQUIRE(
+			    HasCapability(externalOutputStream.GetCapabilities(), ExternalMemoryCapabilities));
+			REQUIRE(!HasCapability(externalOutputStream.GetCapabilities(),
+			                       StreamCapability::NonBlocking));
+		}
+
+		{
+			BufferedInputStream bufferedStream{ &stream, 4 };
+			REQUIRE(HasCapability(bufferedStream.GetCapabilities(),
+			                      StreamCapability::Seekable | StreamCapability::Borrow));
+
+			std::byte buffer[3];
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 3);
+			REQUIRE(bufferedStream.GetPosition() == 3);
+
+			// 缓存内寻位
+			bufferedStream.Seek(SeekOrigin::Current, -2);
+			REQUIRE(bufferedStream.GetPosition() == 1);
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 3);
+			REQUIRE(std::memcmp(Data + 1, buffer, 3) == 0);
+
+			bufferedStream.Seek(SeekOrigin::End, -3);
+			REQUIRE(bufferedStream.GetPosition() == 7);
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 3);
+			REQUIRE(std::memcmp(Data + 7, buffer, 3) == 0);
+
+			bufferedStream.SeekFromBegin(2);
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer, 1)) == 1);
+			REQUIRE(buffer[0] == std::byte(Data[2]));
+		}
+
+		// 关闭时包装流被设为用户读取的位置
+		REQUIRE(stream.GetPosition() == 3);
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && !defined(_WIN32)
+		{
+			int pipeHandles[2];
+			REQUIRE(pipe(pipeHandles) == 0);
+			FileInputStream pipeInput{ SpecifyNativeHandle, pipeHandles[0] };
+			FileOutputStream pipeOutput{ SpecifyNativeHandle, pipeHandles[1] };
+			REQUIRE(!HasCapability(pipeInput.GetCapabilities(), StreamCapability::Seekable));
+
+			pipeOutput.WriteBytes(bytes);
+			REQUIRE(pipeInput.GetAvailableBytes() == 10);
+
+			BufferedInputStream bufferedStream{ &pipeInput, 4 };
+			REQUIRE(!HasCapability(bufferedStream.GetCapabilities(), StreamCapability::Seekable));
+
+			std::byte buffer[10];
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 10);
+			REQUIRE(std::memcmp(Data, buffer, 10) == 0);
+		}
+#endif
+	}
+
+	SECTION("ReadAheadStreams")
+	{
+		std::vector<std::byte> content(100000);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 7);
+		}
+		MemoryStream memoryStream{ std::span<const std::byte>(content) };
+
+		{
+			ReadAheadInputStream stream{ &memoryStream, 2048, 1024, 16384 };
+			REQUIRE(stream.GetWindowSize() == 2048);
+
+			// 顺序读取时窗口逐渐增大
+			std::byte buffer[1000];
+			for (std::size_t position = 0; position < 50000; position += sizeof(buffer))
+			{
+				REQUIRE(stream.ReadBytes(std::span(buffer)) == sizeof(buffer));
+				REQUIRE(std::memcmp(buffer, content.data() + position, sizeof(buffer)) == 0);
+			}
+			REQUIRE(stream.GetWindowSize() == 16384);
+			REQUIRE(stream.GetPosition() == 50000);
+
+			// 随机访问时窗口减小
+			stream.SeekFromBegin(10);
+			REQUIRE(stream.GetWindowSize() == 8192);
+			REQUIRE(stream.ReadByte() == content[10]);
+			stream.SeekFromBegin(90000);
+			REQUIRE(stream.GetWindowSize() == 4096);
+			REQUIRE(stream.ReadBytes(std::span(buffer)) == sizeof(buffer));
+			REQUIRE(std::memcmp(buffer, content.data() + 90000, sizeof(buffer)) == 0);
+
+			REQUIRE(stream.Skip(5000) == 5000);
+			REQUIRE(stream.GetPosition() == 96000);
+			REQUIRE(stream.ReadByte() == content[96000]);
+
+			// 读取到结尾
+			std::vector<std::byte> rest(10000);
+			REQUIRE(stream.ReadBytes(std::span(rest)) == content.size() - 96001);
+			REQUIRE(std::memcmp(rest.data(), content.data() + 96001, content.size() - 96001) == 0);
+			REQUIRE(!stream.ReadByte().has_value());
+
+			stream.Seek(SeekOrigin::End, -4);
+			REQUIRE(stream.ReadByte() == content[content.size() - 4]);
+		}
+
+		// 关闭时包装流被设为用户读取的位置
+		REQUIRE(memoryStream.GetPosition() == content.size() - 3);
+
+		memoryStream.SeekFromBegin(0);
+		{
+			ReadAheadInputStream stream{ &memoryStream, 1024, 1024, 4096 };
+			std::byte buffer[10];
+			REQUIRE(stream.ReadBytes(std::span(buffer)) == 10);
+		}
+		REQUIRE(memoryStream.GetPosition() == 10);
+	}
+
+	SECTION("WriteBehindStreams")
+	{
+		std::vector<std::byte> content(100000);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 7);
+		}
+
+		{
+			MemoryStream memoryStream;
+			{
+				WriteBehindOutputStream stream{ &memoryStream, 1024, 2 };
+				REQUIRE(HasCapability(stream.GetCapabilities(), StreamCapability::Borrow));
+
+				// Flush 等待已提交的缓存写出
+				stream.WriteBytes(std::span(content).subspan(0, 10));
+				stream.Flush();
+				REQUIRE(memoryStream.GetTotalSize() == 10);
+
+				for (std::size_t position = 10; position < content.size();)
+				{
+					const auto size = std::min(std::size_t(7), content.size() - position);
+					stream.WriteBytes(std::span(content).subspan(position, size));
+					position += size;
+					if (position < content.size())
+					{
+						REQUIRE(stream.WriteByte(content[position++]));
+					}
+				}
+			}
+			// 关闭时写出剩余的缓存
+			REQUIRE(memoryStream.GetTotalSize() == content.size());
+			REQUIRE(std::memcmp(memoryStream.GetInternalStorage().data(), content.data(),
+			                    content.size()) == 0);
+		}
+
+		{
+			// 包装流写入阻塞时，用户线程仅在全部缓存都等待写出时等待
+			auto [input, output] = CreatePipeStream(256);
+			std::vector<std::byte> received(content.size());
+			std::size_t receivedSize = 0;
+			std::thread consumer{ [&, input = std::move(input)]() mutable {
+				receivedSize = input.ReadBytes(std::span(received));
+			} };
+
+			{
+				WriteBehindOutputStream stream{ &output, 512, 2 };
+				REQUIRE(stream.WriteBytes(content) == content.size());
+			}
+			output.Close();
+			consumer.join();
+
+			REQUIRE(receivedSize == content.size());
+			REQUIRE(received == content);
+		}
+
+		{
+			// 后台线程写入失败后，异常在之后提交缓存或关闭时抛出
+			struct FailingStream : OutputStream
+			{
+				std::size_t WriteBytes(std::span<const std::byte> const&) override
+				{
+					CAFE_THROW(IoException, CAFE_UTF8_SV("Write failed."));
+				}
+			};
+
+			FailingStream failingStream;
+			WriteBehindOutputStream stream{ &failingStream, 4, 1 };
+			stream.WriteBytes(std::as_bytes(std::span(Data, 3)));
+			REQUIRE_THROWS_AS(stream.Flush(), IoException);
+			REQUIRE_THROWS_AS(stream.WriteBytes(std::as_bytes(std::span(Data, 4))), IoException);
+			REQUIRE_THROWS_AS(stream.Close(), IoException);
+		}
+	}
+
+	SECTION("GroupCommitAppender")
+	{
+		constexpr std::size_t ThreadCount = 4;
+		constexpr std::size_t RecordCount = 100;
+
+		MemoryStream stream;
+		{
+			GroupCommitAppender appender{ &stream };
+
+			std::vector<std::thread> threads;
+			for (std::size_t i = 0; i < ThreadCount; ++i)
+			{
+				threads.emplace_back([&, i] {
+					for (std::size_t j = 0; j < RecordCount; ++j)
+					{
+						// 每条记录由线程序号及记录序号两部分组成
+						const std::byte header[] = { static_cast<std::byte>(i) };
+						const std::byte payload[] = { static_cast<std::byte>(j) };
+						const std::span<const std::byte> parts[] = { header, payload };
+						appender.AppendVectored(parts).get();
+					}
+				});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			REQUIRE(appender.GetCommittedGroupCount() >= 1);
+			REQUIRE(appender.GetCommittedGroupCount() <= ThreadCount * RecordCount);
+
+			// 关闭前提交的记录在关闭时写入
+			auto future = appender.Append(std::as_bytes(std::span(Data)));
+			appender.Close();
+			REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+			REQUIRE_THROWS_AS(appender.Append(std::as_bytes(std::span(Data))), IoException);
+		}
+
+		REQUIRE(stream.GetTotalSize() == ThreadCount * RecordCount * 2 + sizeof(Data));
+
+		// 同一线程的记录保持提交顺序
+		stream.SeekFromBegin(0);
+		std::size_t nextRecord[ThreadCount]{};
+		for (std::size_t i = 0; i < ThreadCount * RecordCount; ++i)
+		{
+			std::byte record[2];
+			REQUIRE(stream.ReadBytes(std::span(record)) == 2);
+			const auto thread = static_cast<std::size_t>(record[0]);
+			REQUIRE(thread < ThreadCount);
+			REQUIRE(static_cast<std::size_t>(record[1]) == nextRecord[thread]++);
+		}
+
+		// 后台线程同步期间提交的记录合并为一组，以一次 Sync 持久化
+		{
+			struct GatedSyncStream : OutputStream
+			{
+				std::size_t WrittenSize = 0;
+				std::size_t SyncCount = 0;
+				std::promise<void> SyncGate;
+				std::shared_future<void> SyncGateFuture = SyncGate.get_future().share();
+
+				std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+				{
+					WrittenSize += buffer.size();
+					return buffer.size();
+				}
+
+				void Sync(DurabilityLevel) override
+				{
+					++SyncCount;
+					SyncGateFuture.wait();
+				}
+			};
+
+			GatedSyncStream gatedStream;
+			GroupCommitAppender appender{ &gatedStream };
+
+			std::vector<std::future<void>> futures;
+			for (std::size_t i = 0; i < RecordCount; ++i)
+			{
+				futures.push_back(appender.Append(std::as_bytes(std::span(Data))));
+			}
+			gatedStream.SyncGate.set_value();
+
+			for (auto& future : futures)
+			{
+				future.get();
+			}
+
+			REQUIRE(gatedStream.WrittenSize == RecordCount * sizeof(Data));
+			REQUIRE(gatedStream.SyncCount < RecordCount);
+			// 记录完成时其所在的组已计入
+			REQUIRE(appender.GetCommittedGroupCount() == gatedStream.SyncCount);
+		}
+
+		// 不完整的写入将继续写入剩余部分，无法继续写入时记录失败
+		{
+			struct ShortWriteStream : OutputStream
+			{
+				std::size_t MaxWriteSize;
+				std::vector<std::byte> Content;
+
+				explicit ShortWriteStream(std::size_t maxWriteSize) : MaxWriteSize{ maxWriteSize }
+				{
+				}
+
+				std::size_t WriteBytes(std::span<const std::byte> const& buffer) override
+				{
+					const auto writtenSize = std::min(buffer.size(), MaxWriteSize);
+					Content.insert(Content.end(), buffer.begin(), buffer.begin() + writtenSize);
+					return writtenSize;
+				}
+			};
+
+			ShortWriteStream shortWriteStream{ 3 };
+			{
+				GroupCommitAppender appender{ &shortWriteStream };
+				std::vector<std::future<void>> futures;
+				for (std::size_t i = 0; i < RecordCount; ++i)
+				{
+					futures.push_back(appender.Append(std::as_bytes(std::span(Data))));
+				}
+
+				for (auto& future : futures)
+				{
+					future.get();
+				}
+			}
+
+			REQUIRE(shortWriteStream.Content.size() == RecordCount * sizeof(Data));
+			for (std::size_t i = 0; i < RecordCount; ++i)
+			{
+				REQUIRE(std::memcmp(shortWriteStream.Content.data() + i * sizeof(Data), Data,
+				                    sizeof(Data)) == 0);
+			}
+
+			ShortWriteStream stalledStream{ 0 };
+			GroupCommitAppender appender{ &stalledStream };
+			REQUIRE_THROWS_AS(appender.Append(std::as_bytes(std::span(Data))).get(), IoException);
+			REQUIRE(appender.GetCommittedGroupCount() == 0);
+		}
+
+		// 写入失败后提交的记录都以同一异常失败
+		struct FailingStream : OutputStream
+		{
+			std::size_t WriteBytes(std::span<const std::byte> const&) override
+			{
+				CAFE_THROW(IoException, CAFE_UTF8_SV("Write failed."));
+			}
+		};
+
+		FailingStream failingStream;
+		GroupCommitAppender appender{ &failingStream };
+		REQUIRE_THROWS_AS(appender.Append(std::as_bytes(std::span(Data))).get(), IoException);
+		REQUIRE_THROWS_AS(appender.Append(std::as_bytes(std::span(Data))).get(), IoException);
+		REQUIRE(appender.GetCommittedGroupCount() == 0);
 	}
+
+	SECTION("PipeStreams")
+	{
+		std::vector<std::byte> content(100000);
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			content[i] = static_cast<std::byte>(i * 7);
+		}
+
+		{
+			auto [input, output] = CreatePipeStream(1000);
+			REQUIRE(HasCapability(input.GetCapabilities(), StreamCapability::Borrow));
+			REQUIRE(input.GetAvailableBytes() == 0);
+
+			std::byte buffer[10];
+			REQUIRE(input.ReadAvailableBytes(std::span(buffer)) == 0);
+
+			std::thread producer{ [&, output = std::move(output)]() mutable {
+				std::size_t position = 0;
+				for (std::size_t chunkSize = 1; position < content.size(); ++chunkSize)
+				{
+					const auto size = std::min(chunkSize % 3000, content.size() - position);
+					if (chunkSize % 2)
+					{
+						output.WriteBytes(std::span(content).subspan(position, size));
+						position += size;
+					}
+					else
+					{
+						const auto writeBuffer = output.AcquireWriteBuffer(size);
+						std::memcpy(writeBuffer.data(), content.data() + position,
+						            writeBuffer.size());
+						output.Commit(writeBuffer.size());
+						position += writeBuffer.size();
+					}
+				}
+				output.Close();
+			} };
+
+			std::vector<std::byte> result(content.size());
+			std::size_t position = 0;
+			for (std::size_t i = 0; position < content.size(); ++i)
+			{
+				if (i % 2)
+				{
+					const auto size = std::min(i % 5000, content.size() - position);
+					REQUIRE(input.ReadBytes(std::span(result).subspan(position, size)) == size);
+					position += size;
+				}
+				else
+				{
+					const auto borrowed = input.BorrowBytes(i % 5000 + 1);
+					REQUIRE(!borrowed.empty());
+					std::memcpy(result.data() + position, borrowed.data(), borrowed.size());
+					input.Consume(borrowed.size());
+					position += borrowed.size();
+				}
+			}
+
+			producer.join();
+			REQUIRE(result == content);
+
+			// 输出端关闭且数据已读完后到达结尾
+			REQUIRE(input.ReadBytes(std::span(buffer)) == 0);
+			REQUIRE(input.BorrowBytes().empty());
+		}
+
+		{
+			auto [input, output] = CreatePipeStream(16);
+			REQUIRE(output.WriteBytes(std::as_bytes(std::span(Data))) == sizeof(Data));
+			REQUIRE(input.GetAvailableBytes() == sizeof(Data));
+			REQUIRE(input.Skip(4) == 4);
+			REQUIRE(input.ReadByte() == std::byte(Data[4]));
+
+			// 输入端关闭后写入失败
+			input.Close();
+			REQUIRE_THROWS_AS(output.WriteBytes(std::span(content).first(16)), IoException);
+		}
+
+		{
+			// 不可寻位的流也可回到标记的位置，标记之后的数据可超过缓存大小
+			auto [input, output] = CreatePipeStream(1024);
+			REQUIRE(output.WriteBytes(std::span(content).first(1000)) == 1000);
+			output.Close();
+
+			BufferedInputStream bufferedStream{ &input, 4 };
+			REQUIRE(bufferedStream.Skip(10) == 10);
+
+			bufferedStream.Mark();
+			REQUIRE(bufferedStream.IsMarked());
+
+			std::byte buffer[100];
+			REQUIRE(bufferedStream.ReadByte() == content[10]);
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 100);
+			REQUIRE(std::memcmp(content.data() + 11, buffer, 100) == 0);
+			REQUIRE(bufferedStream.Skip(50) == 50);
+
+			bufferedStream.Reset();
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 100);
+			REQUIRE(std::memcmp(content.data() + 10, buffer, 100) == 0);
+
+			bufferedStream.Reset();
+			bufferedStream.Release();
+			REQUIRE(!bufferedStream.IsMarked());
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 100);
+			REQUIRE(std::memcmp(content.data() + 10, buffer, 100) == 0);
+
+			// 取消标记后不再保留数据
+			bufferedStream.Reset();
+			REQUIRE(bufferedStream.ReadBytes(std::span(buffer)) == 100);
+			REQUIRE(std::memcmp(content.data() + 110, buffer, 100) == 0);
+		}
+	}
+
+	SECTION("StreamQueue")
+	{
+		constexpr std::size_t ProducerCount = 8;
+		constexpr std::size_t ConsumerCount = 2;
+		constexpr std::size_t RecordCount = 200;
+
+		// 缓存远小于写入的总量，生产者将因缓存已满而等待
+		StreamQueue queue{ 256 };
+		REQUIRE(queue.GetMaxRecordSize() == 256 - 4);
+
+		std::vector<std::thread> producers;
+		for (std::size_t i = 0; i < ProducerCount; ++i)
+		{
+			producers.emplace_back([&, i] {
+				for (std::size_t j = 0; j < RecordCount; ++j)
+				{
+					// 记录由生产者序号、记录序号及长度不定的填充组成
+					const std::byte header[] = { static_cast<std::byte>(i), static_cast<std::byte>(j),
+						                         static_cast<std::byte>(j % 7) };
+					const std::byte padding[7]{};
+					const std::span<const std::byte> parts[] = { header, std::span(padding, j % 7) };
+					queue.AppendVectored(parts);
+				}
+			});
+		}
+
+		std::vector<std::vector<std::size_t>> received(ConsumerCount);
+		std::vector<std::thread> consumers;
+		for (std::size_t i = 0; i < ConsumerCount; ++i)
+		{
+			consumers.emplace_back([&, i, reader = queue.CreateReader()]() mutable {
+				std::byte header[3];
+				while (reader.ReadBytes(std::span(header)) == 3)
+				{
+					// 每条记录完整地由同一读取器读出，否则记录为无效的值
+					const auto paddingSize = static_cast<std::size_t>(header[2]);
+					const auto intact = reader.GetRemainingRecordSize() == paddingSize &&
+					                    reader.Skip(paddingSize) == paddingSize;
+					received[i].push_back(intact ? static_cast<std::size_t>(header[0]) << 8 |
+					                                   static_cast<std::size_t>(header[1])
+					                             : std::size_t(-1));
+				}
+			});
+		}
+
+		for (auto& producer : producers)
+		{
+			producer.join();
+		}
+		queue.Close();
+		for (auto& consumer : consumers)
+		{
+			consumer.join();
+		}
+
+		REQUIRE_THROWS_AS(queue.Append(std::as_bytes(std::span(Data))), IoException);
+
+		// 全部记录恰好被读出一次，同一读取器读出的同一生产者的记录保持追加顺序
+		std::size_t recordCounts[ProducerCount]{};
+		for (const auto& records : received)
+		{
+			std::optional<std::size_t> lastRecords[ProducerCount];
+			for (const auto record : records)
+			{
+				const auto producer = record >> 8;
+				const auto index = record & 0xFF;
+				REQUIRE(producer < ProducerCount);
+				REQUIRE((!lastRecords[producer] || index > *lastRecords[producer]));
+				lastRecords[producer] = index;
+				++recordCounts[producer];
+			}
+		}
+		for (const auto count : recordCounts)
+		{
+			REQUIRE(count == RecordCount);
+		}
+
+		// 读取器以借出的方式读取
+		StreamQueue borrowQueue{ 32 };
+		auto reader = borrowQueue.CreateReader();
+		borrowQueue.Append(std::as_bytes(std::span(Data)).first(6));
+		borrowQueue.Append({});
+		borrowQueue.Append(std::as_bytes(std::span(Data)).first(3));
+		borrowQueue.Close();
+
+		REQUIRE(reader.GetAvailableBytes() == 0);
+		const auto borrowed = reader.BorrowBytes();
+		REQUIRE(borrowed.size() == 6);
+		REQUIRE(std::memcmp(borrowed.data(), Data, 6) == 0);
+		reader.Consume(6);
+		REQUIRE(reader.BorrowBytes(2).size() == 2);
+		REQUIRE(reader.GetRemainingRecordSize() == 3);
+		reader.Consume(3);
+		REQUIRE(reader.BorrowBytes().empty());
+
+		// 关闭时唤醒因缓存已满而等待的生产者，已追加的记录仍可读出
+		StreamQueue fullQueue{ 16 };
+		std::byte record[12];
+		std::ranges::fill(record, std::byte{ 1 });
+		REQUIRE(fullQueue.GetMaxRecordSize() == sizeof record);
+		fullQueue.Append(std::span(record));
+
+		bool closedWhileWaiting = false;
+		std::thread producer{ [&] {
+			try
+			{
+				fullQueue.Append(std::span(record));
+			}
+			catch (IoException const&)
+			{
+				closedWhileWaiting = true;
+			}
+		} };
+		// 使生产者尽可能已开始等待，即使尚未开始等待也应以异常结束
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		fullQueue.Close();
+		producer.join();
+		REQUIRE(closedWhileWaiting);
+
+		auto fullQueueReader = fullQueue.CreateReader();
+		std::byte buffer[sizeof record + 1];
+		REQUIRE(fullQueueReader.ReadBytes(std::span(buffer)) == sizeof record);
+		REQUIRE(std::memcmp(buffer, record, sizeof record) == 0);
+	}
+
+#if CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM
+	SECTION("AsyncStreams")
+	{
+		IoContext context;
+		std::thread runThread{ [&] { context.Run(); } };
+		CAFE_SCOPE_EXIT
+		{
+			context.Stop();
+			runThread.join();
+		};
+
+		const auto bytes = std::as_bytes(std::span(Data));
+
+		MemoryStream memoryStream;
+		AsyncOutputStreamAdapter output{ context, &memoryStream };
+		REQUIRE(SyncWait(output.WriteBytesAsync(bytes)) == sizeof(Data));
+		memoryStream.SeekFromBegin(0);
+
+		BufferedInputStream bufferedStream{ &memoryStream, 4 };
+		AsyncInputStreamAdapter input{ context, &bufferedStream };
+		std::byte buffer[sizeof(Data)];
+		REQUIRE(SyncWait(input.ReadBytesAsync(std::span(buffer).first(3))) == 3);
+		REQUIRE(SyncWait(input.Run([](InputStream& stream) { return stream.ReadByte(); })) ==
+		        std::byte(Data[3]));
+		REQUIRE(SyncWait(input.ReadBytesAsync(std::span(buffer))) == sizeof(Data) - 4);
+		REQUIRE(std::memcmp(Data + 4, buffer, sizeof(Data) - 4) == 0);
+
+#if CAFE_IO_STREAMS_INCLUDE_FILE_STREAM && !defined(_WIN32)
+		{
+			int pipeHandles[2];
+			REQUIRE(pipe(pipeHandles) == 0);
+			AsyncFileInputStream pipeInput{
+				context, FileInputStream{ SpecifyNativeHandle, pipeHandles[0] }
+			};
+			AsyncFileOutputStream pipeOutput{
+				context, FileOutputStream{ SpecifyNativeHandle, pipeHandles[1] }
+			};
+
+			// 读取者先于写入者开始，将在管道可读前挂起
+			std::promise<std::size_t> readResult;
+			const auto reader = [&]() -> Task<> {
+				readResult.set_value(co_await pipeInput.ReadBytesAsync(std::span(buffer)));
+			};
+			context.Spawn(reader());
+
+			REQUIRE(SyncWait(pipeOutput.WriteBytesAsync(bytes)) == sizeof(Data));
+			REQUIRE(readResult.get_future().get() == sizeof(Data));
+			REQUIRE(std::memcmp(Data, buffer, sizeof(Data)) == 0);
+
+			pipeOutput.Close();
+			REQUIRE(SyncWait(pipeInput.ReadSomeBytesAsync(std::span(buffer))) == 0);
+		}
+
+		// 句柄原本为阻塞模式时，关闭后恢复为阻塞模式
+		{
+			int pipeHandles[2];
+			REQUIRE(pipe(pipeHandles) == 0);
+			CAFE_SCOPE_EXIT
+			{
+				close(pipeHandles[0]);
+				close(pipeHandles[1]);
+			};
+
+			AsyncFileInputStream pipeInput{
+				context, FileInputStream{ SpecifyNativeHandle, pipeHandles[0], false }
+			};
+			REQUIRE(HasCapability(pipeInput.GetUnderlyingStream().GetCapabilities(),
+			                      StreamCapability::NonBlocking));
+			REQUIRE((fcntl(pipeHandles[0], F_GETFL) & O_NONBLOCK) != 0);
+
+			pipeInput.Close();
+			REQUIRE((fcntl(pipeHandles[0], F_GETFL) & O_NONBLOCK) == 0);
+		}
+#endif
+	}
+#endif
+
+#if CAFE_IO_STREAMS_ENABLE_IO_URING
+	SECTION("IoUring")
+	{
+		if (!IoUringEngine::IsSupported())
+		{
+			return;
+		}
+
+		const auto fileName = u8"TempIoUring.txt"_sv;
+		const auto bytes = std::as_bytes(std::span(Data));
+		FileOutputStream{ fileName }.WriteBytes(bytes);
+
+		FileInputStream inputStream{ fileName };
+		IoUringEngine engine{ 8 };
+
+		// 多个请求以一次系统调用提交
+		std::byte first[4], second[4];
+		engine.QueueRead(inputStream, 0, std::span(first), 1);
+		engine.QueueRead(inputStream, 5, std::span(second), 2);
+		REQUIRE(engine.GetPendingSubmissionCount() == 2);
+		REQUIRE(engine.SubmitAndWait(2) == 2);
+		REQUIRE(engine.GetPendingSubmissionCount() == 0);
+
+		IoUringCompletion completions[4];
+		REQUIRE(engine.ReapCompletions(completions) == 2);
+		for (const auto& completion : std::span(completions, 2))
+		{
+			REQUIRE(completion.Result == 4);
+		}
+		REQUIRE(std::memcmp(first, Data, 4) == 0);
+		REQUIRE(std::memcmp(second, Data + 5, 4) == 0);
+		REQUIRE(engine.ReapCompletions(completions) == 0);
+
+		// 已注册的文件及缓存
+		std::byte registeredBuffer[8];
+		const std::span<std::byte> registeredBuffers[]{ std::span(registeredBuffer) };
+		const int fileHandles[]{ inputStream.GetNativeHandle() };
+		engine.RegisterBuffers(registeredBuffers);
+		engine.RegisterFiles(fileHandles);
+		engine.QueueRead(0, 2, std::span(registeredBuffer).first(3), 3,
+		                 IoUringRequestFlags::FixedFile | IoUringRequestFlags::RegisteredBuffer, 0);
+		engine.SubmitAndWait(1);
+		REQUIRE(engine.ReapCompletions(completions) == 1);
+		REQUIRE(completions[0].UserData == 3);
+		REQUIRE(completions[0].Result == 3);
+		REQUIRE(std::memcmp(registeredBuffer, Data + 2, 3) == 0);
+		engine.UnregisterFiles();
+		engine.UnregisterBuffers();
+
+#if CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM
+		IoContext context;
+		REQUIRE(context.UsesIoUring());
+		std::thread runThread{ [&] { context.Run(); } };
+		CAFE_SCOPE_EXIT
+		{
+			context.Stop();
+			runThread.join();
+		};
+
+		AsyncFileInputStream asyncInput{ context, std::move(inputStream) };
+		std::byte buffer[sizeof(Data)];
+		REQUIRE(SyncWait(asyncInput.ReadBytesAsync(std::span(buffer).first(4))) == 4);
+		REQUIRE(SyncWait(asyncInput.ReadAtAsync(6, std::span(buffer).subspan(4, 2))) == 2);
+		REQUIRE(std::memcmp(buffer, Data, 4) == 0);
+		REQUIRE(std::memcmp(buffer + 4, Data + 6, 2) == 0);
+		// 以当前位置读取时，流的位置随之更新
+		REQUIRE(asyncInput.GetUnderlyingStream().GetPosition() == 4);
+		REQUIRE(SyncWait(asyncInput.ReadBytesAsync(std::span(buffer))) == sizeof(Data) - 4);
+		REQUIRE(std::memcmp(buffer, Data + 4, sizeof(Data) - 4) == 0);
+
+		// 跟踪的位置与文件句柄的位置保持一致，之后的同步操作不受影响
+		auto& underlyingStream = asyncInput.GetUnderlyingStream();
+		REQUIRE(underlyingStream.GetPosition() == sizeof(Data));
+		REQUIRE(underlyingStream.GetAvailableBytes() == 0);
+		underlyingStream.Seek(SeekOrigin::Begin, 0);
+		REQUIRE(underlyingStream.ReadBytes(std::span(buffer).first(4)) == 4);
+		REQUIRE(std::memcmp(buffer, Data, 4) == 0);
+#endif
+	}
+#endif
 }
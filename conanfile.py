@@ -11,6 +11,8 @@ Options = [
     # Cafe.Io.Streams
     ("CAFE_IO_STREAMS_INCLUDE_FILE_STREAM", [True, False], True),
     ("CAFE_IO_STREAMS_FILE_STREAM_ENABLE_FILE_MAPPING", [True, False], True),
+    ("CAFE_IO_STREAMS_INCLUDE_ASYNC_STREAM", [True, False], True),
+    ("CAFE_IO_STREAMS_ENABLE_IO_URING", [True, False], True),
 ]
 
 